@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace trdp {
+
+// Metadata of one XML file in the config directory, computed once per
+// change of the file.
+struct ConfigIndexEntry {
+    std::string name;
+    std::string path;
+    uint64_t size;
+    int64_t modified_ms;
+    // FNV-1a 64 of the file contents, hex encoded.
+    std::string hash;
+    size_t interfaces;
+    size_t telegrams;
+    size_t datasets;
+    // Empty when the file parsed cleanly.
+    std::string error;
+};
+
+// Keeps an index of the config directory current in the background. A
+// worker thread follows the directory with inotify and re-parses only the
+// files that changed; listings are served from memory. Without inotify the
+// worker falls back to rescanning the directory every few seconds.
+class ConfigIndex {
+public:
+    ~ConfigIndex();
+
+    void start(const std::string &directory);
+    void stop();
+
+    const std::string &directory() const { return directory_; }
+    bool directoryExists() const { return directory_exists_.load(std::memory_order_relaxed); }
+    // Sorted by file name.
+    std::vector<ConfigIndexEntry> entries() const;
+
+private:
+    void run();
+    void rescan();
+    void refresh(const std::string &name);
+
+    std::string directory_;
+    std::atomic<bool> running_ {false};
+    std::atomic<bool> directory_exists_ {false};
+    std::thread worker_;
+    int wake_fd_ {-1};
+
+    mutable std::mutex mtx_;
+    std::map<std::string, ConfigIndexEntry> entries_;
+};
+
+}  // namespace trdp
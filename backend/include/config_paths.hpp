@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 // Helper utilities for resolving configuration paths and runtime settings.
 // Values can be overridden via environment variables and fall back to compile
@@ -11,9 +13,18 @@ std::string getEnvOrEmpty(const char *name);
 
 std::string resolveXmlPath();
 std::string resolveHostName();
+// Splits the resolved host name on commas so one backend can emulate
+// several devices, e.g. TRDP_HOST_NAME="devA,devB@10.0.1.12". Hosts
+// without "@ip" use the XML host-ip, so at most one of them may omit it.
+std::vector<std::string> resolveHostNames();
 std::string resolveListenAddress();
 uint16_t resolveListenPort();
+// TRDP_HISTORY_DEPTH, or trdp::kDefaultHistoryDepth; 0 disables history.
+size_t resolveHistoryDepth();
 bool shouldRunAsDaemon();
+// TRDP_LOOPBACK=1 runs the engine on its in-memory loopback instead of TRDP
+// sessions, so a configuration can be exercised without its network.
+bool shouldUseLoopback();
 bool isAddressAvailable(const std::string &address, uint16_t port);
 
 // Returns the directory the backend should scan for TRDP XML configuration
@@ -21,3 +32,24 @@ bool isAddressAvailable(const std::string &address, uint16_t port);
 // TRDP_DEFAULT_CONFIG_DIR compile time definition. If neither is available, it
 // falls back to the parent of the default XML path when present.
 std::string resolveConfigDirectory();
+
+// Returns the directory used for runtime files such as PD capture rings. The
+// value is resolved from TRDP_STATE_DIR, then the TRDP_DEFAULT_STATE_DIR
+// compile time definition.
+std::string resolveStateDirectory();
+
+// Journal the engine state is persisted to for warm restarts, inside the
+// state directory. Empty when no state directory is configured or
+// TRDP_STATE_JOURNAL=0.
+std::string resolveStateJournalPath();
+
+// Engine log levels from TRDP_LOG_LEVEL, e.g. "warn,pd.rx=info" (see
+// trdp::logSetLevels); "info" when unset.
+std::string resolveLogLevels();
+// File the engine's JSON-lines log is appended to, from TRDP_LOG_FILE.
+// Empty (the default) writes to stderr.
+std::string resolveLogPath();
+
+// Name of the POSIX shared-memory segment the telegram table is exported to,
+// from TRDP_SHM_NAME. Empty (the default) leaves the export off.
+std::string resolveShmName();
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <drogon/WebSocketController.h>
+
+#include "trdp_engine.hpp"
+
+// Streams MD request outcomes to WebSocket clients. Clients send
+// {"action":"request"|"notify", ...} with the same fields as the REST
+// endpoints and receive one {"type":"result"} message per request they
+// issued; {"action":"subscribe"} additionally mirrors every result.
+class MdWebSocket : public drogon::WebSocketController<MdWebSocket> {
+public:
+    static void setEngine(trdp::TrdpEngine *engine);
+
+    void handleNewMessage(const drogon::WebSocketConnectionPtr &conn,
+                          std::string &&message,
+                          const drogon::WebSocketMessageType &type) override;
+    void handleNewConnection(const drogon::HttpRequestPtr &req, const drogon::WebSocketConnectionPtr &conn) override;
+    void handleConnectionClosed(const drogon::WebSocketConnectionPtr &conn) override;
+
+    WS_PATH_LIST_BEGIN
+    WS_PATH_ADD("/ws/md");
+    WS_PATH_LIST_END
+
+private:
+    static trdp::TrdpEngine *engine_;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <drogon/WebSocketController.h>
+
+#include "trdp_engine.hpp"
+
+// Pushes PD payload changes to WebSocket clients. Clients send
+// {"action":"subscribe","com_ids":[...]} (no list = every telegram) and
+// receive one {"type":"change"} message per received payload that differs
+// from the previous one; {"action":"unsubscribe"} stops the stream.
+// {"action":"watch"} additionally delivers a {"type":"watch"} message for
+// every watch rule that fires (see /api/watch); {"action":"unwatch"} ends it.
+class PdWebSocket : public drogon::WebSocketController<PdWebSocket> {
+public:
+    static void setEngine(trdp::TrdpEngine *engine);
+
+    void handleNewMessage(const drogon::WebSocketConnectionPtr &conn,
+                          std::string &&message,
+                          const drogon::WebSocketMessageType &type) override;
+    void handleNewConnection(const drogon::HttpRequestPtr &req, const drogon::WebSocketConnectionPtr &conn) override;
+    void handleConnectionClosed(const drogon::WebSocketConnectionPtr &conn) override;
+
+    WS_PATH_LIST_BEGIN
+    WS_PATH_ADD("/ws/pd");
+    WS_PATH_LIST_END
+
+private:
+    static trdp::TrdpEngine *engine_;
+};
@@ -4,16 +4,57 @@
 
 #include "trdp_engine.hpp"
 
+namespace trdp {
+class ConfigIndex;
+}
+
 class TrdpController : public drogon::HttpController<TrdpController> {
 public:
     static void setEngine(trdp::TrdpEngine *engine);
+    // When set, /api/configs is answered from the index instead of a scan.
+    static void setConfigIndex(const trdp::ConfigIndex *index);
 
     METHOD_LIST_BEGIN
     ADD_METHOD_TO(TrdpController::getPdTelegrams, "/api/pd/telegrams", drogon::Get, drogon::Options);
     ADD_METHOD_TO(TrdpController::listConfigs, "/api/configs", drogon::Get, drogon::Options);
     ADD_METHOD_TO(TrdpController::loadConfig, "/api/configs/load", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getConfigJobs, "/api/configs/jobs", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getConfigJob, "/api/configs/jobs/{id}", drogon::Get, drogon::Options);
     ADD_METHOD_TO(TrdpController::enablePd, "/api/pd/{com_id}/enable", drogon::Post, drogon::Options);
     ADD_METHOD_TO(TrdpController::setPdValues, "/api/pd/{com_id}/values", drogon::Patch, drogon::Options);
+    ADD_METHOD_TO(TrdpController::setPdValuesBatch, "/api/pd/values", drogon::Patch, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getGenerators, "/api/pd/generators", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::addGenerator, "/api/pd/generators", drogon::Post);
+    ADD_METHOD_TO(TrdpController::removeGenerator, "/api/pd/generators/{id}", drogon::Delete, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getPdHistory, "/api/pd/{com_id}/history", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getPdSwitchovers, "/api/pd/switchovers", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getMetrics, "/metrics", drogon::Get);
+    ADD_METHOD_TO(TrdpController::getCaptureStatus, "/api/capture", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::startCapture, "/api/capture/start", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::stopCapture, "/api/capture/stop", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::exportCapture, "/api/capture/export", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getReplayStatus, "/api/replay", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::startReplay, "/api/replay/start", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::stopReplay, "/api/replay/stop", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getScenarioStatus, "/api/scenario", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::startScenario, "/api/scenario/start", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::stopScenario, "/api/scenario/stop", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getPdPulls, "/api/pd/pull", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::startPdPull, "/api/pd/pull", drogon::Post);
+    ADD_METHOD_TO(TrdpController::stopPdPull, "/api/pd/pull/{id}", drogon::Delete, drogon::Options);
+    ADD_METHOD_TO(TrdpController::sendMdRequest, "/api/md/request", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::sendMdNotify, "/api/md/notify", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getMdResult, "/api/md/requests/{id}", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getMdStats, "/api/md/stats", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::addMdResponder, "/api/md/responders", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::removeMdResponder, "/api/md/responders/{com_id}", drogon::Delete, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getWatches, "/api/watch", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::addWatch, "/api/watch", drogon::Post);
+    ADD_METHOD_TO(TrdpController::removeWatch, "/api/watch/{id}", drogon::Delete, drogon::Options);
+    ADD_METHOD_TO(TrdpController::getTraceStatus, "/api/trace/status", drogon::Get, drogon::Options);
+    ADD_METHOD_TO(TrdpController::startTrace, "/api/trace/start", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::stopTrace, "/api/trace/stop", drogon::Post, drogon::Options);
+    ADD_METHOD_TO(TrdpController::exportTrace, "/api/trace", drogon::Get, drogon::Options);
     METHOD_LIST_END
 
     void getPdTelegrams(const drogon::HttpRequestPtr &req,
@@ -22,9 +63,19 @@ public:
     void listConfigs(const drogon::HttpRequestPtr &req,
                      std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
 
+    // Body: {"path", "host_name"} or {"path", "host_names": [...]}. Entries
+    // may be "name@ip"; with several hosts every host needs its own address
+    // on each interface, so all but one must carry an "@ip".
     void loadConfig(const drogon::HttpRequestPtr &req,
                     std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
 
+    void getConfigJobs(const drogon::HttpRequestPtr &req,
+                       std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void getConfigJob(const drogon::HttpRequestPtr &req,
+                      std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+                      uint64_t id) const;
+
     void enablePd(const drogon::HttpRequestPtr &req,
                   std::function<void(const drogon::HttpResponsePtr &)> &&callback,
                   uint32_t com_id) const;
@@ -33,6 +84,112 @@ public:
                      std::function<void(const drogon::HttpResponsePtr &)> &&callback,
                      uint32_t com_id) const;
 
+    void setPdValuesBatch(const drogon::HttpRequestPtr &req,
+                          std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void getGenerators(const drogon::HttpRequestPtr &req,
+                       std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void addGenerator(const drogon::HttpRequestPtr &req,
+                      std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void removeGenerator(const drogon::HttpRequestPtr &req,
+                         std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+                         uint64_t id) const;
+
+    void getPdHistory(const drogon::HttpRequestPtr &req,
+                      std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+                      uint32_t com_id) const;
+
+    void getPdSwitchovers(const drogon::HttpRequestPtr &req,
+                          std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void getMetrics(const drogon::HttpRequestPtr &req,
+                    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void getCaptureStatus(const drogon::HttpRequestPtr &req,
+                          std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void startCapture(const drogon::HttpRequestPtr &req,
+                      std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void stopCapture(const drogon::HttpRequestPtr &req,
+                     std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void exportCapture(const drogon::HttpRequestPtr &req,
+                       std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void getReplayStatus(const drogon::HttpRequestPtr &req,
+                         std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void startReplay(const drogon::HttpRequestPtr &req,
+                     std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void stopReplay(const drogon::HttpRequestPtr &req,
+                    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void getScenarioStatus(const drogon::HttpRequestPtr &req,
+                           std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void startScenario(const drogon::HttpRequestPtr &req,
+                       std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void stopScenario(const drogon::HttpRequestPtr &req,
+                      std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void getPdPulls(const drogon::HttpRequestPtr &req,
+                    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void startPdPull(const drogon::HttpRequestPtr &req,
+                     std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void stopPdPull(const drogon::HttpRequestPtr &req,
+                    std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+                    uint64_t id) const;
+
+    void sendMdRequest(const drogon::HttpRequestPtr &req,
+                       std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void sendMdNotify(const drogon::HttpRequestPtr &req,
+                      std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void getMdResult(const drogon::HttpRequestPtr &req,
+                     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+                     uint64_t id) const;
+
+    void getMdStats(const drogon::HttpRequestPtr &req,
+                    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void addMdResponder(const drogon::HttpRequestPtr &req,
+                        std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void removeMdResponder(const drogon::HttpRequestPtr &req,
+                           std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+                           uint32_t com_id) const;
+
+    void getWatches(const drogon::HttpRequestPtr &req,
+                    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void addWatch(const drogon::HttpRequestPtr &req,
+                  std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void removeWatch(const drogon::HttpRequestPtr &req,
+                     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+                     uint64_t id) const;
+
+    void getTraceStatus(const drogon::HttpRequestPtr &req,
+                        std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void startTrace(const drogon::HttpRequestPtr &req,
+                    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void stopTrace(const drogon::HttpRequestPtr &req,
+                   std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
+    void exportTrace(const drogon::HttpRequestPtr &req,
+                     std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+
 private:
     static trdp::TrdpEngine *engine_;
+    static const trdp::ConfigIndex *config_index_;
 };
@@ -2,11 +2,41 @@
 
 #include <json/json.h>
 
+#include <string>
+
 #include "trdp_engine.hpp"
 
 namespace trdp {
 
 Json::Value pdRuntimeToJson(const PdRuntime &pd, const TrdpEngine &engine);
+// Per-publisher reception and sequence counter statistics of a telegram.
+Json::Value pdSourcesToJson(const PdSourceSet &sources);
+Json::Value decodedFieldsToJson(const std::vector<DecodedField> &fields);
+std::string payloadToHex(const uint8_t *data, size_t size);
+
+Json::Value pdPullStatusToJson(const std::vector<PdPullStatus> &jobs, const std::vector<PdPullStatsSnapshot> &stats);
+
+Json::Value mdResultToJson(const MdResult &result);
+Json::Value mdStatsToJson(const std::vector<MdStatsSnapshot> &stats);
+// Fills `options` from a request body; returns an error message or an empty
+// string on success.
+std::string mdRequestFromJson(const Json::Value &json, MdRequestOptions &options);
+bool hexToPayload(const std::string &hex, std::vector<uint8_t> &payload);
+
+// Fills `spec` from a request body; returns an error message or an empty
+// string on success.
+std::string watchSpecFromJson(const Json::Value &json, PdWatchSpec &spec);
+Json::Value watchStatusToJson(const std::vector<PdWatchStatus> &rules);
+Json::Value watchEventToJson(const PdWatchEvent &event);
+
+// Fills `spec` from a request body; returns an error message or an empty
+// string on success.
+std::string generatorSpecFromJson(const Json::Value &json, PdGeneratorSpec &spec);
+Json::Value generatorStatusToJson(const std::vector<PdGeneratorStatus> &generators);
+
+Json::Value configJobToJson(const ConfigJobStatus &job);
+
+Json::Value switchoversToJson(const std::vector<PdSwitchoverEvent> &events);
 
 }  // namespace trdp
 
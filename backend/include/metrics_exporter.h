@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+#include "trdp_engine.hpp"
+
+namespace trdp {
+
+// Records one handled HTTP request. Numeric path segments are collapsed so
+// per-telegram routes share a single series.
+void recordHttpLatency(const std::string &method, const std::string &path, double seconds);
+
+// Renders engine and HTTP metrics in the Prometheus text exposition format.
+// Only lock-free engine views are read, so a scrape never blocks the PD
+// scheduler or the receive path.
+std::string renderPrometheusMetrics(const TrdpEngine *engine);
+
+}  // namespace trdp
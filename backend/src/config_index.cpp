@@ -0,0 +1,233 @@
+#include "config_index.h"
+
+#include <cerrno>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <poll.h>
+#include <set>
+#include <sstream>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "trdp/trdp_config_loader.hpp"
+
+namespace trdp {
+namespace {
+
+constexpr int kRescanIntervalMs = 5000;
+// Editors write a file in several steps; events are collected for this
+// long before the affected files are parsed.
+constexpr int kSettleMs = 200;
+
+bool isConfigFile(const std::filesystem::path &path) { return path.extension() == ".xml"; }
+
+std::string hashFile(const std::filesystem::path &path, uint64_t &size) {
+    std::ifstream input(path, std::ios::binary);
+    uint64_t hash = 1469598103934665603ull;
+    size = 0u;
+
+    char buffer[65536];
+    while (input.read(buffer, sizeof(buffer)) || input.gcount() > 0) {
+        const auto count = static_cast<size_t>(input.gcount());
+        for (size_t idx = 0u; idx < count; ++idx) {
+            hash ^= static_cast<unsigned char>(buffer[idx]);
+            hash *= 1099511628211ull;
+        }
+        size += count;
+    }
+
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return out.str();
+}
+
+ConfigIndexEntry indexFile(const std::filesystem::path &path) {
+    ConfigIndexEntry entry {};
+    entry.name = path.filename().string();
+    entry.path = path.string();
+
+    std::error_code ec;
+    const auto modified = std::filesystem::last_write_time(path, ec);
+    if (!ec) {
+        entry.modified_ms = std::chrono::duration_cast<std::chrono::milliseconds>(modified.time_since_epoch()).count();
+    }
+    entry.hash = hashFile(path, entry.size);
+
+    try {
+        // The host name only decides telegram roles; with a single host
+        // every telegram of the file is kept, which is what gets counted.
+        TrdpConfigLoader loader;
+        loader.loadFromXml(entry.path, std::string {});
+        entry.interfaces = loader.interfaces().size();
+        entry.telegrams = loader.pdTelegrams().size();
+        entry.datasets = loader.datasets().size();
+    } catch (const std::exception &ex) {
+        entry.error = ex.what();
+    }
+
+    return entry;
+}
+
+}  // namespace
+
+ConfigIndex::~ConfigIndex() { stop(); }
+
+void ConfigIndex::start(const std::string &directory) {
+    stop();
+
+    directory_ = directory;
+    wake_fd_ = eventfd(0u, EFD_NONBLOCK | EFD_CLOEXEC);
+    running_ = true;
+    worker_ = std::thread(&ConfigIndex::run, this);
+}
+
+void ConfigIndex::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    if (wake_fd_ >= 0) {
+        const uint64_t one = 1u;
+        (void)write(wake_fd_, &one, sizeof(one));
+    }
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+}
+
+std::vector<ConfigIndexEntry> ConfigIndex::entries() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::vector<ConfigIndexEntry> result;
+    result.reserve(entries_.size());
+    for (const auto &entry : entries_) {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+void ConfigIndex::rescan() {
+    std::error_code ec;
+    const bool exists = !directory_.empty() && std::filesystem::is_directory(directory_, ec);
+    directory_exists_ = exists;
+
+    std::set<std::string> present;
+    if (exists) {
+        for (const auto &file : std::filesystem::directory_iterator(directory_, ec)) {
+            if (file.is_regular_file(ec) && isConfigFile(file.path())) {
+                present.insert(file.path().filename().string());
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (present.count(it->first) == 0u) {
+                it = entries_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (const auto &name : present) {
+        refresh(name);
+    }
+}
+
+void ConfigIndex::refresh(const std::string &name) {
+    const std::filesystem::path path = std::filesystem::path(directory_) / name;
+
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        entries_.erase(name);
+        return;
+    }
+
+    // Skip the parse when neither size nor modification time moved.
+    const auto size = std::filesystem::file_size(path, ec);
+    const auto modified = std::filesystem::last_write_time(path, ec);
+    const int64_t modifiedMs =
+        ec ? 0 : std::chrono::duration_cast<std::chrono::milliseconds>(modified.time_since_epoch()).count();
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        const auto it = entries_.find(name);
+        if (it != entries_.end() && it->second.size == size && it->second.modified_ms == modifiedMs) {
+            return;
+        }
+    }
+
+    ConfigIndexEntry entry = indexFile(path);
+    std::lock_guard<std::mutex> lock(mtx_);
+    entries_[name] = std::move(entry);
+}
+
+void ConfigIndex::run() {
+    int notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    int watch = -1;
+
+    while (running_) {
+        if (notifyFd >= 0 && watch < 0 && !directory_.empty()) {
+            watch = inotify_add_watch(notifyFd, directory_.c_str(),
+                                      IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF |
+                                          IN_MOVE_SELF);
+            // Either the directory is missing or it was just (re)created;
+            // both cases need a full pass.
+            rescan();
+        } else if (watch < 0) {
+            rescan();
+        }
+
+        pollfd fds[2] {{wake_fd_, POLLIN, 0}, {notifyFd, POLLIN, 0}};
+        const nfds_t count = watch >= 0 ? 2u : 1u;
+        if (poll(fds, count, kRescanIntervalMs) <= 0 || !running_) {
+            continue;
+        }
+        if (count < 2u || (fds[1].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        // Let a burst of writes settle, then drain everything that queued up.
+        poll(fds, 1u, kSettleMs);
+
+        std::set<std::string> changed;
+        bool lostDirectory = false;
+        alignas(inotify_event) char buffer[16384];
+        ssize_t length = 0;
+        while ((length = read(notifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char *ptr = buffer; ptr < buffer + length;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+                if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED | IN_Q_OVERFLOW)) != 0u) {
+                    lostDirectory = true;
+                } else if (event->len > 0u && isConfigFile(event->name)) {
+                    changed.insert(event->name);
+                }
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+
+        if (lostDirectory) {
+            inotify_rm_watch(notifyFd, watch);
+            watch = -1;
+            continue;
+        }
+
+        for (const auto &name : changed) {
+            refresh(name);
+        }
+    }
+
+    if (notifyFd >= 0) {
+        close(notifyFd);
+    }
+}
+
+}  // namespace trdp
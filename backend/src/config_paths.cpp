@@ -1,5 +1,7 @@
 #include "config_paths.hpp"
 
+#include "trdp/pd_history.hpp"
+
 #include <algorithm>
 #include <arpa/inet.h>
 #include <cctype>
@@ -36,6 +38,27 @@ std::string defaultConfigDirectory() {
 #endif
 }
 
+std::string defaultStateDirectory() {
+#ifdef TRDP_DEFAULT_STATE_DIR
+    return TRDP_DEFAULT_STATE_DIR;
+#else
+    return {};
+#endif
+}
+
+bool isEnvFlagSet(const char *name) {
+    const char *value = std::getenv(name);
+    if (value == nullptr) {
+        return false;
+    }
+
+    std::string lowered = value;
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char ch) {
+        return static_cast<char>(std::tolower(ch));
+    });
+    return lowered == "1" || lowered == "true" || lowered == "yes";
+}
+
 }  // namespace
 
 std::string getEnvOrEmpty(const char *name) {
@@ -61,6 +84,26 @@ std::string resolveHostName() {
     return defaultHostName();
 }
 
+std::vector<std::string> resolveHostNames() {
+    std::vector<std::string> hostNames;
+    const std::string value = resolveHostName();
+
+    size_t begin = 0u;
+    while (begin <= value.size()) {
+        const size_t end = std::min(value.find(',', begin), value.size());
+        std::string entry = value.substr(begin, end - begin);
+        entry.erase(entry.begin(), std::find_if(entry.begin(), entry.end(), [](unsigned char c) { return !std::isspace(c); }));
+        entry.erase(std::find_if(entry.rbegin(), entry.rend(), [](unsigned char c) { return !std::isspace(c); }).base(),
+                    entry.end());
+        if (!entry.empty()) {
+            hostNames.push_back(entry);
+        }
+        begin = end + 1u;
+    }
+
+    return hostNames;
+}
+
 std::string resolveListenAddress() {
     const std::string envOverride = getEnvOrEmpty("TRDP_LISTEN_ADDRESS");
     return envOverride.empty() ? std::string {"0.0.0.0"} : envOverride;
@@ -81,6 +124,18 @@ uint16_t resolveListenPort() {
     return 8080u;
 }
 
+size_t resolveHistoryDepth() {
+    const std::string envOverride = getEnvOrEmpty("TRDP_HISTORY_DEPTH");
+    if (!envOverride.empty()) {
+        try {
+            return static_cast<size_t>(std::stoul(envOverride));
+        } catch (...) {
+        }
+    }
+
+    return trdp::kDefaultHistoryDepth;
+}
+
 bool isAddressAvailable(const std::string &address, uint16_t port) {
     const int sock = ::socket(AF_INET, SOCK_STREAM, 0);
     if (sock < 0) {
@@ -103,18 +158,9 @@ bool isAddressAvailable(const std::string &address, uint16_t port) {
     return available;
 }
 
-bool shouldRunAsDaemon() {
-    const std::string envOverride = getEnvOrEmpty("TRDP_RUN_AS_DAEMON");
-    if (envOverride.empty()) {
-        return false;
-    }
+bool shouldRunAsDaemon() { return isEnvFlagSet("TRDP_RUN_AS_DAEMON"); }
 
-    std::string lowered = envOverride;
-    std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char ch) {
-        return static_cast<char>(std::tolower(ch));
-    });
-    return lowered == "1" || lowered == "true" || lowered == "yes";
-}
+bool shouldUseLoopback() { return isEnvFlagSet("TRDP_LOOPBACK"); }
 
 std::string resolveConfigDirectory() {
     const std::string envOverride = getEnvOrEmpty("TRDP_CONFIG_DIR");
@@ -137,3 +183,30 @@ std::string resolveConfigDirectory() {
 
     return {};
 }
+
+std::string resolveStateDirectory() {
+    const std::string envOverride = getEnvOrEmpty("TRDP_STATE_DIR");
+    if (!envOverride.empty()) {
+        return envOverride;
+    }
+
+    return defaultStateDirectory();
+}
+
+std::string resolveStateJournalPath() {
+    const std::string stateDir = resolveStateDirectory();
+    if (stateDir.empty() || getEnvOrEmpty("TRDP_STATE_JOURNAL") == "0") {
+        return {};
+    }
+
+    return (std::filesystem::path(stateDir) / "engine_state.journal").string();
+}
+
+std::string resolveLogLevels() {
+    const std::string envOverride = getEnvOrEmpty("TRDP_LOG_LEVEL");
+    return envOverride.empty() ? std::string {"info"} : envOverride;
+}
+
+std::string resolveLogPath() { return getEnvOrEmpty("TRDP_LOG_FILE"); }
+
+std::string resolveShmName() { return getEnvOrEmpty("TRDP_SHM_NAME"); }
@@ -0,0 +1,221 @@
+#include "controllers/MdWebSocket.h"
+
+#include <deque>
+#include <drogon/drogon.h>
+#include <json/json.h>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+
+#include "json_utils.h"
+#include "trdp/trace.hpp"
+
+trdp::TrdpEngine *MdWebSocket::engine_ = nullptr;
+
+namespace {
+
+// Results can complete before the issuing connection has recorded their
+// ids; the most recent unclaimed ones are kept so they are not lost.
+constexpr size_t kMaxUnclaimedResults = 1024u;
+
+std::mutex routingMutex;
+std::unordered_map<uint64_t, drogon::WebSocketConnectionPtr> owners;
+std::set<drogon::WebSocketConnectionPtr> subscribers;
+std::deque<trdp::MdResult> unclaimed;
+
+std::string toText(const Json::Value &json) {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, json);
+}
+
+void sendJson(const drogon::WebSocketConnectionPtr &conn, const Json::Value &json) {
+    if (conn && conn->connected()) {
+        conn->send(toText(json));
+    }
+}
+
+void sendError(const drogon::WebSocketConnectionPtr &conn, const std::string &message) {
+    Json::Value json(Json::objectValue);
+    json["type"] = "error";
+    json["error"] = message;
+    sendJson(conn, json);
+}
+
+Json::Value resultMessage(const trdp::MdResult &result) {
+    Json::Value json = trdp::mdResultToJson(result);
+    json["type"] = "result";
+    return json;
+}
+
+void dispatchResult(const trdp::MdResult &result) {
+    drogon::WebSocketConnectionPtr owner;
+    std::vector<drogon::WebSocketConnectionPtr> watchers;
+    {
+        std::lock_guard<std::mutex> lock(routingMutex);
+        const auto it = owners.find(result.id);
+        if (it != owners.end()) {
+            // Subscribers already receive every result.
+            if (subscribers.count(it->second) == 0u) {
+                owner = it->second;
+            }
+            owners.erase(it);
+        } else {
+            unclaimed.push_back(result);
+            if (unclaimed.size() > kMaxUnclaimedResults) {
+                unclaimed.pop_front();
+            }
+        }
+        watchers.assign(subscribers.begin(), subscribers.end());
+    }
+
+    if (!owner && watchers.empty()) {
+        return;
+    }
+
+    const Json::Value message = resultMessage(result);
+    if (owner) {
+        sendJson(owner, message);
+    }
+    for (const auto &conn : watchers) {
+        sendJson(conn, message);
+    }
+}
+
+void claimResults(const drogon::WebSocketConnectionPtr &conn, const std::vector<uint64_t> &ids) {
+    std::vector<trdp::MdResult> ready;
+    bool subscribed = false;
+    {
+        std::lock_guard<std::mutex> lock(routingMutex);
+        subscribed = subscribers.count(conn) != 0u;
+        const std::set<uint64_t> wanted(ids.begin(), ids.end());
+        for (auto it = unclaimed.begin(); it != unclaimed.end();) {
+            if (wanted.count(it->id) != 0u) {
+                ready.push_back(*it);
+                it = unclaimed.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        for (const auto id : ids) {
+            owners[id] = conn;
+        }
+        for (const auto &result : ready) {
+            owners.erase(result.id);
+        }
+    }
+
+    if (subscribed) {
+        return;
+    }
+    for (const auto &result : ready) {
+        sendJson(conn, resultMessage(result));
+    }
+}
+
+}  // namespace
+
+void MdWebSocket::setEngine(trdp::TrdpEngine *engine) {
+    engine_ = engine;
+    if (engine_ == nullptr) {
+        return;
+    }
+
+    // The handler runs on the TRDP thread; formatting and sending happen on
+    // the HTTP loop so a slow client never delays the stack.
+    engine_->setMdResultHandler([](const trdp::MdResult &result) {
+        drogon::app().getLoop()->queueInLoop([result]() { dispatchResult(result); });
+    });
+}
+
+void MdWebSocket::handleNewMessage(const drogon::WebSocketConnectionPtr &conn,
+                                   std::string &&message,
+                                   const drogon::WebSocketMessageType &type) {
+    trdp::TraceScope trace("ws.md.message", "http");
+    if (type != drogon::WebSocketMessageType::Text) {
+        return;
+    }
+
+    Json::Value json;
+    Json::CharReaderBuilder builder;
+    std::string parseErrors;
+    std::istringstream stream(message);
+    if (!Json::parseFromStream(builder, stream, &json, &parseErrors) || !json.isObject()) {
+        sendError(conn, "Invalid JSON message");
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        sendError(conn, "TRDP engine is not initialized");
+        return;
+    }
+
+    const std::string action = json.get("action", "").asString();
+    if (action == "subscribe" || action == "unsubscribe") {
+        std::lock_guard<std::mutex> lock(routingMutex);
+        if (action == "subscribe") {
+            subscribers.insert(conn);
+        } else {
+            subscribers.erase(conn);
+        }
+        return;
+    }
+
+    if (action != "request" && action != "notify") {
+        sendError(conn, "Unknown action: " + action);
+        return;
+    }
+
+    trdp::MdRequestOptions options;
+    const std::string error = trdp::mdRequestFromJson(json, options);
+    if (!error.empty()) {
+        sendError(conn, error);
+        return;
+    }
+
+    Json::Value reply(Json::objectValue);
+    reply["type"] = "accepted";
+    reply["action"] = action;
+    reply["com_id"] = options.com_id;
+    if (json.isMember("tag")) {
+        reply["tag"] = json["tag"];
+    }
+
+    try {
+        if (action == "notify") {
+            engine_->mdNotify(options);
+            sendJson(conn, reply);
+            return;
+        }
+
+        const auto ids = engine_->mdRequest(options);
+        Json::Value idList(Json::arrayValue);
+        for (const auto id : ids) {
+            idList.append(static_cast<Json::UInt64>(id));
+        }
+        reply["ids"] = idList;
+        sendJson(conn, reply);
+        claimResults(conn, ids);
+    } catch (const std::exception &ex) {
+        sendError(conn, ex.what());
+    }
+}
+
+void MdWebSocket::handleNewConnection(const drogon::HttpRequestPtr &req, const drogon::WebSocketConnectionPtr &conn) {
+    (void)req;
+    (void)conn;
+}
+
+void MdWebSocket::handleConnectionClosed(const drogon::WebSocketConnectionPtr &conn) {
+    std::lock_guard<std::mutex> lock(routingMutex);
+    subscribers.erase(conn);
+    for (auto it = owners.begin(); it != owners.end();) {
+        if (it->second == conn) {
+            it = owners.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
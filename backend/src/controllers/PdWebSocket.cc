@@ -0,0 +1,214 @@
+#include "controllers/PdWebSocket.h"
+
+#include <drogon/drogon.h>
+#include <json/json.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#include <vos_sock.h>
+
+#include "json_utils.h"
+#include "trdp/trace.hpp"
+
+trdp::TrdpEngine *PdWebSocket::engine_ = nullptr;
+
+namespace {
+
+constexpr double kPollIntervalSeconds = 0.02;
+// Upper bound of changes forwarded per poll so one burst cannot stall the
+// HTTP loop; the rest is picked up by the next poll.
+constexpr size_t kMaxChangesPerPoll = 4096u;
+
+std::mutex subscriptionMutex;
+// An empty comId set subscribes to every telegram.
+std::map<drogon::WebSocketConnectionPtr, std::set<uint32_t>> subscriptions;
+std::set<drogon::WebSocketConnectionPtr> watchers;
+
+// The controller is a single consumer of the engine's change queue and fans
+// out to its connections; both are only touched from the poll timer.
+uint64_t changeCursor = 0u;
+std::vector<uint8_t> changeScratch;
+
+std::string toText(const Json::Value &json) {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, json);
+}
+
+void sendJson(const drogon::WebSocketConnectionPtr &conn, const Json::Value &json) {
+    if (conn && conn->connected()) {
+        conn->send(toText(json));
+    }
+}
+
+void sendError(const drogon::WebSocketConnectionPtr &conn, const std::string &message) {
+    Json::Value json(Json::objectValue);
+    json["type"] = "error";
+    json["error"] = message;
+    sendJson(conn, json);
+}
+
+void pollChanges(const trdp::TrdpEngine &engine) {
+    const auto &queue = engine.pdChanges();
+
+    std::vector<std::pair<drogon::WebSocketConnectionPtr, std::set<uint32_t>>> targets;
+    {
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+        targets.assign(subscriptions.begin(), subscriptions.end());
+    }
+
+    if (targets.empty()) {
+        changeCursor = queue.head();
+        return;
+    }
+
+    trdp::TraceScope trace("ws.pd.poll", "http");
+    const auto result = queue.poll(changeCursor, changeScratch, kMaxChangesPerPoll, [&](const trdp::PdChangeEvent &event) {
+        std::vector<const drogon::WebSocketConnectionPtr *> receivers;
+        for (const auto &target : targets) {
+            if (target.second.empty() || target.second.count(event.com_id) != 0u) {
+                receivers.push_back(&target.first);
+            }
+        }
+        if (receivers.empty()) {
+            return;
+        }
+
+        Json::Value json(Json::objectValue);
+        json["type"] = "change";
+        json["seq"] = static_cast<Json::UInt64>(event.seq);
+        json["com_id"] = event.com_id;
+        json["src_ip"] = vos_ipDotted(event.src_ip);
+        json["t_us"] = static_cast<Json::Int64>(event.time_ns / 1000);
+        json["raw_hex"] = trdp::payloadToHex(event.data, event.size);
+        json["fields"] = trdp::decodedFieldsToJson(engine.decodePayload(event.com_id, event.data, event.size));
+
+        const std::string text = toText(json);
+        for (const auto *conn : receivers) {
+            if (*conn && (*conn)->connected()) {
+                (*conn)->send(text);
+            }
+        }
+    });
+
+    if (result.lost > 0u) {
+        Json::Value json(Json::objectValue);
+        json["type"] = "lost";
+        json["count"] = static_cast<Json::UInt64>(result.lost);
+        for (const auto &target : targets) {
+            sendJson(target.first, json);
+        }
+    }
+}
+
+void dispatchWatchEvent(const trdp::PdWatchEvent &event) {
+    std::vector<drogon::WebSocketConnectionPtr> targets;
+    {
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+        targets.assign(watchers.begin(), watchers.end());
+    }
+    if (targets.empty()) {
+        return;
+    }
+
+    Json::Value json = trdp::watchEventToJson(event);
+    json["type"] = "watch";
+    const std::string text = toText(json);
+    for (const auto &conn : targets) {
+        if (conn && conn->connected()) {
+            conn->send(text);
+        }
+    }
+}
+
+}  // namespace
+
+void PdWebSocket::setEngine(trdp::TrdpEngine *engine) {
+    engine_ = engine;
+    if (engine_ == nullptr) {
+        return;
+    }
+
+    changeCursor = engine_->pdChanges().head();
+    // Watch events arrive on the TRDP thread with the engine locked; they
+    // are only copied there and sent from the HTTP loop.
+    engine_->setWatchHandler([](const trdp::PdWatchEvent &event) {
+        drogon::app().getLoop()->queueInLoop([event]() { dispatchWatchEvent(event); });
+    });
+    drogon::app().getLoop()->runEvery(kPollIntervalSeconds, []() {
+        if (engine_ != nullptr) {
+            pollChanges(*engine_);
+        }
+    });
+}
+
+void PdWebSocket::handleNewMessage(const drogon::WebSocketConnectionPtr &conn,
+                                   std::string &&message,
+                                   const drogon::WebSocketMessageType &type) {
+    trdp::TraceScope trace("ws.pd.message", "http");
+    if (type != drogon::WebSocketMessageType::Text) {
+        return;
+    }
+
+    Json::Value json;
+    Json::CharReaderBuilder builder;
+    std::string parseErrors;
+    std::istringstream stream(message);
+    if (!Json::parseFromStream(builder, stream, &json, &parseErrors) || !json.isObject()) {
+        sendError(conn, "Invalid JSON message");
+        return;
+    }
+
+    const std::string action = json.get("action", "").asString();
+    if (action == "watch" || action == "unwatch") {
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+        if (action == "watch") {
+            watchers.insert(conn);
+        } else {
+            watchers.erase(conn);
+        }
+        return;
+    }
+
+    if (action == "unsubscribe") {
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+        subscriptions.erase(conn);
+        return;
+    }
+
+    if (action != "subscribe") {
+        sendError(conn, "Unknown action: " + action);
+        return;
+    }
+
+    std::set<uint32_t> comIds;
+    if (json.isMember("com_ids")) {
+        if (!json["com_ids"].isArray()) {
+            sendError(conn, "com_ids must be an array");
+            return;
+        }
+        for (const auto &entry : json["com_ids"]) {
+            if (!entry.isUInt()) {
+                sendError(conn, "com_ids must contain unsigned integers");
+                return;
+            }
+            comIds.insert(entry.asUInt());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(subscriptionMutex);
+    subscriptions[conn] = std::move(comIds);
+}
+
+void PdWebSocket::handleNewConnection(const drogon::HttpRequestPtr &req, const drogon::WebSocketConnectionPtr &conn) {
+    (void)req;
+    (void)conn;
+}
+
+void PdWebSocket::handleConnectionClosed(const drogon::WebSocketConnectionPtr &conn) {
+    std::lock_guard<std::mutex> lock(subscriptionMutex);
+    subscriptions.erase(conn);
+    watchers.erase(conn);
+}
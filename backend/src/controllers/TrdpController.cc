@@ -1,25 +1,38 @@
 #include "controllers/TrdpController.h"
 
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <drogon/HttpResponse.h>
 #include <json/json.h>
 #include <map>
 #include <string>
+#include <vector>
+#include <vos_sock.h>
 
+#include "config_index.h"
 #include "config_paths.hpp"
+#include "json_utils.h"
+#include "metrics_exporter.h"
+#include "trdp/trace.hpp"
 
 trdp::TrdpEngine *TrdpController::engine_ = nullptr;
+const trdp::ConfigIndex *TrdpController::config_index_ = nullptr;
 
 void TrdpController::setEngine(trdp::TrdpEngine *engine) {
     engine_ = engine;
 }
 
+void TrdpController::setConfigIndex(const trdp::ConfigIndex *index) {
+    config_index_ = index;
+}
+
 namespace {
 
 void addCorsHeaders(const drogon::HttpResponsePtr &resp) {
     resp->addHeader("Access-Control-Allow-Origin", "*");
-    resp->addHeader("Access-Control-Allow-Methods", "GET,POST,OPTIONS,PATCH");
+    resp->addHeader("Access-Control-Allow-Methods", "GET,POST,OPTIONS,PATCH,DELETE");
     resp->addHeader("Access-Control-Allow-Headers", "Content-Type");
 }
 
@@ -47,15 +60,113 @@ std::string directionToString(trdp::Direction direction) {
     return "unknown";
 }
 
+drogon::HttpResponsePtr errorResponse(drogon::HttpStatusCode code, const std::string &message) {
+    Json::Value body(Json::objectValue);
+    body["error"] = message;
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
+    resp->setStatusCode(code);
+    addCorsHeaders(resp);
+    return resp;
+}
+
+std::map<std::string, double> parseFieldValues(const Json::Value &fields) {
+    std::map<std::string, double> values;
+    for (const auto &field : fields) {
+        if (!field.isMember("name") || !field.isMember("value") || !field["value"].isNumeric()) {
+            continue;
+        }
+
+        values[field["name"].asString()] = field["value"].asDouble();
+    }
+    return values;
+}
+
+// Capture files always live in the state directory; only the file name of
+// a client supplied value is used.
+std::filesystem::path resolveStateFile(const std::string &name, const std::string &fallback) {
+    const std::filesystem::path fileName = std::filesystem::path(name.empty() ? fallback : name).filename();
+    return std::filesystem::path(resolveStateDirectory()) / fileName;
+}
+
+Json::Value captureStatusToJson(const trdp::PdCaptureStatus &status) {
+    Json::Value json(Json::objectValue);
+    json["active"] = status.active;
+    json["path"] = status.path;
+    json["slots"] = status.slot_count;
+    json["records"] = static_cast<Json::UInt64>(status.records);
+    json["truncated"] = static_cast<Json::UInt64>(status.truncated);
+    return json;
+}
+
+Json::Value replayStatusToJson(const trdp::ReplayStatus &status) {
+    Json::Value json(Json::objectValue);
+    json["active"] = status.active;
+    json["path"] = status.path;
+    json["speed"] = status.speed;
+    json["total"] = static_cast<Json::UInt64>(status.total);
+    json["sent"] = static_cast<Json::UInt64>(status.sent);
+    json["skipped"] = static_cast<Json::UInt64>(status.skipped);
+    json["max_lateness_us"] = status.max_lateness_us;
+    return json;
+}
+
+Json::Value scenarioStatusToJson(const trdp::ScenarioStatus &status) {
+    Json::Value json(Json::objectValue);
+    json["active"] = status.active;
+    json["path"] = status.path;
+    json["steps"] = static_cast<Json::UInt64>(status.steps);
+    json["executed"] = static_cast<Json::UInt64>(status.executed);
+    json["loops"] = status.loops;
+    json["passes_done"] = status.passes_done;
+    json["elapsed_us"] = static_cast<Json::UInt64>(status.elapsed_us);
+    json["max_lateness_us"] = status.max_lateness_us;
+    return json;
+}
+
+Json::Value traceStatusToJson(const trdp::TraceStatus &status) {
+    Json::Value json(Json::objectValue);
+    json["active"] = status.active;
+    json["events_per_thread"] = static_cast<Json::UInt64>(status.events_per_thread);
+    json["threads"] = static_cast<Json::UInt64>(status.threads);
+    json["events"] = static_cast<Json::UInt64>(status.events);
+    json["overwritten"] = static_cast<Json::UInt64>(status.overwritten);
+    return json;
+}
+
+// Per-thread ring size used when a trace is started without an explicit one.
+constexpr uint32_t kDefaultTraceEvents = 65536u;
+constexpr uint32_t kMaxTraceEvents = 4194304u;
+
 Json::Int64 toMicros(const std::chrono::steady_clock::time_point &tp) {
     return std::chrono::duration_cast<std::chrono::microseconds>(tp.time_since_epoch()).count();
 }
 
+// Upper bound for one burst of MD requests or notifications.
+constexpr uint32_t kMaxMdBurst = 10000u;
+
+// History queries are downsampled for plotting; larger requests are capped.
+constexpr int64_t kMaxHistoryPoints = 10000;
+
+int64_t parameterAsInt64(const drogon::HttpRequestPtr &req, const std::string &name, int64_t fallback) {
+    const std::string &value = req->getParameter(name);
+    if (value.empty()) {
+        return fallback;
+    }
+
+    try {
+        return std::stoll(value);
+    } catch (...) {
+        return fallback;
+    }
+}
+
 }  // namespace
 
 void TrdpController::getPdTelegrams(
     const drogon::HttpRequestPtr &req,
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getPdTelegrams", "http");
     if (handlePreflight(req, callback)) {
         return;
     }
@@ -81,7 +192,9 @@ void TrdpController::getPdTelegrams(
             entry["dataset_id"] = pd.def->dataset_id;
             entry["direction"] = directionToString(pd.def->direction);
             entry["cycle_us"] = pd.def->cycle_us;
+            entry["pull"] = pd.def->pull;
             entry["interface"] = pd.def->interface_name;
+            entry["host"] = pd.def->host_name;
         }
 
         entry["tx_enabled"] = pd.tx_enabled;
@@ -91,10 +204,18 @@ void TrdpController::getPdTelegrams(
         entry["last_rx_time_us"] = toMicros(pd.last_rx_time);
         entry["last_rx_valid"] = pd.last_rx_valid;
         entry["rx_count"] = static_cast<Json::UInt64>(pd.rx_count);
+        entry["change_count"] = static_cast<Json::UInt64>(pd.change_count);
+        entry["last_change_time_us"] = toMicros(pd.last_change_time);
         entry["tx_count"] = static_cast<Json::UInt64>(pd.tx_count);
+        entry["tx_missed_cycles"] = static_cast<Json::UInt64>(pd.tx_missed_cycles);
+        entry["tx_last_lateness_us"] = pd.tx_last_lateness_us;
         entry["timeout_count"] = static_cast<Json::UInt64>(pd.timeout_count);
         entry["last_period_us"] = pd.last_period_us;
         entry["avg_period_us"] = pd.avg_period_us;
+        // The publisher currently followed; sources[] also lists standbys.
+        const trdp::PdSource *active = pd.sources.active();
+        entry["active_source"] = active != nullptr ? Json::Value(vos_ipDotted(active->src_ip)) : Json::Value();
+        entry["sources"] = trdp::pdSourcesToJson(pd.sources);
 
         telegrams.append(entry);
     }
@@ -107,6 +228,7 @@ void TrdpController::getPdTelegrams(
 void TrdpController::listConfigs(
     const drogon::HttpRequestPtr &req,
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.listConfigs", "http");
     if (handlePreflight(req, callback)) {
         return;
     }
@@ -114,6 +236,34 @@ void TrdpController::listConfigs(
     Json::Value response(Json::objectValue);
     Json::Value files(Json::arrayValue);
 
+    if (config_index_ != nullptr) {
+        response["directory"] = config_index_->directory();
+        for (const auto &entry : config_index_->entries()) {
+            Json::Value file(Json::objectValue);
+            file["name"] = entry.name;
+            file["path"] = entry.path;
+            file["size"] = static_cast<Json::UInt64>(entry.size);
+            file["modified_ms"] = static_cast<Json::Int64>(entry.modified_ms);
+            file["hash"] = entry.hash;
+            file["interfaces"] = static_cast<Json::UInt64>(entry.interfaces);
+            file["telegrams"] = static_cast<Json::UInt64>(entry.telegrams);
+            file["datasets"] = static_cast<Json::UInt64>(entry.datasets);
+            if (!entry.error.empty()) {
+                file["error"] = entry.error;
+            }
+            files.append(file);
+        }
+        if (!config_index_->directory().empty() && !config_index_->directoryExists()) {
+            response["warning"] = "Config directory is configured but does not exist.";
+        }
+
+        response["files"] = files;
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+        addCorsHeaders(resp);
+        callback(resp);
+        return;
+    }
+
     const std::string configDir = resolveConfigDirectory();
     response["directory"] = configDir;
 
@@ -143,15 +293,17 @@ void TrdpController::listConfigs(
 void TrdpController::loadConfig(
     const drogon::HttpRequestPtr &req,
     std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.loadConfig", "http");
     if (handlePreflight(req, callback)) {
         return;
     }
 
     const auto json = req->getJsonObject();
-    if (!json || !(*json).isMember("path") || !(*json).isMember("host_name")) {
+    if (!json || !(*json).isMember("path") ||
+        !((*json).isMember("host_name") || ((*json).isMember("host_names") && (*json)["host_names"].isArray()))) {
         auto resp = drogon::HttpResponse::newHttpResponse();
         resp->setStatusCode(drogon::k400BadRequest);
-        resp->setBody(R"({"error":"Missing required fields: path, host_name"})");
+        resp->setBody(R"({"error":"Missing required fields: path, host_name or host_names"})");
         resp->setContentTypeCode(drogon::CT_APPLICATION_JSON);
         addCorsHeaders(resp);
         callback(resp);
@@ -169,7 +321,14 @@ void TrdpController::loadConfig(
     }
 
     const auto &path = (*json)["path"].asString();
-    const auto &hostName = (*json)["host_name"].asString();
+    std::vector<std::string> hostNames;
+    if ((*json).isMember("host_names")) {
+        for (const auto &host : (*json)["host_names"]) {
+            hostNames.push_back(host.asString());
+        }
+    } else {
+        hostNames.push_back((*json)["host_name"].asString());
+    }
     std::filesystem::path resolvedPath {path};
 
     if (resolvedPath.is_relative()) {
@@ -179,22 +338,85 @@ void TrdpController::loadConfig(
         }
     }
 
-    engine_->loadConfig(resolvedPath.string(), hostName);
+    // Parsing and re-subscribing can take a while on large files, so the
+    // load runs as a job; progress is polled from /api/configs/jobs/{id}.
+    const uint64_t jobId = engine_->submitConfigLoad(resolvedPath.string(), hostNames);
+
+    Json::Value hostList(Json::arrayValue);
+    for (const auto &host : hostNames) {
+        hostList.append(host);
+    }
 
     Json::Value response;
-    response["status"] = "config loaded";
+    response["status"] = "config load queued";
+    response["job_id"] = static_cast<Json::UInt64>(jobId);
+    response["status_url"] = "/api/configs/jobs/" + std::to_string(jobId);
     response["path"] = resolvedPath.string();
-    response["host_name"] = hostName;
+    response["host_name"] = hostNames.front();
+    response["host_names"] = hostList;
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    resp->setStatusCode(drogon::k202Accepted);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::getConfigJobs(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getConfigJobs", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    Json::Value jobs(Json::arrayValue);
+    for (const auto &job : engine_->configJobs()) {
+        jobs.append(trdp::configJobToJson(job));
+    }
+
+    Json::Value response;
+    response["jobs"] = jobs;
 
     auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
     addCorsHeaders(resp);
     callback(resp);
 }
 
+void TrdpController::getConfigJob(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+    uint64_t id) const {
+    trdp::TraceScope trace("http.getConfigJob", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    const auto job = engine_->configJob(id);
+    if (!job) {
+        callback(errorResponse(drogon::k404NotFound, "Unknown or expired config job id"));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(trdp::configJobToJson(*job));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
 void TrdpController::enablePd(
     const drogon::HttpRequestPtr &req,
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     uint32_t com_id) const {
+    trdp::TraceScope trace("http.enablePd", "http");
     if (handlePreflight(req, callback)) {
         return;
     }
@@ -221,7 +443,7 @@ void TrdpController::enablePd(
     }
 
     const bool enable = (*json)["enable"].asBool();
-    engine_->enablePd(com_id, enable);
+    engine_->enablePd(com_id, enable, (*json).get("host", "").asString());
 
     Json::Value response;
     response["status"] = "pd enable updated";
@@ -237,6 +459,7 @@ void TrdpController::setPdValues(
     const drogon::HttpRequestPtr &req,
     std::function<void(const drogon::HttpResponsePtr &)> &&callback,
     uint32_t com_id) const {
+    trdp::TraceScope trace("http.setPdValues", "http");
     if (handlePreflight(req, callback)) {
         return;
     }
@@ -262,23 +485,983 @@ void TrdpController::setPdValues(
         return;
     }
 
-    std::map<std::string, double> values;
-    for (const auto &field : (*json)["fields"]) {
-        if (!field.isMember("name") || !field.isMember("value") || !field["value"].isNumeric()) {
-            continue;
+    const auto values = parseFieldValues((*json)["fields"]);
+    engine_->setPdValues(com_id, values, (*json).get("host", "").asString());
+
+    Json::Value response;
+    response["status"] = "pd values updated";
+    response["com_id"] = com_id;
+    response["updated_fields"] = static_cast<Json::UInt64>(values.size());
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::setPdValuesBatch(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.setPdValuesBatch", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    const auto json = req->getJsonObject();
+    if (!json || !(*json).isMember("updates") || !(*json)["updates"].isArray()) {
+        callback(errorResponse(drogon::k400BadRequest, "Missing required field: updates (array)"));
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    std::vector<trdp::PdValueUpdate> updates;
+    updates.reserve((*json)["updates"].size());
+    for (const auto &update : (*json)["updates"]) {
+        if (!update.isMember("com_id") || !update["com_id"].isUInt() || !update.isMember("fields") ||
+            !update["fields"].isArray()) {
+            callback(errorResponse(drogon::k400BadRequest, "Each update requires com_id (uint) and fields (array)"));
+            return;
         }
 
-        values[field["name"].asString()] = field["value"].asDouble();
+        updates.push_back(trdp::PdValueUpdate {update["com_id"].asUInt(), parseFieldValues(update["fields"]),
+                                               update.get("host", "").asString()});
     }
 
-    engine_->setPdValues(com_id, values);
+    const auto result = engine_->setPdValuesBatch(updates);
+
+    Json::Value unknown(Json::arrayValue);
+    for (const auto comId : result.unknown_com_ids) {
+        unknown.append(comId);
+    }
 
     Json::Value response;
     response["status"] = "pd values updated";
+    response["updated_telegrams"] = static_cast<Json::UInt64>(result.updated_telegrams);
+    response["updated_fields"] = static_cast<Json::UInt64>(result.updated_fields);
+    response["unknown_com_ids"] = unknown;
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::getGenerators(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getGenerators", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(trdp::generatorStatusToJson(engine_->generatorStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::addGenerator(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.addGenerator", "http");
+    const auto json = req->getJsonObject();
+    if (!json) {
+        callback(errorResponse(drogon::k400BadRequest, "Request body must be JSON"));
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    trdp::PdGeneratorSpec spec;
+    const std::string error = trdp::generatorSpecFromJson(*json, spec);
+    if (!error.empty()) {
+        callback(errorResponse(drogon::k400BadRequest, error));
+        return;
+    }
+
+    uint64_t id = 0u;
+    try {
+        id = engine_->addGenerator(spec);
+    } catch (const std::exception &ex) {
+        callback(errorResponse(drogon::k400BadRequest, ex.what()));
+        return;
+    }
+
+    Json::Value response;
+    response["status"] = "generator added";
+    response["id"] = static_cast<Json::UInt64>(id);
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    resp->setStatusCode(drogon::k201Created);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::removeGenerator(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+    uint64_t id) const {
+    trdp::TraceScope trace("http.removeGenerator", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    if (!engine_->removeGenerator(id)) {
+        callback(errorResponse(drogon::k404NotFound, "Unknown generator id"));
+        return;
+    }
+
+    Json::Value response;
+    response["status"] = "generator removed";
+    response["id"] = static_cast<Json::UInt64>(id);
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::getPdHistory(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+    uint32_t com_id) const {
+    trdp::TraceScope trace("http.getPdHistory", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (req->getParameter("field").empty()) {
+        callback(errorResponse(drogon::k400BadRequest, "Missing required parameter: field"));
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    const int64_t maxPoints = parameterAsInt64(req, "points", 500);
+    if (maxPoints < 2) {
+        callback(errorResponse(drogon::k400BadRequest, "points must be at least 2"));
+        return;
+    }
+
+    const int64_t nowUs = toMicros(std::chrono::steady_clock::now());
+
+    trdp::HistoryQuery query {};
+    query.com_id = com_id;
+    query.interface_name = req->getParameter("interface");
+    query.host_name = req->getParameter("host");
+    query.field = req->getParameter("field");
+    query.index = static_cast<uint32_t>(parameterAsInt64(req, "index", 0));
+    query.to_us = parameterAsInt64(req, "to_us", nowUs);
+    query.from_us = parameterAsInt64(req, "from_us", query.to_us - 60000000);
+    query.max_points = static_cast<size_t>(std::min(maxPoints, kMaxHistoryPoints));
+    query.mode = req->getParameter("mode") == "lttb" ? trdp::DownsampleMode::Lttb : trdp::DownsampleMode::MinMax;
+
+    const auto result = engine_->queryHistory(query);
+    if (!result.error.empty()) {
+        callback(errorResponse(drogon::k404NotFound, result.error));
+        return;
+    }
+
+    Json::Value points(Json::arrayValue);
+    for (const auto &point : result.points) {
+        Json::Value entry(Json::arrayValue);
+        entry.append(Json::Int64(point.t_us));
+        entry.append(point.value);
+        points.append(entry);
+    }
+
+    Json::Value response;
     response["com_id"] = com_id;
-    response["updated_fields"] = static_cast<Json::UInt64>(values.size());
+    response["field"] = query.field;
+    response["index"] = query.index;
+    response["from_us"] = Json::Int64(query.from_us);
+    response["to_us"] = Json::Int64(query.to_us);
+    response["mode"] = query.mode == trdp::DownsampleMode::Lttb ? "lttb" : "minmax";
+    response["raw_points"] = static_cast<Json::UInt64>(result.raw_points);
+    response["points"] = points;
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::getPdSwitchovers(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getPdSwitchovers", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    Json::Value response;
+    response["events"] = trdp::switchoversToJson(engine_->switchovers());
 
     auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
     addCorsHeaders(resp);
     callback(resp);
 }
+
+void TrdpController::getMetrics(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getMetrics", "http");
+    (void)req;
+
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setContentTypeCode(drogon::CT_TEXT_PLAIN);
+    resp->setBody(trdp::renderPrometheusMetrics(engine_));
+    callback(resp);
+}
+
+void TrdpController::getCaptureStatus(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getCaptureStatus", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(captureStatusToJson(engine_->captureStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::startCapture(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.startCapture", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    const auto json = req->getJsonObject();
+    const std::string file = json && (*json).isMember("file") ? (*json)["file"].asString() : std::string {};
+    const uint32_t slots = json && (*json).isMember("slots") ? (*json)["slots"].asUInt() : 65536u;
+    const auto path = resolveStateFile(file, "pd_capture.ring");
+
+    try {
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        engine_->startCapture(path.string(), slots);
+    } catch (const std::exception &ex) {
+        callback(errorResponse(drogon::k500InternalServerError, ex.what()));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(captureStatusToJson(engine_->captureStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::stopCapture(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.stopCapture", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    engine_->stopCapture();
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(captureStatusToJson(engine_->captureStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::exportCapture(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.exportCapture", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    const auto capturePath = resolveStateFile(req->getParameter("file"), "pd_capture.ring");
+    auto exportPath = capturePath;
+    exportPath.replace_extension(".pcapng");
+
+    try {
+        trdp::PdCaptureReader reader(capturePath.string());
+        std::ofstream out(exportPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            callback(errorResponse(drogon::k500InternalServerError, "Failed to create " + exportPath.string()));
+            return;
+        }
+        trdp::exportPcapng(reader, out);
+    } catch (const std::exception &ex) {
+        callback(errorResponse(drogon::k404NotFound, ex.what()));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newFileResponse(exportPath.string(), exportPath.filename().string(),
+                                                      drogon::CT_APPLICATION_OCTET_STREAM);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::getReplayStatus(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getReplayStatus", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(replayStatusToJson(engine_->replayStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::startReplay(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.startReplay", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    const auto json = req->getJsonObject();
+    trdp::ReplayOptions options;
+    options.path = resolveStateFile(json && (*json).isMember("file") ? (*json)["file"].asString() : std::string {},
+                                    "pd_capture.ring")
+                       .string();
+
+    if (json) {
+        if ((*json).isMember("speed")) {
+            options.speed = (*json)["speed"].asDouble();
+        }
+        for (const auto &comId : (*json)["com_ids"]) {
+            options.com_ids.insert(comId.asUInt());
+        }
+        for (const auto &iface : (*json)["interfaces"]) {
+            options.interfaces.insert(iface.asString());
+        }
+    }
+
+    try {
+        engine_->startReplay(options);
+    } catch (const std::exception &ex) {
+        callback(errorResponse(drogon::k400BadRequest, ex.what()));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(replayStatusToJson(engine_->replayStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::stopReplay(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.stopReplay", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    engine_->stopReplay();
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(replayStatusToJson(engine_->replayStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::getScenarioStatus(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getScenarioStatus", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(scenarioStatusToJson(engine_->scenarioStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::startScenario(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.startScenario", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    // Either an inline "script" or a "file" in the state directory.
+    const auto json = req->getJsonObject();
+    trdp::ScenarioOptions options;
+    if (json && (*json).isMember("script")) {
+        options.text = (*json)["script"].asString();
+    } else {
+        options.path = resolveStateFile(json && (*json).isMember("file") ? (*json)["file"].asString() : std::string {},
+                                        "scenario.txt")
+                           .string();
+    }
+    if (json && (*json).isMember("loops")) {
+        options.loops = (*json)["loops"].asUInt();
+    }
+
+    try {
+        engine_->startScenario(options);
+    } catch (const std::exception &ex) {
+        callback(errorResponse(drogon::k400BadRequest, ex.what()));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(scenarioStatusToJson(engine_->scenarioStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::stopScenario(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.stopScenario", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    engine_->stopScenario();
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(scenarioStatusToJson(engine_->scenarioStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::getPdPulls(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getPdPulls", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(
+        trdp::pdPullStatusToJson(engine_->pdPullStatus(), engine_->pdPullStats()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::startPdPull(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.startPdPull", "http");
+    const auto json = req->getJsonObject();
+    if (!json || !(*json).isMember("com_id") || !(*json)["com_id"].isUInt() || !(*json).isMember("dest_ip")) {
+        callback(errorResponse(drogon::k400BadRequest, "Missing required fields: com_id (uint), dest_ip"));
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    trdp::PdPullOptions options {};
+    options.com_id = (*json)["com_id"].asUInt();
+    options.dest_ip = (*json)["dest_ip"].asString();
+    options.interface_name = (*json).get("interface", "").asString();
+    options.host_name = (*json).get("host", "").asString();
+    options.reply_com_id = (*json).get("reply_com_id", 0u).asUInt();
+    options.timeout_us = (*json).get("timeout_us", 0u).asUInt();
+    options.count = (*json).get("count", 0u).asUInt();
+    if ((*json).isMember("rate_hz") && (*json)["rate_hz"].asDouble() > 0.0) {
+        options.interval_us = static_cast<uint32_t>(1e6 / (*json)["rate_hz"].asDouble());
+    } else {
+        options.interval_us = (*json).get("interval_us", 100000u).asUInt();
+    }
+
+    uint64_t id = 0u;
+    try {
+        id = engine_->startPdPull(options);
+    } catch (const std::exception &ex) {
+        callback(errorResponse(drogon::k400BadRequest, ex.what()));
+        return;
+    }
+
+    Json::Value response;
+    response["status"] = "pd pull started";
+    response["id"] = static_cast<Json::UInt64>(id);
+    response["com_id"] = options.com_id;
+    response["interval_us"] = options.interval_us;
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::stopPdPull(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+    uint64_t id) const {
+    trdp::TraceScope trace("http.stopPdPull", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    if (!engine_->stopPdPull(id)) {
+        callback(errorResponse(drogon::k404NotFound, "Unknown PD pull id"));
+        return;
+    }
+
+    Json::Value response;
+    response["status"] = "pd pull stopped";
+    response["id"] = static_cast<Json::UInt64>(id);
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::sendMdRequest(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.sendMdRequest", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    const auto json = req->getJsonObject();
+    if (!json) {
+        callback(errorResponse(drogon::k400BadRequest, "Missing JSON body"));
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    trdp::MdRequestOptions options;
+    const std::string error = trdp::mdRequestFromJson(*json, options);
+    if (!error.empty()) {
+        callback(errorResponse(drogon::k400BadRequest, error));
+        return;
+    }
+    if (options.count > kMaxMdBurst) {
+        callback(errorResponse(drogon::k400BadRequest, "count exceeds " + std::to_string(kMaxMdBurst)));
+        return;
+    }
+
+    std::vector<uint64_t> ids;
+    try {
+        ids = engine_->mdRequest(options);
+    } catch (const std::exception &ex) {
+        callback(errorResponse(drogon::k400BadRequest, ex.what()));
+        return;
+    }
+
+    Json::Value idList(Json::arrayValue);
+    for (const auto id : ids) {
+        idList.append(static_cast<Json::UInt64>(id));
+    }
+
+    Json::Value response;
+    response["status"] = "md requests sent";
+    response["com_id"] = options.com_id;
+    response["ids"] = idList;
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    resp->setStatusCode(drogon::k202Accepted);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::sendMdNotify(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.sendMdNotify", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    const auto json = req->getJsonObject();
+    if (!json) {
+        callback(errorResponse(drogon::k400BadRequest, "Missing JSON body"));
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    trdp::MdRequestOptions options;
+    const std::string error = trdp::mdRequestFromJson(*json, options);
+    if (!error.empty()) {
+        callback(errorResponse(drogon::k400BadRequest, error));
+        return;
+    }
+    if (options.count > kMaxMdBurst) {
+        callback(errorResponse(drogon::k400BadRequest, "count exceeds " + std::to_string(kMaxMdBurst)));
+        return;
+    }
+
+    try {
+        engine_->mdNotify(options);
+    } catch (const std::exception &ex) {
+        callback(errorResponse(drogon::k400BadRequest, ex.what()));
+        return;
+    }
+
+    Json::Value response;
+    response["status"] = "md notification sent";
+    response["com_id"] = options.com_id;
+    response["count"] = std::max<uint32_t>(options.count, 1u);
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::getMdResult(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+    uint64_t id) const {
+    trdp::TraceScope trace("http.getMdResult", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    const auto result = engine_->mdResult(id);
+    if (!result) {
+        callback(errorResponse(drogon::k404NotFound, "Unknown or expired MD request id"));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(trdp::mdResultToJson(*result));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::getMdStats(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getMdStats", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    Json::Value response;
+    response["pending"] = static_cast<Json::UInt64>(engine_->mdPendingCount());
+    response["com_ids"] = trdp::mdStatsToJson(engine_->mdStats());
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::addMdResponder(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.addMdResponder", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    const auto json = req->getJsonObject();
+    if (!json || !(*json).isMember("com_id") || !(*json)["com_id"].isUInt()) {
+        callback(errorResponse(drogon::k400BadRequest, "Missing required field: com_id (uint)"));
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    trdp::MdResponderOptions options {};
+    options.com_id = (*json)["com_id"].asUInt();
+    options.interface_name = (*json).get("interface", "").asString();
+    options.host_name = (*json).get("host", "").asString();
+    options.reply_com_id = (*json).get("reply_com_id", 0u).asUInt();
+    options.request_confirm = (*json).get("confirm", false).asBool();
+    if (!trdp::hexToPayload((*json).get("payload_hex", "").asString(), options.payload)) {
+        callback(errorResponse(drogon::k400BadRequest, "payload_hex must be an even-length hex string"));
+        return;
+    }
+
+    try {
+        engine_->addMdResponder(options);
+    } catch (const std::exception &ex) {
+        callback(errorResponse(drogon::k400BadRequest, ex.what()));
+        return;
+    }
+
+    Json::Value response;
+    response["status"] = "md responder added";
+    response["com_id"] = options.com_id;
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::removeMdResponder(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+    uint32_t com_id) const {
+    trdp::TraceScope trace("http.removeMdResponder", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    engine_->removeMdResponder(com_id, req->getParameter("interface"), req->getParameter("host"));
+
+    Json::Value response;
+    response["status"] = "md responder removed";
+    response["com_id"] = com_id;
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::getWatches(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getWatches", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(trdp::watchStatusToJson(engine_->watchStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::addWatch(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.addWatch", "http");
+    const auto json = req->getJsonObject();
+    if (!json) {
+        callback(errorResponse(drogon::k400BadRequest, "Request body must be JSON"));
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    trdp::PdWatchSpec spec;
+    const std::string error = trdp::watchSpecFromJson(*json, spec);
+    if (!error.empty()) {
+        callback(errorResponse(drogon::k400BadRequest, error));
+        return;
+    }
+
+    uint64_t id = 0u;
+    try {
+        id = engine_->addWatch(spec);
+    } catch (const std::exception &ex) {
+        callback(errorResponse(drogon::k400BadRequest, ex.what()));
+        return;
+    }
+
+    Json::Value response;
+    response["status"] = "watch added";
+    response["id"] = static_cast<Json::UInt64>(id);
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    resp->setStatusCode(drogon::k201Created);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::removeWatch(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback,
+    uint64_t id) const {
+    trdp::TraceScope trace("http.removeWatch", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (engine_ == nullptr) {
+        callback(errorResponse(drogon::k500InternalServerError, "TRDP engine is not initialized"));
+        return;
+    }
+
+    if (!engine_->removeWatch(id)) {
+        callback(errorResponse(drogon::k404NotFound, "Unknown watch id"));
+        return;
+    }
+
+    Json::Value response;
+    response["status"] = "watch removed";
+    response["id"] = static_cast<Json::UInt64>(id);
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::getTraceStatus(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.getTraceStatus", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(traceStatusToJson(trdp::traceStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::startTrace(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.startTrace", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    const auto json = req->getJsonObject();
+    const uint32_t events = json && (*json).isMember("events_per_thread") ? (*json)["events_per_thread"].asUInt()
+                                                                           : kDefaultTraceEvents;
+    if (events == 0u || events > kMaxTraceEvents) {
+        callback(errorResponse(drogon::k400BadRequest,
+                               "events_per_thread must be between 1 and " + std::to_string(kMaxTraceEvents)));
+        return;
+    }
+
+    trdp::traceStart(events);
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(traceStatusToJson(trdp::traceStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::stopTrace(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.stopTrace", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    trdp::traceStop();
+
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(traceStatusToJson(trdp::traceStatus()));
+    addCorsHeaders(resp);
+    callback(resp);
+}
+
+void TrdpController::exportTrace(
+    const drogon::HttpRequestPtr &req,
+    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const {
+    trdp::TraceScope trace("http.exportTrace", "http");
+    if (handlePreflight(req, callback)) {
+        return;
+    }
+
+    if (trdp::traceStatus().active) {
+        callback(errorResponse(drogon::k409Conflict, "Stop the trace before downloading it"));
+        return;
+    }
+
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+    resp->addHeader("Content-Disposition", "attachment; filename=\"trdp_trace.json\"");
+    resp->setBody(trdp::traceExportChrome());
+    addCorsHeaders(resp);
+    callback(resp);
+}
@@ -5,6 +5,8 @@
 #include <sstream>
 #include <string>
 
+#include <vos_sock.h>
+
 namespace trdp {
 namespace {
 
@@ -24,15 +26,6 @@ Json::Int64 toMillis(const std::chrono::steady_clock::time_point &tp) {
     return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
 }
 
-std::string payloadToHex(const std::vector<uint8_t> &payload) {
-    std::ostringstream stream;
-    stream << std::hex << std::setfill('0');
-    for (const auto byte : payload) {
-        stream << std::setw(2) << static_cast<unsigned int>(byte);
-    }
-    return stream.str();
-}
-
 std::string typeToString(uint32_t type) {
     switch (type) {
         case TRDP_BOOL8:
@@ -62,64 +55,435 @@ Json::Value valueToJson(uint32_t type, int64_t value) {
     return Json::Int64(value);
 }
 
+std::string mdStateToString(MdState state) {
+    switch (state) {
+        case MdState::Pending:
+            return "pending";
+        case MdState::Replied:
+            return "replied";
+        case MdState::Timeout:
+            return "timeout";
+        case MdState::Error:
+            return "error";
+    }
+    return "unknown";
+}
+
+Json::Value histogramToJson(const HistogramSnapshot &histogram) {
+    Json::Value json(Json::objectValue);
+    Json::Value buckets(Json::arrayValue);
+    for (size_t idx = 0u; idx < histogram.counts.size(); ++idx) {
+        Json::Value bucket(Json::objectValue);
+        bucket["le"] = idx < histogram.bounds.size() ? Json::Value(histogram.bounds[idx]) : Json::Value("+Inf");
+        bucket["count"] = static_cast<Json::UInt64>(histogram.counts[idx]);
+        buckets.append(bucket);
+    }
+    json["buckets"] = buckets;
+    json["count"] = static_cast<Json::UInt64>(histogram.count);
+    json["sum"] = histogram.sum;
+    return json;
+}
+
 }  // namespace
 
+Json::Value pdPullStatusToJson(const std::vector<PdPullStatus> &jobs, const std::vector<PdPullStatsSnapshot> &stats) {
+    Json::Value jobList(Json::arrayValue);
+    for (const auto &job : jobs) {
+        Json::Value item(Json::objectValue);
+        item["id"] = static_cast<Json::UInt64>(job.id);
+        item["com_id"] = static_cast<Json::UInt64>(job.options.com_id);
+        item["reply_com_id"] = static_cast<Json::UInt64>(job.options.reply_com_id);
+        item["interface"] = job.options.interface_name;
+        item["host"] = job.options.host_name;
+        item["dest_ip"] = job.options.dest_ip;
+        item["interval_us"] = job.options.interval_us;
+        item["timeout_us"] = job.options.timeout_us;
+        item["count"] = job.options.count;
+        item["active"] = job.active;
+        item["sent"] = static_cast<Json::UInt64>(job.sent);
+        item["replies"] = static_cast<Json::UInt64>(job.replies);
+        item["timeouts"] = static_cast<Json::UInt64>(job.timeouts);
+        item["errors"] = static_cast<Json::UInt64>(job.errors);
+        item["outstanding"] = static_cast<Json::UInt64>(job.outstanding);
+        jobList.append(item);
+    }
+
+    Json::Value statList(Json::arrayValue);
+    for (const auto &entry : stats) {
+        Json::Value item(Json::objectValue);
+        item["com_id"] = static_cast<Json::UInt64>(entry.com_id);
+        item["requests"] = static_cast<Json::UInt64>(entry.requests);
+        item["replies"] = static_cast<Json::UInt64>(entry.replies);
+        item["timeouts"] = static_cast<Json::UInt64>(entry.timeouts);
+        item["rtt_us"] = histogramToJson(entry.rtt_us);
+        statList.append(item);
+    }
+
+    Json::Value json(Json::objectValue);
+    json["jobs"] = jobList;
+    json["com_ids"] = statList;
+    return json;
+}
+
+Json::Value mdResultToJson(const MdResult &result) {
+    Json::Value json(Json::objectValue);
+    json["id"] = static_cast<Json::UInt64>(result.id);
+    json["com_id"] = static_cast<Json::UInt64>(result.com_id);
+    json["state"] = mdStateToString(result.state);
+    json["result_code"] = result.result_code;
+    json["replies"] = result.replies;
+    json["src_ip"] = result.src_ip != 0u ? std::string(vos_ipDotted(result.src_ip)) : std::string {};
+    json["rtt_us"] = result.rtt_us;
+    json["payload_hex"] = payloadToHex(result.reply_payload.data(), result.reply_payload.size());
+    return json;
+}
+
+Json::Value mdStatsToJson(const std::vector<MdStatsSnapshot> &stats) {
+    Json::Value json(Json::arrayValue);
+    for (const auto &entry : stats) {
+        Json::Value item(Json::objectValue);
+        item["com_id"] = static_cast<Json::UInt64>(entry.com_id);
+        item["requests"] = static_cast<Json::UInt64>(entry.requests);
+        item["replies"] = static_cast<Json::UInt64>(entry.replies);
+        item["timeouts"] = static_cast<Json::UInt64>(entry.timeouts);
+        item["errors"] = static_cast<Json::UInt64>(entry.errors);
+        item["notifications_sent"] = static_cast<Json::UInt64>(entry.notifications_sent);
+        item["requests_received"] = static_cast<Json::UInt64>(entry.requests_received);
+        item["notifications_received"] = static_cast<Json::UInt64>(entry.notifications_received);
+        item["confirms_received"] = static_cast<Json::UInt64>(entry.confirms_received);
+        item["rtt_us"] = histogramToJson(entry.rtt_us);
+        json.append(item);
+    }
+    return json;
+}
+
+bool hexToPayload(const std::string &hex, std::vector<uint8_t> &payload) {
+    if (hex.size() % 2u != 0u) {
+        return false;
+    }
+
+    payload.clear();
+    payload.reserve(hex.size() / 2u);
+    for (size_t idx = 0u; idx < hex.size(); idx += 2u) {
+        const auto nibble = [](char c) -> int {
+            if (c >= '0' && c <= '9') {
+                return c - '0';
+            }
+            if (c >= 'a' && c <= 'f') {
+                return c - 'a' + 10;
+            }
+            if (c >= 'A' && c <= 'F') {
+                return c - 'A' + 10;
+            }
+            return -1;
+        };
+
+        const int high = nibble(hex[idx]);
+        const int low = nibble(hex[idx + 1u]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        payload.push_back(static_cast<uint8_t>((high << 4) | low));
+    }
+    return true;
+}
+
+std::string mdRequestFromJson(const Json::Value &json, MdRequestOptions &options) {
+    if (!json.isMember("com_id") || !json["com_id"].isUInt() || !json.isMember("dest_ip") || !json["dest_ip"].isString()) {
+        return "Missing required fields: com_id (uint), dest_ip (string)";
+    }
+
+    options = MdRequestOptions {};
+    options.com_id = json["com_id"].asUInt();
+    options.dest_ip = json["dest_ip"].asString();
+    options.interface_name = json.get("interface", "").asString();
+    options.host_name = json.get("host", "").asString();
+    options.timeout_us = json.get("timeout_us", 0u).asUInt();
+    options.expected_replies = json.get("replies", 1u).asUInt();
+    options.count = json.get("count", 1u).asUInt();
+
+    if (!hexToPayload(json.get("payload_hex", "").asString(), options.payload)) {
+        return "payload_hex must be an even-length hex string";
+    }
+    return {};
+}
+
+std::string watchSpecFromJson(const Json::Value &json, PdWatchSpec &spec) {
+    if (!json.isMember("com_id") || !json["com_id"].isUInt() || !json.isMember("field") || !json["field"].isString() ||
+        !json.isMember("op") || !json["op"].isString()) {
+        return "Missing required fields: com_id (uint), field (string), op (string)";
+    }
+
+    spec = PdWatchSpec {};
+    spec.com_id = json["com_id"].asUInt();
+    spec.field = json["field"].asString();
+    spec.interface_name = json.get("interface", "").asString();
+    spec.host_name = json.get("host", "").asString();
+    spec.index = json.get("index", 0u).asUInt();
+    spec.bit = json.get("bit", -1).asInt();
+    spec.label = json.get("label", "").asString();
+
+    try {
+        spec.op = parseWatchOp(json["op"].asString());
+    } catch (const std::exception &ex) {
+        return ex.what();
+    }
+
+    if (spec.op != WatchOp::Changed) {
+        if (!json.isMember("value") || !json["value"].isNumeric()) {
+            return "Threshold rules require a numeric value";
+        }
+        spec.threshold = json["value"].asDouble();
+    }
+    return {};
+}
+
+Json::Value watchStatusToJson(const std::vector<PdWatchStatus> &rules) {
+    Json::Value json(Json::arrayValue);
+    for (const auto &rule : rules) {
+        Json::Value item(Json::objectValue);
+        item["id"] = static_cast<Json::UInt64>(rule.id);
+        item["com_id"] = rule.spec.com_id;
+        item["interface"] = rule.spec.interface_name;
+        item["host"] = rule.spec.host_name;
+        item["field"] = rule.spec.field;
+        item["index"] = rule.spec.index;
+        item["op"] = watchOpToString(rule.spec.op);
+        item["value"] = rule.spec.threshold;
+        item["bit"] = rule.spec.bit;
+        item["label"] = rule.spec.label;
+        item["hits"] = static_cast<Json::UInt64>(rule.hits);
+        item["condition"] = rule.condition;
+        item["last_value"] = rule.has_value ? Json::Value(static_cast<Json::Int64>(rule.last_value)) : Json::Value();
+        item["last_hit_us"] = static_cast<Json::Int64>(rule.last_hit_ns / 1000);
+        json.append(item);
+    }
+    return json;
+}
+
+std::string generatorSpecFromJson(const Json::Value &json, PdGeneratorSpec &spec) {
+    if (!json.isMember("com_id") || !json["com_id"].isUInt() || !json.isMember("field") || !json["field"].isString() ||
+        !json.isMember("kind") || !json["kind"].isString()) {
+        return "Missing required fields: com_id (uint), field (string), kind (string)";
+    }
+
+    spec = PdGeneratorSpec {};
+    spec.com_id = json["com_id"].asUInt();
+    spec.field = json["field"].asString();
+    spec.host_name = json.get("host", "").asString();
+    spec.min = json.get("min", 0.0).asDouble();
+    spec.max = json.get("max", 1.0).asDouble();
+    spec.period_us = json.get("period_us", 1000000u).asUInt64();
+    spec.duty = json.get("duty", 0.5).asDouble();
+    spec.phase_deg = json.get("phase_deg", 0.0).asDouble();
+    spec.step = json.get("step", 1.0).asDouble();
+    spec.seed = json.get("seed", 1u).asUInt64();
+
+    try {
+        spec.kind = parseGeneratorKind(json["kind"].asString());
+    } catch (const std::exception &ex) {
+        return ex.what();
+    }
+
+    for (const auto &value : json["table"]) {
+        if (!value.isNumeric()) {
+            return "Generator table values must be numbers";
+        }
+        spec.table.push_back(value.asDouble());
+    }
+    return {};
+}
+
+Json::Value generatorStatusToJson(const std::vector<PdGeneratorStatus> &generators) {
+    Json::Value json(Json::arrayValue);
+    for (const auto &generator : generators) {
+        Json::Value item(Json::objectValue);
+        item["id"] = static_cast<Json::UInt64>(generator.id);
+        item["com_id"] = generator.spec.com_id;
+        item["host"] = generator.spec.host_name;
+        item["field"] = generator.spec.field;
+        item["kind"] = generatorKindToString(generator.spec.kind);
+        item["min"] = generator.spec.min;
+        item["max"] = generator.spec.max;
+        item["period_us"] = static_cast<Json::UInt64>(generator.spec.period_us);
+        item["duty"] = generator.spec.duty;
+        item["phase_deg"] = generator.spec.phase_deg;
+        item["step"] = generator.spec.step;
+        Json::Value table(Json::arrayValue);
+        for (double value : generator.spec.table) {
+            table.append(value);
+        }
+        item["table"] = table;
+        item["seed"] = static_cast<Json::UInt64>(generator.spec.seed);
+        item["evaluations"] = static_cast<Json::UInt64>(generator.evaluations);
+        item["last_value"] = generator.last_value;
+        json.append(item);
+    }
+    return json;
+}
+
+Json::Value watchEventToJson(const PdWatchEvent &event) {
+    Json::Value json(Json::objectValue);
+    json["rule_id"] = static_cast<Json::UInt64>(event.rule_id);
+    json["com_id"] = event.com_id;
+    json["t_us"] = static_cast<Json::Int64>(event.time_ns / 1000);
+    json["value"] = static_cast<Json::Int64>(event.value);
+    json["previous"] = static_cast<Json::Int64>(event.previous);
+    return json;
+}
+
+std::string payloadToHex(const uint8_t *data, size_t size) {
+    std::ostringstream stream;
+    stream << std::hex << std::setfill('0');
+    for (size_t idx = 0u; idx < size; ++idx) {
+        stream << std::setw(2) << static_cast<unsigned int>(data[idx]);
+    }
+    return stream.str();
+}
+
+Json::Value decodedFieldsToJson(const std::vector<DecodedField> &fields) {
+    Json::Value decoded_fields(Json::arrayValue);
+    for (const auto &field : fields) {
+        Json::Value field_json(Json::objectValue);
+        field_json["name"] = field.name;
+        field_json["type"] = typeToString(field.type);
+
+        if (field.values.empty()) {
+            field_json["value"] = Json::nullValue;
+        } else if (field.values.size() == 1u) {
+            field_json["value"] = valueToJson(field.type, field.values.front());
+        } else {
+            Json::Value arr(Json::arrayValue);
+            for (const auto value : field.values) {
+                arr.append(valueToJson(field.type, value));
+            }
+            field_json["value"] = arr;
+        }
+
+        decoded_fields.append(field_json);
+    }
+
+    return decoded_fields;
+}
+
+Json::Value pdSourcesToJson(const PdSourceSet &sources) {
+    Json::Value json(Json::arrayValue);
+    for (const auto &source : sources) {
+        Json::Value item(Json::objectValue);
+        item["src_ip"] = vos_ipDotted(source.src_ip);
+        item["role"] = &source == sources.active() ? "active" : "standby";
+        item["configured"] = source.configured;
+        item["rx_count"] = static_cast<Json::UInt64>(source.rx_count);
+        item["last_seen"] = source.rx_count > 0u ? toMillis(source.last_rx_time) : Json::Int64(0);
+        item["last_period_us"] = source.last_period_us;
+        item["avg_period_us"] = source.avg_period_us;
+        item["last_seq"] = source.seq.valid ? Json::Value(source.seq.last_seq) : Json::Value();
+        item["lost"] = static_cast<Json::UInt64>(source.seq.lost);
+        item["duplicates"] = static_cast<Json::UInt64>(source.seq.duplicates);
+        item["reordered"] = static_cast<Json::UInt64>(source.seq.reordered);
+        item["resets"] = static_cast<Json::UInt64>(source.seq.resets);
+        item["longest_burst"] = source.seq.longest_burst;
+        json.append(item);
+    }
+    return json;
+}
+
 Json::Value pdRuntimeToJson(const PdRuntime &pd, const TrdpEngine &engine) {
     Json::Value json(Json::objectValue);
 
     if (pd.def != nullptr) {
         json["interface"] = pd.def->interface_name;
+        json["host"] = pd.def->host_name;
         json["com_id"] = static_cast<Json::UInt64>(pd.def->com_id);
         json["name"] = pd.def->name;
         json["dataset_id"] = static_cast<Json::UInt64>(pd.def->dataset_id);
         json["direction"] = directionToString(pd.def->direction);
         json["cycle_us"] = static_cast<Json::UInt64>(pd.def->cycle_us);
+        json["pull"] = pd.def->pull;
     } else {
         json["interface"] = Json::nullValue;
+        json["host"] = Json::nullValue;
         json["com_id"] = Json::nullValue;
         json["name"] = Json::nullValue;
         json["dataset_id"] = Json::nullValue;
         json["direction"] = Json::nullValue;
         json["cycle_us"] = Json::nullValue;
+        json["pull"] = Json::nullValue;
     }
 
     Json::Value stats(Json::objectValue);
     stats["rx_count"] = static_cast<Json::UInt64>(pd.rx_count);
+    stats["change_count"] = static_cast<Json::UInt64>(pd.change_count);
     stats["tx_count"] = static_cast<Json::UInt64>(pd.tx_count);
+    stats["tx_missed_cycles"] = static_cast<Json::UInt64>(pd.tx_missed_cycles);
+    stats["tx_last_lateness_us"] = pd.tx_last_lateness_us;
     stats["avg_period_us"] = pd.avg_period_us;
     stats["last_period_us"] = pd.last_period_us;
     stats["timeout_count"] = static_cast<Json::UInt64>(pd.timeout_count);
     json["stats"] = stats;
 
+    const PdSource *active = pd.sources.active();
+    json["active_source"] = active != nullptr ? Json::Value(vos_ipDotted(active->src_ip)) : Json::Value();
+    json["sources"] = pdSourcesToJson(pd.sources);
+
     Json::Value last_rx(Json::objectValue);
     last_rx["timestamp"] = pd.last_rx_valid ? toMillis(pd.last_rx_time) : Json::Int64(0);
     last_rx["valid"] = pd.last_rx_valid;
-    last_rx["raw_hex"] = payloadToHex(pd.last_rx_payload);
+    last_rx["changed"] = pd.change_count > 0u ? toMillis(pd.last_change_time) : Json::Int64(0);
+    last_rx["raw_hex"] = payloadToHex(pd.last_rx_payload.data(), pd.last_rx_payload.size());
 
-    Json::Value decoded_fields(Json::arrayValue);
-    for (const auto &field : engine.decodeLastRx(pd)) {
-        Json::Value field_json(Json::objectValue);
-        field_json["name"] = field.name;
-        field_json["type"] = typeToString(field.type);
+    last_rx["decoded_fields"] = decodedFieldsToJson(engine.decodeLastRx(pd));
+    json["last_rx"] = last_rx;
 
-        if (field.values.empty()) {
-            field_json["value"] = Json::nullValue;
-        } else if (field.values.size() == 1u) {
-            field_json["value"] = valueToJson(field.type, field.values.front());
-        } else {
-            Json::Value arr(Json::arrayValue);
-            for (const auto value : field.values) {
-                arr.append(valueToJson(field.type, value));
-            }
-            field_json["value"] = arr;
-        }
+    return json;
+}
 
-        decoded_fields.append(field_json);
+Json::Value configJobToJson(const ConfigJobStatus &job) {
+    Json::Value json(Json::objectValue);
+    json["id"] = static_cast<Json::UInt64>(job.id);
+    json["path"] = job.path;
+    Json::Value hosts(Json::arrayValue);
+    for (const auto &host : job.host_names) {
+        hosts.append(host);
+    }
+    json["host_names"] = hosts;
+    json["state"] = configJobStateName(job.state);
+    json["phase"] = configLoadPhaseName(job.phase);
+    json["total_ms"] = job.total_ms;
+    json["rolled_back"] = job.rolled_back;
+    if (!job.error.empty()) {
+        json["error"] = job.error;
     }
 
-    last_rx["decoded_fields"] = decoded_fields;
-    json["last_rx"] = last_rx;
+    Json::Value phases(Json::arrayValue);
+    for (size_t idx = 0u; idx < kConfigLoadPhaseCount; ++idx) {
+        const auto &phase = job.phases[idx];
+        Json::Value item(Json::objectValue);
+        item["name"] = configLoadPhaseName(static_cast<ConfigLoadPhase>(idx));
+        item["state"] = !phase.started ? "pending" : phase.finished ? "done" : "running";
+        if (phase.started && !phase.finished && job.state == ConfigJobState::Failed) {
+            item["state"] = "failed";
+        }
+        item["duration_ms"] = phase.duration_ms;
+        phases.append(item);
+    }
+    json["phases"] = phases;
+    return json;
+}
 
+Json::Value switchoversToJson(const std::vector<PdSwitchoverEvent> &events) {
+    Json::Value json(Json::arrayValue);
+    for (const auto &event : events) {
+        Json::Value item(Json::objectValue);
+        item["com_id"] = event.com_id;
+        item["interface"] = event.interface_name;
+        item["host"] = event.host_name;
+        item["from_ip"] = vos_ipDotted(event.from_ip);
+        item["to_ip"] = vos_ipDotted(event.to_ip);
+        item["t_us"] = static_cast<Json::Int64>(event.time_ns / 1000);
+        item["gap_us"] = static_cast<Json::Int64>(event.gap_ns / 1000);
+        json.append(item);
+    }
     return json;
 }
 
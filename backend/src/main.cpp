@@ -3,9 +3,14 @@
 #include <memory>
 
 #include "trdp_engine.hpp"
+#include "trdp/log.hpp"
 
+#include "controllers/MdWebSocket.h"
+#include "controllers/PdWebSocket.h"
 #include "controllers/TrdpController.h"
+#include "config_index.h"
 #include "config_paths.hpp"
+#include "metrics_exporter.h"
 
 std::unique_ptr<trdp::TrdpEngine> g_trdpEngine;
 
@@ -30,7 +35,7 @@ bool ensureConfigAvailable(const std::string &xmlPath) {
 
 int main() {
     const std::string xmlPath = resolveXmlPath();
-    const std::string hostName = resolveHostName();
+    const std::vector<std::string> hostNames = resolveHostNames();
     const std::string listenAddress = resolveListenAddress();
     const uint16_t listenPort = resolveListenPort();
 
@@ -44,9 +49,52 @@ int main() {
         return 1;
     }
 
+    try {
+        trdp::logSetLevels(resolveLogLevels());
+        trdp::LogOptions logOptions;
+        logOptions.path = resolveLogPath();
+        trdp::logStart(logOptions);
+    } catch (const std::exception &ex) {
+        LOG_FATAL << "Failed to start engine logging: " << ex.what();
+        return 1;
+    }
+
     try {
         g_trdpEngine = std::make_unique<trdp::TrdpEngine>();
-        g_trdpEngine->loadConfig(xmlPath, hostName);
+        g_trdpEngine->setHistoryDepth(resolveHistoryDepth());
+        g_trdpEngine->setLoopback(shouldUseLoopback());
+
+        trdp::JournalState journaled;
+        const std::string journalPath = resolveStateJournalPath();
+        if (!journalPath.empty()) {
+            std::error_code dirErr;
+            std::filesystem::create_directories(std::filesystem::path(journalPath).parent_path(), dirErr);
+            try {
+                journaled = g_trdpEngine->openStateJournal(journalPath);
+            } catch (const std::exception &ex) {
+                LOG_WARN << "State journal disabled: " << ex.what();
+            }
+        }
+
+        // Come back with the configuration that was active before the
+        // restart; the environment only picks the first one.
+        bool restored = false;
+        if (!journaled.xml_path.empty() && std::filesystem::exists(journaled.xml_path)) {
+            try {
+                g_trdpEngine->loadConfig(journaled.xml_path, journaled.host_names);
+                const size_t telegrams = g_trdpEngine->restoreState(journaled);
+                LOG_INFO << "Restored " << journaled.xml_path << " and " << telegrams << " telegrams from "
+                         << journalPath;
+                restored = true;
+            } catch (const std::exception &ex) {
+                LOG_WARN << "Failed to restore " << journaled.xml_path << ": " << ex.what();
+            }
+        }
+        if (!restored) {
+            g_trdpEngine->loadConfig(xmlPath, hostNames);
+        }
+
+        g_trdpEngine->setShmExport(resolveShmName());
         g_trdpEngine->start();
     } catch (const std::exception &ex) {
         LOG_FATAL << "Failed to initialize TRDP engine: " << ex.what();
@@ -72,12 +120,37 @@ int main() {
         app.enableRunAsDaemon();
     }
 
+    app.registerPostHandlingAdvice([](const drogon::HttpRequestPtr &req, const drogon::HttpResponsePtr &) {
+        const auto elapsedUs =
+            trantor::Date::now().microSecondsSinceEpoch() - req->creationDate().microSecondsSinceEpoch();
+        trdp::recordHttpLatency(req->getMethodString(), req->path(), static_cast<double>(elapsedUs) / 1e6);
+    });
+
     TrdpController::setEngine(g_trdpEngine.get());
+    MdWebSocket::setEngine(g_trdpEngine.get());
+    PdWebSocket::setEngine(g_trdpEngine.get());
+
+    // Started from the loop so the worker thread survives daemonisation.
+    trdp::ConfigIndex configIndex;
+    app.registerBeginningAdvice([&configIndex]() { configIndex.start(resolveConfigDirectory()); });
+    TrdpController::setConfigIndex(&configIndex);
+
+    const trdp::PdShmStatus shm = g_trdpEngine->shmExportStatus();
+    if (!shm.error.empty()) {
+        LOG_WARN << "Shared memory export disabled: " << shm.error;
+    } else if (shm.active) {
+        LOG_INFO << "Exporting " << shm.slot_count << " telegrams to shared memory " << shm.name;
+    }
 
     LOG_INFO << "Starting TRDP backend" << (runAsDaemon ? " as daemon" : " in foreground");
 
     app.run();
+    TrdpController::setConfigIndex(nullptr);
+    configIndex.stop();
+    g_trdpEngine->setMdResultHandler({});
+    g_trdpEngine->setWatchHandler({});
     g_trdpEngine->stop();
+    trdp::logStop();
     return 0;
 }
 
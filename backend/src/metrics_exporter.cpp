@@ -0,0 +1,258 @@
+#include "metrics_exporter.h"
+
+#include <cctype>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace trdp {
+namespace {
+
+struct RouteMetrics {
+    RouteMetrics() : latency_seconds({0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5}) {}
+
+    Histogram latency_seconds;
+};
+
+// Route series are created once and never freed, so every thread can cache
+// raw pointers and only touches the registry mutex on first sight of a route.
+// The number of series is capped so stray URLs cannot grow it without bound.
+constexpr size_t kMaxRoutes = 256u;
+
+struct RouteRegistry {
+    std::mutex mtx;
+    std::map<std::pair<std::string, std::string>, std::unique_ptr<RouteMetrics>> routes;
+};
+
+RouteRegistry &routeRegistry() {
+    static RouteRegistry registry;
+    return registry;
+}
+
+std::string normalizeRoute(const std::string &path) {
+    std::string route;
+    route.reserve(path.size());
+
+    size_t pos = 0u;
+    while (pos < path.size()) {
+        const size_t next = path.find('/', pos + 1u);
+        const std::string segment = path.substr(pos, next == std::string::npos ? std::string::npos : next - pos);
+
+        bool numeric = segment.size() > 1u;
+        for (size_t idx = 1u; idx < segment.size() && numeric; ++idx) {
+            numeric = std::isdigit(static_cast<unsigned char>(segment[idx])) != 0;
+        }
+
+        route += numeric ? std::string("/{id}") : segment;
+        pos = next == std::string::npos ? path.size() : next;
+    }
+
+    return route.empty() ? std::string("/") : route;
+}
+
+RouteMetrics &routeMetrics(const std::string &method, const std::string &route) {
+    thread_local std::map<std::pair<std::string, std::string>, RouteMetrics *> cache;
+
+    auto key = std::make_pair(method, route);
+    const auto cached = cache.find(key);
+    if (cached != cache.end()) {
+        return *cached->second;
+    }
+
+    auto &registry = routeRegistry();
+    std::lock_guard<std::mutex> lock(registry.mtx);
+    const bool overflow = registry.routes.size() >= kMaxRoutes && registry.routes.count(key) == 0u;
+    if (overflow) {
+        key.second = "other";
+    }
+    auto &slot = registry.routes[key];
+    if (!slot) {
+        slot = std::make_unique<RouteMetrics>();
+    }
+    if (!overflow) {
+        cache.emplace(std::move(key), slot.get());
+    }
+    return *slot;
+}
+
+std::string escapeLabel(const std::string &value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const char ch : value) {
+        if (ch == '\\' || ch == '"') {
+            escaped.push_back('\\');
+            escaped.push_back(ch);
+        } else if (ch == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped.push_back(ch);
+        }
+    }
+    return escaped;
+}
+
+void writeHeader(std::ostringstream &out, const char *name, const char *type, const char *help) {
+    out << "# HELP " << name << ' ' << help << '\n';
+    out << "# TYPE " << name << ' ' << type << '\n';
+}
+
+void writeHistogram(std::ostringstream &out, const std::string &name, const std::string &labels,
+                    const HistogramSnapshot &snapshot) {
+    const std::string prefix = labels.empty() ? std::string {} : labels + ",";
+
+    uint64_t cumulative = 0u;
+    for (size_t idx = 0u; idx < snapshot.bounds.size(); ++idx) {
+        cumulative += snapshot.counts[idx];
+        out << name << "_bucket{" << prefix << "le=\"" << snapshot.bounds[idx] << "\"} " << cumulative << '\n';
+    }
+    cumulative += snapshot.counts.back();
+    out << name << "_bucket{" << prefix << "le=\"+Inf\"} " << cumulative << '\n';
+
+    const std::string braces = labels.empty() ? std::string {} : "{" + labels + "}";
+    out << name << "_sum" << braces << ' ' << snapshot.sum << '\n';
+    out << name << "_count" << braces << ' ' << snapshot.count << '\n';
+}
+
+std::string telegramLabels(const TelegramMetrics &telegram) {
+    std::ostringstream labels;
+    labels << "com_id=\"" << telegram.com_id << "\",host=\"" << escapeLabel(telegram.host_name) << "\",interface=\""
+           << escapeLabel(telegram.interface_name) << "\",name=\"" << escapeLabel(telegram.name) << '"';
+    return labels.str();
+}
+
+void writeEngineMetrics(std::ostringstream &out, const TrdpEngine &engine) {
+    const auto &engineMetrics = engine.engineMetrics();
+
+    writeHeader(out, "trdp_config_loads_total", "counter", "Number of configurations loaded by the engine.");
+    out << "trdp_config_loads_total " << engineMetrics.config_loads.value() << '\n';
+
+    writeHeader(out, "trdp_scheduler_lateness_us", "histogram", "Delay between the intended and actual scheduler wake-up.");
+    writeHistogram(out, "trdp_scheduler_lateness_us", {}, engineMetrics.scheduler_lateness_us.snapshot());
+
+    writeHeader(out, "trdp_scheduler_overruns_total", "counter", "Scheduler iterations that took longer than one tick.");
+    out << "trdp_scheduler_overruns_total " << engineMetrics.scheduler_overruns.value() << '\n';
+
+    writeHeader(out, "trdp_scheduler_overrun", "gauge", "1 if the scheduler overran a tick since the engine was started.");
+    out << "trdp_scheduler_overrun " << (engineMetrics.scheduler_overrun.load(std::memory_order_relaxed) ? 1 : 0) << '\n';
+
+    writeHeader(out, "trdp_rx_callback_duration_ns", "histogram", "Time spent in the PD receive callback.");
+    writeHistogram(out, "trdp_rx_callback_duration_ns", {}, engineMetrics.rx_callback_ns.snapshot());
+
+    writeHeader(out, "trdp_snapshot_bytes", "histogram", "Approximate size of PD snapshots handed to callers.");
+    writeHistogram(out, "trdp_snapshot_bytes", {}, engineMetrics.snapshot_bytes.snapshot());
+
+    const auto telegrams = engine.telegramMetrics();
+    if (!telegrams) {
+        return;
+    }
+
+    writeHeader(out, "trdp_pd_rx_total", "counter", "PD telegrams received.");
+    for (const auto &telegram : *telegrams) {
+        out << "trdp_pd_rx_total{" << telegramLabels(*telegram) << "} " << telegram->rx.value() << '\n';
+    }
+
+    writeHeader(out, "trdp_pd_tx_total", "counter", "PD telegrams sent.");
+    for (const auto &telegram : *telegrams) {
+        out << "trdp_pd_tx_total{" << telegramLabels(*telegram) << "} " << telegram->tx.value() << '\n';
+    }
+
+    writeHeader(out, "trdp_pd_timeouts_total", "counter", "PD receive timeouts reported by the TRDP stack.");
+    for (const auto &telegram : *telegrams) {
+        out << "trdp_pd_timeouts_total{" << telegramLabels(*telegram) << "} " << telegram->timeouts.value() << '\n';
+    }
+
+    writeHeader(out, "trdp_pd_rx_period_us", "histogram", "Interval between consecutive PD receptions.");
+    for (const auto &telegram : *telegrams) {
+        writeHistogram(out, "trdp_pd_rx_period_us", telegramLabels(*telegram), telegram->rx_period_us.snapshot());
+    }
+
+    writeHeader(out, "trdp_pd_tx_lateness_us", "histogram", "Delay of each PD send behind its ideal due time.");
+    for (const auto &telegram : *telegrams) {
+        writeHistogram(out, "trdp_pd_tx_lateness_us", telegramLabels(*telegram), telegram->tx_lateness_us.snapshot());
+    }
+
+    writeHeader(out, "trdp_pd_tx_missed_cycles_total", "counter", "PD cycles skipped because the send was more than a cycle late.");
+    for (const auto &telegram : *telegrams) {
+        out << "trdp_pd_tx_missed_cycles_total{" << telegramLabels(*telegram) << "} " << telegram->tx_missed_cycles.value()
+            << '\n';
+    }
+
+    writeHeader(out, "trdp_pd_tx_errors_total", "counter", "PD sends the TRDP stack did not accept.");
+    for (const auto &telegram : *telegrams) {
+        out << "trdp_pd_tx_errors_total{" << telegramLabels(*telegram) << "} " << telegram->tx_errors.value() << '\n';
+    }
+
+    writeHeader(out, "trdp_pd_rx_lost_total", "counter", "PD sequence counters missing when a gap was detected.");
+    for (const auto &telegram : *telegrams) {
+        out << "trdp_pd_rx_lost_total{" << telegramLabels(*telegram) << "} " << telegram->rx_lost.value() << '\n';
+    }
+
+    writeHeader(out, "trdp_pd_rx_duplicates_total", "counter", "PD receptions repeating an already received sequence counter.");
+    for (const auto &telegram : *telegrams) {
+        out << "trdp_pd_rx_duplicates_total{" << telegramLabels(*telegram) << "} " << telegram->rx_duplicates.value()
+            << '\n';
+    }
+
+    writeHeader(out, "trdp_pd_rx_reordered_total", "counter", "PD receptions arriving after a newer sequence counter.");
+    for (const auto &telegram : *telegrams) {
+        out << "trdp_pd_rx_reordered_total{" << telegramLabels(*telegram) << "} " << telegram->rx_reordered.value()
+            << '\n';
+    }
+
+    writeHeader(out, "trdp_pd_rx_loss_burst", "histogram", "Consecutive PD sequence counters missing per gap.");
+    for (const auto &telegram : *telegrams) {
+        writeHistogram(out, "trdp_pd_rx_loss_burst", telegramLabels(*telegram), telegram->rx_loss_burst.snapshot());
+    }
+
+    writeHeader(out, "trdp_pd_switchovers_total", "counter", "Changes of the active source of a PD telegram.");
+    for (const auto &telegram : *telegrams) {
+        out << "trdp_pd_switchovers_total{" << telegramLabels(*telegram) << "} " << telegram->switchovers.value()
+            << '\n';
+    }
+
+    writeHeader(out, "trdp_pd_switchover_gap_us", "histogram",
+                "Silence between the last packet of the previous source and the first of the new active source.");
+    for (const auto &telegram : *telegrams) {
+        writeHistogram(out, "trdp_pd_switchover_gap_us", telegramLabels(*telegram),
+                       telegram->switchover_gap_us.snapshot());
+    }
+}
+
+void writeHttpMetrics(std::ostringstream &out) {
+    std::vector<std::pair<std::pair<std::string, std::string>, const RouteMetrics *>> routes;
+    {
+        auto &registry = routeRegistry();
+        std::lock_guard<std::mutex> lock(registry.mtx);
+        routes.reserve(registry.routes.size());
+        for (const auto &entry : registry.routes) {
+            routes.emplace_back(entry.first, entry.second.get());
+        }
+    }
+
+    writeHeader(out, "trdp_http_request_duration_seconds", "histogram", "HTTP request latency per route.");
+    for (const auto &route : routes) {
+        const std::string labels = "method=\"" + escapeLabel(route.first.first) + "\",route=\"" +
+                                   escapeLabel(route.first.second) + '"';
+        writeHistogram(out, "trdp_http_request_duration_seconds", labels, route.second->latency_seconds.snapshot());
+    }
+}
+
+}  // namespace
+
+void recordHttpLatency(const std::string &method, const std::string &path, double seconds) {
+    routeMetrics(method, normalizeRoute(path)).latency_seconds.observe(seconds);
+}
+
+std::string renderPrometheusMetrics(const TrdpEngine *engine) {
+    std::ostringstream out;
+    if (engine != nullptr) {
+        writeEngineMetrics(out, *engine);
+    }
+    writeHttpMetrics(out);
+    return out.str();
+}
+
+}  // namespace trdp
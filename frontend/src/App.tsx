@@ -136,7 +136,25 @@ function App() {
         throw new Error(message || `Config load failed (${resp.status})`);
       }
 
-      const result = await resp.json();
+      const result: { job_id: number; path: string } = await resp.json();
+      setStatus(`Loading configuration from ${result.path}...`);
+
+      // The backend loads in the background; poll the job until it settles.
+      for (;;) {
+        await new Promise((resolve) => setTimeout(resolve, 250));
+        const jobResp = await fetch(`${apiBase}/api/configs/jobs/${result.job_id}`);
+        if (!jobResp.ok) {
+          throw new Error(`Config job status failed (${jobResp.status})`);
+        }
+        const job: { state: string; phase: string; error?: string; rolled_back?: boolean } = await jobResp.json();
+        if (job.state === 'succeeded') {
+          break;
+        }
+        if (job.state === 'failed') {
+          const suffix = job.rolled_back ? ' The previous configuration is still active.' : '';
+          throw new Error(`Config load failed during ${job.phase}: ${job.error ?? 'unknown error'}.${suffix}`);
+        }
+      }
       setStatus(`Configuration loaded from ${result.path}. Refresh telegrams to see updates.`);
     } catch (err) {
       setError(friendlyFetchError('load configuration', err));
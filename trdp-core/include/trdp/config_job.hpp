@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace trdp {
+
+// Steps of a configuration load in execution order. Parse and Validate work
+// on a staging copy while the previous configuration keeps running; only
+// Stop, Open and Activate touch the live engine.
+enum class ConfigLoadPhase : uint8_t { Parse, Validate, Stop, Open, Activate };
+constexpr size_t kConfigLoadPhaseCount = 5u;
+
+const char *configLoadPhaseName(ConfigLoadPhase phase);
+
+enum class ConfigJobState : uint8_t { Queued, Running, Succeeded, Failed };
+
+const char *configJobStateName(ConfigJobState state);
+
+// Handed to TrdpEngine::loadConfig() by a job. on_phase is called when a
+// phase begins; rolled_back is set when the engine had to fall back to the
+// previous configuration after the live engine was already touched.
+struct ConfigLoadProgress {
+    std::function<void(ConfigLoadPhase)> on_phase;
+    bool rolled_back {false};
+};
+
+struct ConfigPhaseStatus {
+    bool started;
+    bool finished;
+    double duration_ms;
+};
+
+struct ConfigJobStatus {
+    uint64_t id;
+    std::string path;
+    std::vector<std::string> host_names;
+    ConfigJobState state;
+    // Phase that is running, or the one that failed.
+    ConfigLoadPhase phase;
+    std::array<ConfigPhaseStatus, kConfigLoadPhaseCount> phases;
+    double total_ms;
+    bool rolled_back;
+    std::string error;
+};
+
+// Runs configuration loads one at a time on a worker thread. Finished jobs
+// stay queryable until kConfigJobHistory newer ones have been submitted.
+class ConfigJobQueue {
+public:
+    // Performs the load; failures are reported by throwing.
+    using Runner = std::function<void(const std::string &path, const std::vector<std::string> &host_names,
+                                      ConfigLoadProgress &progress)>;
+
+    static constexpr size_t kConfigJobHistory = 32u;
+
+    explicit ConfigJobQueue(Runner runner);
+    ~ConfigJobQueue();
+
+    ConfigJobQueue(const ConfigJobQueue &) = delete;
+    ConfigJobQueue &operator=(const ConfigJobQueue &) = delete;
+
+    uint64_t submit(const std::string &path, const std::vector<std::string> &host_names);
+    std::optional<ConfigJobStatus> status(uint64_t id) const;
+    // Newest first.
+    std::vector<ConfigJobStatus> list() const;
+    // Waits for the running job; queued ones are dropped.
+    void stop();
+
+private:
+    void run();
+    void enterPhase(uint64_t id, ConfigLoadPhase phase);
+    ConfigJobStatus *findLocked(uint64_t id);
+
+    Runner runner_;
+    std::deque<ConfigJobStatus> jobs_;
+    std::deque<uint64_t> pending_;
+    uint64_t next_id_ {1u};
+    std::chrono::steady_clock::time_point phase_start_;
+    std::chrono::steady_clock::time_point job_start_;
+
+    std::thread thread_;
+    mutable std::mutex mtx_;
+    std::condition_variable wake_;
+    bool stop_requested_ {false};
+};
+
+}  // namespace trdp
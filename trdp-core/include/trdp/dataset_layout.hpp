@@ -0,0 +1,44 @@
+#pragma once
+
+#include "trdp_config.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trdp {
+
+// Byte position of a single dataset element inside a PD payload.
+struct FieldLayout {
+    std::string name;
+    uint32_t type;
+    uint32_t array_size;
+    uint32_t offset;
+    uint32_t element_size;
+};
+
+// Precomputed wire layout of a dataset. Elements are laid out back to back in
+// big-endian order; the layout stops at the first element whose type is not
+// supported, in which case `complete` is false and `size` covers only the
+// fields that could be placed.
+struct DatasetLayout {
+    uint32_t dataset_id;
+    uint32_t size;
+    bool complete;
+    std::vector<FieldLayout> fields;
+
+    const FieldLayout *findField(const std::string &name) const;
+};
+
+DatasetLayout buildDatasetLayout(const Dataset &dataset);
+
+// Size in bytes of one element of the given TRDP type, or 0 if unsupported.
+uint32_t elementSize(uint32_t type);
+
+// Writes `value` converted to `type` at `dst` (elementSize(type) bytes).
+void encodeElement(uint8_t *dst, uint32_t type, double value);
+
+// Reads one element of `type` from `src` (elementSize(type) bytes).
+int64_t decodeElement(const uint8_t *src, uint32_t type);
+
+}  // namespace trdp
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace trdp {
+
+// Time source for scheduling, timestamps and timeouts in the engine.
+// Latency metrics and traces keep measuring real time.
+class EngineClock {
+public:
+    virtual ~EngineClock() = default;
+    virtual std::chrono::steady_clock::time_point now() const = 0;
+};
+
+class SteadyEngineClock final : public EngineClock {
+public:
+    std::chrono::steady_clock::time_point now() const override { return std::chrono::steady_clock::now(); }
+};
+
+// Clock that only moves when told to. Starts at `start`; the default is an
+// arbitrary non-zero point so zero time points still mean "never".
+class VirtualClock final : public EngineClock {
+public:
+    explicit VirtualClock(std::chrono::steady_clock::time_point start =
+                              std::chrono::steady_clock::time_point(std::chrono::hours(1)))
+        : ns_(start.time_since_epoch().count()) {}
+
+    std::chrono::steady_clock::time_point now() const override {
+        return std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(ns_.load(std::memory_order_acquire)));
+    }
+    void set(std::chrono::steady_clock::time_point time) {
+        ns_.store(time.time_since_epoch().count(), std::memory_order_release);
+    }
+    void advance(std::chrono::steady_clock::duration by) {
+        ns_.fetch_add(by.count(), std::memory_order_acq_rel);
+    }
+
+private:
+    std::atomic<std::chrono::steady_clock::rep> ns_;
+};
+
+}  // namespace trdp
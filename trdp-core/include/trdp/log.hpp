@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+
+namespace trdp {
+
+// Process-wide structured logging. An event is a literal name plus up to
+// kLogMaxFields key/value fields, copied as a fixed-size record into a
+// lock-free queue; a writer thread formats the records as JSON lines and
+// does all I/O, so emitting from the PD threads costs a few stores and
+// never blocks. When the queue is full the event is dropped and counted.
+//
+// Each module has its own level. Events are also rate limited per event
+// name: past LogOptions::rate_limit per second the rest of the second is
+// suppressed, and the next event that gets through carries the number
+// suppressed in a "suppressed" field.
+
+enum class LogLevel : uint8_t {
+    Trace,
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+enum class LogModule : uint8_t {
+    Engine,
+    Config,
+    PdRx,
+    PdTx,
+    Scheduler,
+    Md,
+    Count
+};
+
+constexpr size_t kLogModuleCount = static_cast<size_t>(LogModule::Count);
+constexpr size_t kLogMaxFields = 4u;
+constexpr size_t kLogTextSize = 56u;
+
+enum class LogValueKind : uint8_t {
+    None,
+    Int,
+    Uint,
+    Double,
+    Text
+};
+
+// One key/value pair. Keys must be string literals (only the pointer is
+// kept); text values are copied and cut at kLogTextSize - 1 bytes.
+struct LogField {
+    const char *key;
+    LogValueKind kind;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+    };
+    char text[kLogTextSize];
+
+    LogField() : key(nullptr), kind(LogValueKind::None), u(0u), text {} {}
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type = 0>
+    LogField(const char *name, T value) : key(name), kind(LogValueKind::Int), i(value), text {} {}
+
+    template <typename T,
+              typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, int>::type = 0>
+    LogField(const char *name, T value) : key(name), kind(LogValueKind::Uint), u(value), text {} {}
+
+    LogField(const char *name, double value) : key(name), kind(LogValueKind::Double), d(value), text {} {}
+    LogField(const char *name, const char *value) : key(name), kind(LogValueKind::Text), u(0u), text {} { setText(value); }
+    LogField(const char *name, const std::string &value) : LogField(name, value.c_str()) {}
+
+private:
+    void setText(const char *value);
+};
+
+struct LogOptions {
+    // JSON lines are appended to this file; empty writes to stderr.
+    std::string path;
+    // Queue capacity in events, rounded up to a power of two. Only the
+    // first start of a process allocates the queue.
+    size_t queue_size {8192u};
+    // Events per second and event name; 0 disables the limit.
+    uint32_t rate_limit {100u};
+};
+
+struct LogStatus {
+    bool active;
+    std::string path;
+    uint64_t written;
+    uint64_t dropped;
+    uint64_t suppressed;
+};
+
+namespace detail {
+extern std::atomic<bool> g_log_active;
+extern std::atomic<uint8_t> g_log_levels[kLogModuleCount];
+void logEmit(LogModule module, LogLevel level, const char *event, std::initializer_list<LogField> fields);
+}  // namespace detail
+
+inline bool logEnabled(LogModule module, LogLevel level) {
+    return detail::g_log_active.load(std::memory_order_relaxed) &&
+           static_cast<uint8_t>(level) >=
+               detail::g_log_levels[static_cast<size_t>(module)].load(std::memory_order_relaxed);
+}
+
+// `event` must be a string literal, e.g.
+//   logEvent(LogModule::PdRx, LogLevel::Warn, "pd.timeout", {{"com_id", comId}});
+inline void logEvent(LogModule module, LogLevel level, const char *event, std::initializer_list<LogField> fields = {}) {
+    if (logEnabled(module, level)) {
+        detail::logEmit(module, level, event, fields);
+    }
+}
+
+// Starts the writer thread; a running logger is stopped first.
+void logStart(const LogOptions &options);
+// Writes what is still queued and stops the writer.
+void logStop();
+LogStatus logStatus();
+
+void logSetLevel(LogModule module, LogLevel level);
+LogLevel logLevel(LogModule module);
+// "info" sets every module, "warn,pd.rx=debug,config=info" sets a default
+// and then single modules. Throws std::runtime_error for unknown names.
+void logSetLevels(const std::string &spec);
+
+LogLevel parseLogLevel(const std::string &text);
+LogModule parseLogModule(const std::string &text);
+const char *logLevelToString(LogLevel level);
+const char *logModuleToString(LogModule module);
+
+}  // namespace trdp
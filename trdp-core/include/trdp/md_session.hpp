@@ -0,0 +1,126 @@
+#pragma once
+
+#include "trdp/metrics.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trdp {
+
+enum class MdState {
+    Pending,
+    Replied,
+    Timeout,
+    Error
+};
+
+struct MdRequestOptions {
+    uint32_t com_id;
+    std::string interface_name;
+    std::string host_name;
+    std::string dest_ip;
+    std::vector<uint8_t> payload;
+    uint32_t timeout_us;
+    uint32_t expected_replies;
+    uint32_t count;
+};
+
+struct MdResponderOptions {
+    uint32_t com_id;
+    std::string interface_name;
+    std::string host_name;
+    uint32_t reply_com_id;
+    std::vector<uint8_t> payload;
+    bool request_confirm;
+};
+
+struct MdResult {
+    uint64_t id;
+    uint32_t com_id;
+    MdState state;
+    int32_t result_code;
+    uint32_t replies;
+    uint32_t src_ip;
+    double rtt_us;
+    std::vector<uint8_t> reply_payload;
+};
+
+struct MdComIdStats {
+    MdComIdStats();
+
+    Counter requests;
+    Counter replies;
+    Counter timeouts;
+    Counter errors;
+    Counter notifications_sent;
+    Counter requests_received;
+    Counter notifications_received;
+    Counter confirms_received;
+    Histogram rtt_us;
+};
+
+struct MdStatsSnapshot {
+    uint32_t com_id;
+    uint64_t requests;
+    uint64_t replies;
+    uint64_t timeouts;
+    uint64_t errors;
+    uint64_t notifications_sent;
+    uint64_t requests_received;
+    uint64_t notifications_received;
+    uint64_t confirms_received;
+    HistogramSnapshot rtt_us;
+};
+
+// Bookkeeping for outstanding MD requests. Lookups are keyed by the request
+// id handed to tlm_request as pUserRef, so matching a reply is O(1) no
+// matter how many requests are in flight. The internal mutex is never held
+// across TRDP calls.
+class MdSessionTable {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit MdSessionTable(size_t completed_capacity = 16384u);
+
+    uint64_t add(uint32_t com_id, Clock::time_point sent, Clock::time_point deadline);
+    // Moves a pending request to its final state. Later replies to an
+    // already completed request only bump its reply count.
+    std::optional<MdResult> complete(uint64_t id, MdState state, int32_t result_code, uint32_t src_ip,
+                                     const uint8_t *data, uint32_t size, Clock::time_point now);
+    std::vector<MdResult> expire(Clock::time_point now);
+    void clear();
+
+    std::optional<MdResult> find(uint64_t id) const;
+    size_t pendingCount() const;
+
+    void increment(uint32_t com_id, Counter MdComIdStats::*counter);
+    std::vector<MdStatsSnapshot> statsSnapshot() const;
+
+private:
+    struct Pending {
+        uint32_t com_id;
+        Clock::time_point sent;
+        Clock::time_point deadline;
+    };
+
+    MdComIdStats &stats(uint32_t com_id);
+    void storeCompleted(MdResult result);
+
+    mutable std::mutex mtx_;
+    uint64_t next_id_ {1u};
+    size_t completed_capacity_;
+    std::unordered_map<uint64_t, Pending> pending_;
+    std::unordered_map<uint64_t, MdResult> completed_;
+    std::deque<uint64_t> completed_order_;
+    std::map<uint32_t, std::unique_ptr<MdComIdStats>> stats_;
+};
+
+}  // namespace trdp
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace trdp {
+
+// Monotonic counter. Updates use relaxed atomics so writers never contend
+// with readers; each cell normally has a single writer thread.
+class Counter {
+public:
+    void add(uint64_t n = 1u) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_ {0u};
+};
+
+struct HistogramSnapshot {
+    std::vector<double> bounds;
+    // One entry per bound plus a trailing +Inf bucket; not cumulative.
+    std::vector<uint64_t> counts;
+    uint64_t count;
+    double sum;
+};
+
+// Fixed-bucket histogram with lock-free observation. Bucket bounds are upper
+// bounds (inclusive), matching the Prometheus `le` convention.
+class Histogram {
+public:
+    explicit Histogram(std::vector<double> bounds);
+
+    Histogram(const Histogram &) = delete;
+    Histogram &operator=(const Histogram &) = delete;
+
+    void observe(double value);
+    HistogramSnapshot snapshot() const;
+
+private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+    std::atomic<uint64_t> count_ {0u};
+    std::atomic<double> sum_ {0.0};
+};
+
+// Per-telegram counters. Identity fields are copied at creation so a scrape
+// never needs to look at engine state.
+struct TelegramMetrics {
+    TelegramMetrics(uint32_t com_id, std::string name, std::string interface_name, std::string host_name);
+
+    const uint32_t com_id;
+    const std::string name;
+    const std::string interface_name;
+    const std::string host_name;
+
+    Counter rx;
+    Counter tx;
+    Counter timeouts;
+    Histogram rx_period_us;
+    // Actual send time minus the ideal due time of that send.
+    Histogram tx_lateness_us;
+    // Cycles that passed without a send because the scheduler was late by
+    // more than a full cycle.
+    Counter tx_missed_cycles;
+    // Sends the TRDP stack refused, or that had no publication to go out on.
+    Counter tx_errors;
+    // Sequence counter anomalies over all sources. rx_lost counts the
+    // counters missing when a gap is seen; packets that arrive late to fill
+    // it show up in rx_reordered.
+    Counter rx_lost;
+    Counter rx_duplicates;
+    Counter rx_reordered;
+    // Length of each gap, in consecutive missing counters.
+    Histogram rx_loss_burst;
+    // Changes of the active source and the silence that preceded each.
+    Counter switchovers;
+    Histogram switchover_gap_us;
+};
+
+using TelegramMetricsTable = std::vector<std::unique_ptr<TelegramMetrics>>;
+
+// Engine-wide metrics that survive config reloads.
+struct EngineMetrics {
+    EngineMetrics();
+
+    Histogram scheduler_lateness_us;
+    Histogram rx_callback_ns;
+    Histogram snapshot_bytes;
+    Counter config_loads;
+    // Scheduler iterations whose work took longer than one tick.
+    Counter scheduler_overruns;
+    // Latched on the first overrun after start(); a run that ends with this
+    // still clear kept every tick within budget.
+    std::atomic<bool> scheduler_overrun {false};
+};
+
+}  // namespace trdp
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace trdp {
+
+// On-disk layout of a PD capture ring file. The file is a fixed header page
+// followed by `slot_count` fixed-size slots; record n lives in slot
+// n % slot_count, so the newest records overwrite the oldest ones.
+constexpr uint32_t kCaptureVersion = 2u;
+constexpr uint32_t kCaptureHeaderSize = 4096u;
+constexpr uint32_t kCaptureMaxPayload = 1432u;
+constexpr uint32_t kCaptureMaxInterfaces = 64u;
+
+struct CaptureFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t slot_size;
+    uint32_t slot_count;
+    uint32_t max_payload;
+    uint32_t interface_count;
+    std::atomic<uint64_t> head;
+    uint32_t interface_ips[kCaptureMaxInterfaces];
+    char interface_names[kCaptureMaxInterfaces][32];
+};
+
+// `commit` is 2n+1 while record n is being written and 2n+2 once it is
+// complete, so readers can skip torn or overwritten slots.
+struct CaptureSlotHeader {
+    std::atomic<uint64_t> commit;
+    uint64_t timestamp_ns;
+    uint32_t com_id;
+    uint32_t seq_count;
+    uint32_t src_ip;
+    uint32_t dest_ip;
+    uint16_t msg_type;
+    uint16_t interface_index;
+    uint16_t payload_size;
+    uint16_t captured_size;
+};
+
+struct CaptureInterface {
+    std::string name;
+    uint32_t ip;
+};
+
+struct PdCaptureRecord {
+    uint64_t timestamp_ns;
+    uint32_t com_id;
+    uint32_t seq_count;
+    uint32_t src_ip;
+    uint32_t dest_ip;
+    uint16_t msg_type;
+    uint16_t interface_index;
+    const uint8_t *payload;
+    uint32_t payload_size;
+};
+
+struct PdCaptureStatus {
+    bool active;
+    std::string path;
+    uint32_t slot_count;
+    uint64_t records;
+    uint64_t truncated;
+};
+
+// Appends received PDs to a preallocated, memory-mapped ring file. append()
+// is wait-free and allocation free: it claims a slot with one atomic
+// increment and copies into the mapping, so it is safe to call from the TRDP
+// receive callback on any number of threads.
+class PdRecorder {
+public:
+    PdRecorder() = default;
+    ~PdRecorder();
+
+    PdRecorder(const PdRecorder &) = delete;
+    PdRecorder &operator=(const PdRecorder &) = delete;
+
+    void start(const std::string &path, uint32_t slot_count, const std::vector<CaptureInterface> &interfaces);
+    void stop();
+    void append(const PdCaptureRecord &record);
+    bool active() const { return active_.load(std::memory_order_relaxed); }
+    PdCaptureStatus status() const;
+
+private:
+    std::atomic<bool> active_ {false};
+    std::atomic<uint32_t> writers_ {0u};
+    std::atomic<uint64_t> truncated_ {0u};
+    uint8_t *base_ {nullptr};
+    size_t mapped_size_ {0u};
+    std::string path_;
+    uint32_t slot_count_ {0u};
+};
+
+// Read-only view of a capture file, iterated from the oldest retained record
+// to the newest.
+class PdCaptureReader {
+public:
+    struct Entry {
+        uint64_t timestamp_ns;
+        uint32_t com_id;
+        uint32_t seq_count;
+        uint32_t src_ip;
+        uint32_t dest_ip;
+        uint16_t msg_type;
+        uint16_t interface_index;
+        uint32_t payload_size;
+        uint32_t captured_size;
+        // Reader-owned copy, only valid for the duration of the visit call.
+        const uint8_t *payload;
+    };
+
+    explicit PdCaptureReader(const std::string &path);
+    ~PdCaptureReader();
+
+    PdCaptureReader(const PdCaptureReader &) = delete;
+    PdCaptureReader &operator=(const PdCaptureReader &) = delete;
+
+    const std::vector<CaptureInterface> &interfaces() const { return interfaces_; }
+    void forEach(const std::function<void(const Entry &)> &visit) const;
+
+private:
+    const uint8_t *base_ {nullptr};
+    size_t mapped_size_ {0u};
+    std::vector<CaptureInterface> interfaces_;
+};
+
+// Writes the capture as pcapng with one raw-IPv4 interface per TRDP
+// interface. Every record becomes a synthetic IPv4/UDP (port 17224) packet
+// carrying a TRDP PD header, so Wireshark's TRDP dissector decodes it.
+void exportPcapng(const PdCaptureReader &reader, std::ostream &out);
+
+}  // namespace trdp
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace trdp {
+
+// One received payload that differed from the previous one of its telegram.
+// `data` is only valid for the duration of the poll() visitor call.
+struct PdChangeEvent {
+    uint64_t seq;
+    int64_t time_ns;
+    uint32_t com_id;
+    uint32_t src_ip;
+    uint32_t size;
+    const uint8_t *data;
+};
+
+struct PdChangePoll {
+    size_t delivered;
+    // Events a consumer fell too far behind for and never saw.
+    uint64_t lost;
+};
+
+// Broadcast ring of PD change events. Producers never wait: publish()
+// claims the next sequence number and overwrites the oldest slot. Every
+// consumer keeps its own cursor and reads with a per-slot sequence check,
+// so consumers neither block producers nor each other; a consumer that
+// falls more than `capacity` events behind skips ahead and is told how
+// many it lost. Storage is allocated once by the constructor.
+class PdChangeQueue {
+public:
+    // `capacity` is rounded up to a power of two; payloads longer than
+    // `payload_size` are truncated.
+    PdChangeQueue(size_t capacity, size_t payload_size);
+
+    PdChangeQueue(const PdChangeQueue &) = delete;
+    PdChangeQueue &operator=(const PdChangeQueue &) = delete;
+
+    void publish(uint32_t com_id, uint32_t src_ip, int64_t time_ns, const uint8_t *data, uint32_t size);
+
+    // Sequence number the next published event will get. A new consumer
+    // starts its cursor here to see only events from now on.
+    uint64_t head() const { return head_.load(std::memory_order_acquire); }
+    size_t capacity() const { return mask_ + 1u; }
+    size_t payloadSize() const { return payload_size_; }
+
+    // Hands up to `max_events` events starting at `cursor` to `visit` and
+    // advances the cursor. `scratch` is consumer-owned copy space; it is
+    // sized on first use.
+    template <typename Visitor>
+    PdChangePoll poll(uint64_t &cursor, std::vector<uint8_t> &scratch, size_t max_events, Visitor &&visit) const {
+        PdChangePoll result {0u, 0u};
+        if (scratch.size() < payload_size_) {
+            scratch.resize(payload_size_);
+        }
+
+        while (result.delivered < max_events) {
+            const uint64_t head = head_.load(std::memory_order_acquire);
+            if (cursor >= head) {
+                break;
+            }
+            if (head - cursor > capacity()) {
+                result.lost += head - capacity() - cursor;
+                cursor = head - capacity();
+            }
+
+            const Slot &slot = slots_[cursor & mask_];
+            const uint64_t expected = cursor * 2u + 2u;
+            const uint64_t before = slot.seq.load(std::memory_order_acquire);
+            if (before < expected) {
+                // Claimed but not yet completely written.
+                break;
+            }
+            if (before > expected) {
+                cursor++;
+                result.lost++;
+                continue;
+            }
+
+            // Fields may be torn by a concurrent overwrite; the size is
+            // clamped and the sequence re-check below discards the copy.
+            const uint32_t size = std::min<uint32_t>(slot.size, static_cast<uint32_t>(payload_size_));
+            PdChangeEvent event {cursor, slot.time_ns, slot.com_id, slot.src_ip, size, scratch.data()};
+            std::memcpy(scratch.data(), payload_.get() + (cursor & mask_) * payload_size_, event.size);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != expected) {
+                cursor++;
+                result.lost++;
+                continue;
+            }
+
+            visit(static_cast<const PdChangeEvent &>(event));
+            cursor++;
+            result.delivered++;
+        }
+
+        return result;
+    }
+
+private:
+    // `seq` is 2 * sequence + 1 while the slot is written and
+    // 2 * sequence + 2 once it is complete.
+    struct Slot {
+        std::atomic<uint64_t> seq {0u};
+        int64_t time_ns {0};
+        uint32_t com_id {0u};
+        uint32_t src_ip {0u};
+        uint32_t size {0u};
+    };
+
+    size_t mask_;
+    size_t payload_size_;
+    std::unique_ptr<Slot[]> slots_;
+    std::unique_ptr<uint8_t[]> payload_;
+    std::atomic<uint64_t> head_ {0u};
+};
+
+}  // namespace trdp
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "trdp/dataset_layout.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trdp {
+
+enum class GeneratorKind {
+    Ramp,
+    Sine,
+    Square,
+    Counter,
+    RandomWalk,
+    Table
+};
+
+// Drives one field of a sent telegram. Ramp, sine and square are functions
+// of the time since the generator was added and run between `min` and
+// `max` with `period_us`; counter, random walk and table advance once per
+// send:
+//   ramp        min -> max over one period, then wraps
+//   sine        centred between min and max, shifted by phase_deg
+//   square      max for `duty` of the period, min for the rest
+//   counter     min, min + step, ... wrapping to min past max
+//   random walk starts halfway, moves by up to +/-step, clamped to min..max
+//   table       the listed values in turn, repeating
+struct PdGeneratorSpec {
+    uint32_t com_id;
+    std::string host_name;
+    std::string field;
+    GeneratorKind kind;
+    double min;
+    double max;
+    uint64_t period_us;
+    double duty;
+    double phase_deg;
+    double step;
+    std::vector<double> table;
+    uint64_t seed;
+};
+
+struct PdGeneratorStatus {
+    uint64_t id;
+    PdGeneratorSpec spec;
+    uint64_t evaluations;
+    double last_value;
+};
+
+GeneratorKind parseGeneratorKind(const std::string &text);
+const char *generatorKindToString(GeneratorKind kind);
+
+// Generators compiled to field offsets, grouped by the engine's TX slot so
+// the scheduler only looks at the ones of the telegram it is sending. Not
+// synchronised: the engine calls every member with its state lock held.
+class PdGeneratorTable {
+public:
+    // Drops all generators and makes room for `slot_count` TX slots.
+    void reset(size_t slot_count);
+    // Throws std::runtime_error for an unknown field or invalid parameters.
+    uint64_t add(const PdGeneratorSpec &spec, const DatasetLayout &layout, uint32_t tx_slot,
+                 std::chrono::steady_clock::time_point start);
+    bool remove(uint64_t id);
+    bool hasGenerators(uint32_t tx_slot) const { return tx_slot < slots_.size() && !slots_[tx_slot].empty(); }
+    std::vector<PdGeneratorStatus> status() const;
+
+    // Evaluates the slot's generators for a send due at `when` and encodes
+    // the results into `payload`, which must cover the full layout.
+    void apply(uint32_t tx_slot, uint8_t *payload, std::chrono::steady_clock::time_point when);
+
+private:
+    struct Generator {
+        uint64_t id;
+        PdGeneratorSpec spec;
+        FieldLayout field;
+        std::chrono::steady_clock::time_point start;
+        double current;
+        size_t table_index;
+        uint64_t rng;
+        uint64_t evaluations;
+        double last_value;
+    };
+
+    static double evaluate(Generator &generator, std::chrono::steady_clock::time_point when);
+
+    std::vector<std::vector<Generator>> slots_;
+    uint64_t next_id_ {1u};
+};
+
+}  // namespace trdp
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trdp {
+
+struct SeriesPoint {
+    int64_t t_us;
+    double value;
+};
+
+// Samples kept per receiving telegram unless set otherwise. Every such
+// telegram preallocates depth x dataset size bytes on each config load.
+constexpr size_t kDefaultHistoryDepth = 128u;
+
+enum class DownsampleMode {
+    MinMax,
+    Lttb
+};
+
+// Bounded ring of recent payload samples for one telegram. Storage is
+// allocated by reset(), so push() on the receive path never allocates.
+// Samples are kept raw and decoded per field at query time.
+class PdHistory {
+public:
+    void reset(size_t capacity, size_t payload_size);
+    void push(std::chrono::steady_clock::time_point time, const uint8_t *data, size_t size);
+
+    size_t size() const { return count_; }
+
+    // Visits samples from oldest to newest; `valid` is the number of bytes
+    // that were actually received for that sample.
+    template <typename Visitor>
+    void forEach(Visitor &&visit) const {
+        const size_t first = (head_ + capacity_ - count_) % (capacity_ == 0u ? 1u : capacity_);
+        for (size_t n = 0u; n < count_; ++n) {
+            const size_t slot = (first + n) % capacity_;
+            visit(times_us_[slot], data_.data() + slot * payload_size_, sizes_[slot]);
+        }
+    }
+
+private:
+    size_t capacity_ {0u};
+    size_t payload_size_ {0u};
+    size_t head_ {0u};
+    size_t count_ {0u};
+    std::vector<int64_t> times_us_;
+    std::vector<uint32_t> sizes_;
+    std::vector<uint8_t> data_;
+};
+
+// Reduces `points` to at most `max_points`, keeping the extremes of each
+// bucket (MinMax) or the visually most significant point (LTTB).
+std::vector<SeriesPoint> downsample(const std::vector<SeriesPoint> &points, size_t max_points, DownsampleMode mode);
+
+}  // namespace trdp
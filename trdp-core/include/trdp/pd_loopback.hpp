@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trdp {
+
+struct PdState;
+
+// Queued sends of the in-memory loopback that stands in for the PD sockets
+// in loopback mode. Packets sent while the engine state is locked are held
+// here and delivered by the scheduler once the lock is released, so a
+// telegram sent in one scheduler step is received within the same step.
+// Payloads share one byte buffer; swapping batches reuses both buffers.
+class PdLoopback {
+public:
+    struct Packet {
+        const PdState *sender;
+        uint32_t com_id;
+        uint32_t seq_count;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct Batch {
+        std::vector<Packet> packets;
+        std::vector<uint8_t> bytes;
+
+        const uint8_t *payload(const Packet &packet) const { return bytes.data() + packet.offset; }
+    };
+
+    void send(const PdState &sender, uint32_t com_id, uint32_t seq_count, const uint8_t *data, uint32_t size);
+    // Hands the queued packets over in send order and leaves the queue empty.
+    void drain(Batch &batch);
+    // Drops what is queued; a config load does this, as senders point into
+    // the telegram states it replaces.
+    void clear();
+    bool empty() const { return queued_.packets.empty(); }
+
+private:
+    Batch queued_;
+};
+
+}  // namespace trdp
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "trdp/metrics.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <trdp_if_light.h>
+
+namespace trdp {
+
+struct PdPullOptions {
+    uint32_t com_id;
+    std::string interface_name;
+    std::string host_name;
+    std::string dest_ip;
+    uint32_t reply_com_id;
+    uint32_t interval_us;
+    uint32_t timeout_us;
+    uint32_t count;
+};
+
+struct PdPullStatus {
+    uint64_t id;
+    PdPullOptions options;
+    bool active;
+    uint64_t sent;
+    uint64_t replies;
+    uint64_t timeouts;
+    uint64_t errors;
+    size_t outstanding;
+};
+
+struct PdPullStatsSnapshot {
+    uint32_t com_id;
+    uint64_t requests;
+    uint64_t replies;
+    uint64_t timeouts;
+    HistogramSnapshot rtt_us;
+};
+
+// One pull request that is due; the caller issues tlp_request for it
+// without holding the table lock.
+struct PdPullSend {
+    uint64_t id;
+    uint32_t com_id;
+    uint32_t reply_com_id;
+    TRDP_IP_ADDR_T dest_ip;
+    TRDP_APP_SESSION_T appHandle;
+    TRDP_SUB_T subHandle;
+};
+
+// Periodic PD pull jobs. Each job runs on an absolute timeline (start +
+// n * interval) so scheduling jitter does not accumulate. PD replies carry
+// no session id, so a reply is matched to the oldest outstanding request
+// of the job with the same reply comId and destination address.
+class PdPullTable {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t add(const PdPullOptions &options, TRDP_IP_ADDR_T dest_ip, TRDP_APP_SESSION_T appHandle,
+                 TRDP_SUB_T subHandle, Clock::time_point start);
+    bool remove(uint64_t id);
+    void clear();
+
+    // Returns the requests due at `now`, marks them as sent and expires
+    // outstanding requests whose timeout has passed.
+    std::vector<PdPullSend> collectDue(Clock::time_point now);
+    void markFailed(uint64_t id);
+    // Returns true when the reply answered an outstanding request.
+    bool matchReply(TRDP_APP_SESSION_T appHandle, uint32_t com_id, TRDP_IP_ADDR_T src_ip, Clock::time_point now);
+
+    std::vector<PdPullStatus> status() const;
+    std::vector<PdPullStatsSnapshot> statsSnapshot() const;
+
+private:
+    struct Stats {
+        Stats();
+
+        Counter requests;
+        Counter replies;
+        Counter timeouts;
+        Histogram rtt_us;
+    };
+
+    struct Job {
+        uint64_t id;
+        PdPullOptions options;
+        TRDP_IP_ADDR_T dest_ip;
+        TRDP_APP_SESSION_T appHandle;
+        TRDP_SUB_T subHandle;
+        Clock::time_point next_due;
+        uint32_t remaining;
+        bool active;
+        uint64_t sent;
+        uint64_t replies;
+        uint64_t timeouts;
+        uint64_t errors;
+        std::deque<Clock::time_point> outstanding;
+        Stats *stats;
+    };
+
+    Stats &stats(uint32_t com_id);
+    void expire(Job &job, Clock::time_point now);
+
+    mutable std::mutex mtx_;
+    uint64_t next_id_ {1u};
+    std::vector<Job> jobs_;
+    std::map<uint32_t, std::unique_ptr<Stats>> stats_;
+};
+
+}  // namespace trdp
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace trdp {
+
+struct ReplayOptions {
+    std::string path;
+    double speed {1.0};
+    std::set<uint32_t> com_ids;
+    std::set<std::string> interfaces;
+};
+
+struct ReplayStatus {
+    bool active;
+    std::string path;
+    double speed;
+    uint64_t total;
+    uint64_t sent;
+    uint64_t skipped;
+    double max_lateness_us;
+};
+
+// Sends one recorded payload; returns false if the telegram is not known.
+using ReplaySink = std::function<bool(uint32_t com_id, const std::string &if_name, const uint8_t *data, uint32_t size)>;
+
+// A telegram a replay sends: comId and capture interface name.
+struct ReplayTelegram {
+    uint32_t com_id;
+    std::string if_name;
+};
+
+// `begin` runs in start() once the records are loaded, before the first
+// send; `end` runs on the replay thread after the last send, whether the
+// replay ran out or was stopped.
+struct ReplayHooks {
+    std::function<void(const std::vector<ReplayTelegram> &)> begin;
+    std::function<void()> end;
+};
+
+// Replays a PD capture file on its own thread. Records are loaded up front,
+// then each one is released at start + (t_i - t_0) / speed, so wake-up
+// jitter on one packet does not shift the ones after it.
+class PdReplayer {
+public:
+    PdReplayer() = default;
+    ~PdReplayer();
+
+    PdReplayer(const PdReplayer &) = delete;
+    PdReplayer &operator=(const PdReplayer &) = delete;
+
+    void start(const ReplayOptions &options, ReplaySink sink, ReplayHooks hooks = {});
+    void stop();
+    ReplayStatus status() const;
+
+private:
+    struct Record {
+        uint64_t timestamp_ns;
+        uint32_t com_id;
+        uint32_t interface_index;
+        size_t offset;
+        uint32_t size;
+    };
+
+    void run();
+    void runRecords();
+
+    ReplayOptions options_;
+    ReplaySink sink_;
+    ReplayHooks hooks_;
+    std::vector<std::string> interface_names_;
+    std::vector<Record> records_;
+    std::vector<uint8_t> payloads_;
+
+    std::thread thread_;
+    std::atomic<bool> active_ {false};
+    std::atomic<uint64_t> sent_ {0u};
+    std::atomic<uint64_t> skipped_ {0u};
+    std::atomic<double> max_lateness_us_ {0.0};
+    mutable std::mutex mtx_;
+    std::condition_variable wake_;
+    bool stop_requested_ {false};
+};
+
+}  // namespace trdp
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace trdp {
+
+// Scenario scripts are plain text, one step per line, executed by the
+// engine's scheduler at start + offset:
+//
+//   # comments and blank lines are ignored
+//   0      set     1000 speed=12.5 doorsClosed=1
+//   250us  set     1000@devB speed=0
+//   1.5ms  disable 1000
+//   20ms   enable  1000
+//   1s     load    other.xml devA,devB
+//   2s     end
+//
+// Offsets are microseconds, or carry a us/ms/s suffix, and are relative to
+// the start of the pass. `comId@host` picks the telegram of one emulated
+// host. `end` sets the length of one pass for looping (by default the last
+// step's offset). `load` submits a config load job (under runFor() it
+// loads at once, on the virtual clock); the load stops the scenario, so it
+// is normally the last step.
+//
+// Steps act on what goes on the wire: `set` values leave with the
+// telegram's next send (a pull reply answers with them from then on),
+// `enable` sends at once and restarts the cycle at the step's offset, and
+// `disable` stops the sends.
+enum class ScenarioAction {
+    Set,
+    Enable,
+    Disable,
+    Load
+};
+
+struct ScenarioStep {
+    uint64_t offset_us;
+    ScenarioAction action;
+    uint32_t com_id;
+    std::string host_name;
+    std::vector<std::pair<std::string, double>> values;
+    std::string path;
+    std::vector<std::string> host_names;
+    uint32_t line;
+};
+
+// Steps sorted by offset; steps with the same offset keep file order.
+struct Scenario {
+    std::vector<ScenarioStep> steps;
+    uint64_t length_us;
+};
+
+// Both throw std::runtime_error naming the offending line.
+Scenario parseScenario(std::istream &input);
+Scenario loadScenarioFile(const std::string &path);
+
+struct ScenarioOptions {
+    // Script file, or the script itself in `text` when that is not empty.
+    std::string path;
+    std::string text;
+    // Passes to run; 0 repeats until stopped.
+    uint32_t loops {1u};
+};
+
+struct ScenarioStatus {
+    bool active;
+    std::string path;
+    size_t steps;
+    uint64_t executed;
+    uint32_t loops;
+    uint32_t passes_done;
+    uint64_t elapsed_us;
+    // Time between a step's due point and its execution.
+    double max_lateness_us;
+};
+
+}  // namespace trdp
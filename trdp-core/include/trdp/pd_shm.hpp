@@ -0,0 +1,131 @@
+#pragma once
+
+#include "trdp/pd_state.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trdp {
+
+// Layout of the shared-memory export of the telegram table. The segment is
+// a fixed header page, then `slot_count` records of `slot_size` bytes (one
+// per telegram, in configuration order), then the RX and TX payload areas
+// the records point to. All fields are host byte order; record timestamps
+// are nanoseconds of the engine clock (CLOCK_MONOTONIC unless a virtual
+// clock is set), zero until the first event.
+//
+// Each record is guarded by a seqlock: `seq` is odd while the engine writes
+// it. A reader loads `seq` (acquire), retries while it is odd, copies what
+// it needs, issues an acquire fence and retries if `seq` changed.
+//
+// A config load or shutdown sets `retired` and unlinks the segment; readers
+// that see it should map the name again and compare `generation`.
+constexpr uint32_t kShmVersion = 1u;
+constexpr uint32_t kShmHeaderSize = 4096u;
+constexpr uint32_t kShmSlotSize = 256u;
+
+struct ShmFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t slot_size;
+    uint32_t slot_count;
+    uint64_t segment_size;
+    // Config loads of the engine, so a re-created segment can be told apart.
+    uint64_t generation;
+    std::atomic<uint32_t> retired;
+    uint32_t reserved;
+    // CLOCK_REALTIME nanoseconds at creation.
+    int64_t created_ns;
+};
+
+enum ShmSlotFlags : uint8_t {
+    kShmRxValid = 1u << 0u,
+    kShmTxEnabled = 1u << 1u,
+    kShmTimedOut = 1u << 2u,
+};
+
+struct ShmSlot {
+    std::atomic<uint32_t> seq;
+    uint32_t com_id;
+    uint32_t dataset_id;
+    // Direction as in trdp_config.hpp: 0 source, 1 sink, 2 source and sink.
+    uint8_t direction;
+    uint8_t flags;
+    uint16_t reserved0;
+    char name[48];
+    char interface_name[32];
+    char host_name[32];
+    // Payload areas, as byte offsets from the start of the segment. A zero
+    // capacity means the telegram is not received or not sent.
+    uint64_t rx_offset;
+    uint64_t tx_offset;
+    uint32_t rx_capacity;
+    uint32_t tx_capacity;
+    uint32_t rx_size;
+    uint32_t tx_size;
+    uint32_t last_src_ip;
+    uint32_t last_seq_count;
+    uint64_t rx_count;
+    uint64_t tx_count;
+    uint64_t change_count;
+    uint64_t timeout_count;
+    uint64_t rx_lost;
+    uint64_t rx_duplicates;
+    uint64_t tx_missed_cycles;
+    int64_t last_rx_ns;
+    int64_t last_change_ns;
+    int64_t last_tx_ns;
+    uint64_t reserved1;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "seqlock counter must be lock free to be shared");
+static_assert(sizeof(ShmSlot) == kShmSlotSize, "ShmSlot layout is part of the export format");
+
+struct PdShmStatus {
+    bool active;
+    std::string name;
+    uint32_t slot_count;
+    size_t size;
+    uint64_t generation;
+    std::string error;
+};
+
+// Writer side of the export. Slots are indexed like the engine's PdState
+// table; writes come from the RX and TX paths under the engine state lock,
+// so there is a single writer per slot.
+class PdShmExport {
+public:
+    PdShmExport() = default;
+    ~PdShmExport();
+
+    PdShmExport(const PdShmExport &) = delete;
+    PdShmExport &operator=(const PdShmExport &) = delete;
+
+    // Creates the segment `name` ("/" is prepended if missing) with one slot
+    // per state, replacing a previous segment of this export or a stale one
+    // left by a crashed process.
+    void open(const std::string &name, const std::vector<PdState> &states, uint64_t generation);
+    void close();
+    bool active() const { return base_ != nullptr; }
+    PdShmStatus status() const;
+
+    // `timed_out` sets kShmTimedOut until the next reception.
+    void writeRx(uint32_t index, const PdState &state, bool timed_out = false);
+    void writeTx(uint32_t index, const PdState &state, const PdTxSlot &tx, std::chrono::steady_clock::time_point when);
+
+private:
+    ShmSlot *slot(uint32_t index) const;
+
+    uint8_t *base_ {nullptr};
+    size_t mapped_size_ {0u};
+    std::string name_;
+    uint32_t slot_count_ {0u};
+    uint64_t generation_ {0u};
+};
+
+}  // namespace trdp
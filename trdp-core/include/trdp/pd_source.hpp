@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trdp {
+
+// Sources tracked per telegram. A telegram normally has one publisher, or
+// two on redundant lines; further sources replace the one heard from least
+// recently.
+constexpr size_t kPdMaxSources = 4u;
+
+enum class SeqOutcome : uint8_t { First, InOrder, Gap, Duplicate, Reordered, Reset };
+
+// Sequence counter state of one PD publisher. The last kWindow counters are
+// kept in a bitmap, so classifying a packet is O(1) and a late packet can be
+// told apart from a duplicate. A late packet that fills a gap takes back the
+// loss counted for it. A counter that falls behind the window is taken as a
+// publisher restart.
+struct PdSeqTracker {
+    static constexpr uint32_t kWindow = 64u;
+
+    bool valid;
+    uint32_t last_seq;
+    // Bit n set: last_seq - n was received.
+    uint64_t window;
+    uint64_t lost;
+    uint64_t duplicates;
+    uint64_t reordered;
+    uint64_t resets;
+    uint32_t longest_burst;
+
+    // `burst` receives the number of counters skipped on a Gap.
+    SeqOutcome track(uint32_t seq, uint32_t &burst);
+};
+
+struct PdSource {
+    uint32_t src_ip;
+    // Listed as a source (or redundant partner) of the telegram in the XML.
+    bool configured;
+    uint64_t rx_count;
+    std::chrono::steady_clock::time_point last_rx_time;
+    double last_period_us;
+    double avg_period_us;
+    PdSeqTracker seq;
+};
+
+// The active source of a telegram changed. gap_ns is how long the previous
+// source had been silent when the new one took over: the failover latency
+// seen by this subscriber, including the hold time when the standby was
+// already sending.
+struct PdSwitchover {
+    uint32_t from_ip;
+    uint32_t to_ip;
+    int64_t gap_ns;
+};
+
+struct PdSwitchoverEvent {
+    uint32_t com_id;
+    std::string interface_name;
+    std::string host_name;
+    uint32_t from_ip;
+    uint32_t to_ip;
+    int64_t time_ns;
+    int64_t gap_ns;
+};
+
+// Fixed-size table of the sources seen for one telegram; lookups are a scan
+// of at most kPdMaxSources entries.
+//
+// Exactly one source is active: the first one heard, until it stays silent
+// for longer than the hold time passed to receive() and another source is
+// heard. Every other source is standby, whether it is sending (both lines
+// of a redundant pair) or not (a passive redundancy follower).
+class PdSourceSet {
+public:
+    // Pre-registers a source from the configuration.
+    void expect(uint32_t src_ip);
+    PdSource &lookup(uint32_t src_ip);
+    // Records a reception from `source` (obtained from lookup()); returns
+    // true and fills `switched` when it takes over as active source.
+    bool receive(PdSource &source, std::chrono::steady_clock::time_point now, std::chrono::nanoseconds hold,
+                 PdSwitchover &switched);
+
+    size_t size() const { return count_; }
+    const PdSource *begin() const { return sources_.data(); }
+    const PdSource *end() const { return sources_.data() + count_; }
+    const PdSource *active() const { return active_ < 0 ? nullptr : &sources_[static_cast<size_t>(active_)]; }
+    // Sources that had to give up their slot to a newer one.
+    uint64_t evicted() const { return evicted_; }
+
+private:
+    std::array<PdSource, kPdMaxSources> sources_ {};
+    uint8_t count_ {0u};
+    int8_t active_ {-1};
+    uint64_t evicted_ {0u};
+};
+
+}  // namespace trdp
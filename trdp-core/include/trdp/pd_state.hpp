@@ -0,0 +1,105 @@
+#pragma once
+
+#include "trdp_config.hpp"
+#include "trdp/dataset_layout.hpp"
+#include "trdp/metrics.hpp"
+#include "trdp/pd_source.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <trdp_if_light.h>
+
+namespace trdp {
+
+struct InterfaceRuntime;
+
+// Largest process data payload a TRDP telegram can carry.
+constexpr uint32_t kPdMaxPayload = 1432u;
+
+// Single preallocated block holding the TX and last-RX payload of every
+// telegram. reset() is the only allocation; carve() hands out zeroed,
+// 8-byte aligned slices until the block is used up.
+class PayloadArena {
+public:
+    // Bytes carve() consumes for a slice of `size` bytes.
+    static size_t footprint(size_t size);
+
+    void reset(size_t capacity);
+    uint8_t *carve(size_t size);
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    std::unique_ptr<uint8_t[]> storage_;
+    size_t capacity_ {0u};
+    size_t used_ {0u};
+};
+
+// Per-telegram state that is only touched when a telegram is actually sent,
+// received or inspected. Payload pointers point into the engine's arena.
+struct PdState {
+    const PdTelegramDef *def;
+    const DatasetLayout *layout;
+    TelegramMetrics *metrics;
+    // Interface the telegram is sent and subscribed on.
+    InterfaceRuntime *iface;
+    TRDP_SUB_T sub_handle;
+    // Publication of a sent telegram; null on loopback interfaces and for
+    // telegrams whose destination could not be resolved.
+    TRDP_PUB_T pub_handle;
+    uint8_t *tx_payload;
+    uint32_t tx_size;
+    uint32_t tx_capacity;
+    uint8_t *rx_payload;
+    uint32_t rx_size;
+    uint32_t rx_capacity;
+    std::chrono::steady_clock::time_point last_rx_time;
+    bool last_rx_valid;
+    // A timeout was reported and nothing has been received since.
+    bool rx_timed_out;
+    uint32_t last_src_ip;
+    uint32_t last_seq;
+    uint64_t rx_count;
+    // Receptions whose payload differed from the previous one.
+    uint64_t change_count;
+    std::chrono::steady_clock::time_point last_change_time;
+    uint64_t timeout_count;
+    double last_period_us;
+    double avg_period_us;
+    // Index into the engine's TX slots, or kNoTxSlot for sink-only telegrams.
+    uint32_t tx_slot;
+    // Watch rules attached to this telegram.
+    uint32_t watch_count;
+    // Per-publisher reception and sequence counter statistics.
+    PdSourceSet sources;
+};
+
+constexpr uint32_t kNoTxSlot = UINT32_MAX;
+
+// Scheduling fields of one sending telegram. The scheduler walks a packed
+// array of these and only dereferences `state` for telegrams that are due.
+// A zero cycle marks a telegram that is never sent cyclically (pull replies,
+// MD-only entries).
+struct alignas(64) PdTxSlot {
+    std::chrono::steady_clock::time_point next_tx_due;
+    std::chrono::microseconds cycle;
+    PdState *state;
+    TelegramMetrics *metrics;
+    uint64_t tx_count;
+    uint64_t missed_cycles;
+    int64_t last_lateness_ns;
+    bool enabled;
+    // The payload changed since it was last handed to the stack. Only kept
+    // for pull replies, which the stack sends on its own.
+    bool data_changed;
+    // A running replay sends this telegram; the scheduler leaves it alone
+    // until the replay ends.
+    bool replaying;
+};
+
+static_assert(sizeof(PdTxSlot) == 64u, "PdTxSlot must occupy exactly one cache line");
+
+}  // namespace trdp
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "trdp_config.hpp"
+#include "trdp/dataset_layout.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trdp {
+
+// Read-only view of a payload owned by the engine. It points straight into
+// the telegram's RX slot and is only valid while the callback or visitor
+// that received it runs.
+struct PdPayloadView {
+    const uint8_t *data;
+    size_t size;
+
+    const uint8_t *begin() const { return data; }
+    const uint8_t *end() const { return data + size; }
+    bool empty() const { return size == 0u; }
+    uint8_t operator[](size_t idx) const { return data[idx]; }
+};
+
+// One reception as seen by in-process subscribers. `def` and `layout` stay
+// valid until the next config load.
+struct PdRxView {
+    uint32_t com_id;
+    uint32_t src_ip;
+    uint32_t seq_count;
+    std::chrono::steady_clock::time_point time;
+    // Receptions of the telegram so far, including this one.
+    uint64_t rx_count;
+    // The payload differs from the previous reception.
+    bool changed;
+    // Receive timeout reported by the stack; `payload` is the last one
+    // received before it.
+    bool timeout;
+    const PdTelegramDef *def;
+    const DatasetLayout *layout;
+    PdPayloadView payload;
+};
+
+// Called on the TRDP processing thread with the engine state locked; must
+// not block or call back into the engine.
+using PdRxCallback = std::function<void(const PdRxView &)>;
+
+// Polling position on one telegram for TrdpEngine::pollPd(). Only the
+// latest sample is kept per telegram, so a slow reader sees the newest one
+// and the ones it missed are counted in `skipped`.
+struct PdCursor {
+    uint32_t com_id;
+    std::string interface_name;
+    std::string host_name;
+    uint64_t seen;
+    uint64_t skipped;
+};
+
+// Callback registrations by comId; comId 0 receives every telegram.
+// Registrations are independent of the loaded configuration.
+class PdSubscriberTable {
+public:
+    uint64_t add(uint32_t com_id, PdRxCallback callback);
+    bool remove(uint64_t id);
+    bool empty() const { return count_ == 0u; }
+    void dispatch(const PdRxView &view) const;
+
+private:
+    struct Entry {
+        uint64_t id;
+        PdRxCallback callback;
+    };
+
+    std::unordered_map<uint32_t, std::vector<Entry>> by_com_id_;
+    uint64_t next_id_ {1u};
+    size_t count_ {0u};
+};
+
+}  // namespace trdp
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "trdp/dataset_layout.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trdp {
+
+enum class WatchOp {
+    Greater,
+    GreaterEqual,
+    Less,
+    LessEqual,
+    Equal,
+    NotEqual,
+    Changed
+};
+
+// "comId 1001 field speed > 120". `bit` >= 0 narrows the element to that
+// bit before comparing, e.g. {op = Changed, bit = 3} for "bit 3 changed".
+struct PdWatchSpec {
+    uint32_t com_id;
+    std::string interface_name;
+    std::string host_name;
+    std::string field;
+    uint32_t index;
+    WatchOp op;
+    double threshold;
+    int32_t bit;
+    std::string label;
+};
+
+struct PdWatchEvent {
+    uint64_t rule_id;
+    uint32_t com_id;
+    int64_t time_ns;
+    int64_t value;
+    int64_t previous;
+};
+
+struct PdWatchStatus {
+    uint64_t id;
+    PdWatchSpec spec;
+    uint64_t hits;
+    bool condition;
+    bool has_value;
+    int64_t last_value;
+    int64_t last_hit_ns;
+};
+
+WatchOp parseWatchOp(const std::string &text);
+const char *watchOpToString(WatchOp op);
+
+// Rules compiled to byte offsets of one telegram's payload. Threshold rules
+// fire when their condition becomes true; Changed rules fire on every
+// change of the watched value. Not synchronised: the engine calls every
+// member with its state lock held.
+class PdWatchTable {
+public:
+    // `target` identifies the telegram the rule is evaluated for. Throws
+    // std::runtime_error if the field, index or bit does not exist.
+    uint64_t add(const PdWatchSpec &spec, const DatasetLayout &layout, const void *target);
+    // Returns the target of the removed rule, or nullptr if `id` is unknown.
+    const void *remove(uint64_t id);
+    void clear();
+    // Number of rules attached to `target`; lets the receive path skip
+    // unwatched telegrams without scanning.
+    size_t countFor(const void *target) const;
+    size_t size() const { return rules_.size(); }
+    std::vector<PdWatchStatus> status() const;
+
+    // Appends one event per rule of `target` that fires for this payload.
+    void evaluate(const void *target, const uint8_t *data, size_t size, int64_t time_ns, std::vector<PdWatchEvent> &fired);
+
+private:
+    struct Rule {
+        uint64_t id;
+        PdWatchSpec spec;
+        const void *target;
+        uint32_t offset;
+        uint32_t type;
+        uint32_t element_size;
+        uint64_t hits;
+        bool condition;
+        bool has_value;
+        int64_t last_value;
+        int64_t last_hit_ns;
+    };
+
+    std::vector<Rule> rules_;
+    uint64_t next_id_ {1u};
+};
+
+}  // namespace trdp
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace trdp {
+
+// Append-only log of the state an operator sets up by hand: the loaded
+// configuration and, per sent telegram, its payload and TX enable flag.
+//
+// The file starts with the 8 byte magic "WTRDPJNL" and a uint32 version
+// and reserved word, followed by records of
+//   uint32 size, uint32 FNV-1a checksum of the body, body[size]
+// where the body is a type byte and its fields (host byte order, strings
+// as uint16 length + bytes):
+//   1 config   path, uint16 host count, host names
+//   2 payload  uint32 comId, host name, uint16 size, bytes
+//   3 enabled  uint32 comId, host name, uint8 flag
+// A config record starts a new configuration and clears what was
+// recorded for the telegrams of the previous one. Replay stops at the
+// first incomplete or corrupt record, which is where a crash mid-write
+// leaves the tail.
+constexpr uint32_t kJournalVersion = 1u;
+
+struct JournalTelegram {
+    uint32_t com_id;
+    std::string host_name;
+    bool has_payload;
+    std::vector<uint8_t> payload;
+    bool has_enabled;
+    bool enabled;
+};
+
+struct JournalState {
+    std::string xml_path;
+    std::vector<std::string> host_names;
+    std::vector<JournalTelegram> telegrams;
+};
+
+struct StateJournalStatus {
+    bool active;
+    std::string path;
+    size_t telegrams;
+    uint64_t records_written;
+    uint64_t compactions;
+    uint64_t file_size;
+    std::string error;
+};
+
+// Recording only updates an in-memory table and marks the entry dirty; a
+// writer thread appends dirty entries every flush interval and rewrites
+// the file as a compact snapshot once the log has grown well past it.
+// Repeated updates of one telegram between flushes cost one record.
+class StateJournal {
+public:
+    StateJournal() = default;
+    ~StateJournal();
+
+    StateJournal(const StateJournal &) = delete;
+    StateJournal &operator=(const StateJournal &) = delete;
+
+    // Replays `path` (a missing file is an empty journal), compacts it and
+    // starts the writer. Returns the replayed state.
+    JournalState open(const std::string &path);
+    // Flushes pending records and stops the writer.
+    void close();
+    StateJournalStatus status() const;
+
+    // No-ops while the journal is closed.
+    void recordConfig(const std::string &xml_path, const std::vector<std::string> &host_names);
+    void recordPayload(uint32_t com_id, const std::string &host_name, const uint8_t *data, size_t size);
+    void recordEnabled(uint32_t com_id, const std::string &host_name, bool enabled);
+
+private:
+    using Key = std::pair<uint32_t, std::string>;
+
+    struct Entry {
+        bool has_payload;
+        std::vector<uint8_t> payload;
+        bool has_enabled;
+        bool enabled;
+        bool dirty;
+    };
+
+    Entry &touch(const Key &key);
+    void writerLoop();
+    void flush();
+    void compact();
+    bool replayRecord(const uint8_t *body, size_t size);
+    // Both return the number of records appended.
+    size_t appendEntry(std::vector<uint8_t> &out, const Key &key, const Entry &entry) const;
+    size_t appendConfig(std::vector<uint8_t> &out) const;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    bool active_ {false};
+    bool stopping_ {false};
+    std::string path_;
+    std::string xml_path_;
+    std::vector<std::string> host_names_;
+    std::map<Key, Entry> entries_;
+    std::vector<Key> dirty_;
+    bool config_dirty_ {false};
+    std::string error_;
+    uint64_t records_written_ {0u};
+    uint64_t compactions_ {0u};
+
+    uint64_t file_size_ {0u};
+    uint64_t snapshot_size_ {0u};
+    // Appended to by the writer thread only.
+    int fd_ {-1};
+    std::thread writer_;
+};
+
+}  // namespace trdp
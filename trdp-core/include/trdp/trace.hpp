@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trdp {
+
+// Process-wide event tracing. Every thread that emits events gets its own
+// ring of fixed size, so recording needs neither locks nor allocations once
+// the ring exists; the oldest events of a thread are overwritten when its
+// ring is full. Event names and categories must be string literals (only
+// the pointer is stored).
+
+struct TraceStatus {
+    bool active;
+    size_t events_per_thread;
+    size_t threads;
+    uint64_t events;
+    uint64_t overwritten;
+};
+
+namespace detail {
+extern std::atomic<bool> g_trace_enabled;
+void traceEmit(const char *name, const char *category, int64_t start_ns, int64_t duration_ns, int64_t arg, char phase);
+}  // namespace detail
+
+inline bool traceEnabled() { return detail::g_trace_enabled.load(std::memory_order_relaxed); }
+
+inline int64_t traceNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Starts a new capture and discards the previous one.
+void traceStart(size_t events_per_thread);
+// Stops recording and waits until no thread is still writing an event.
+void traceStop();
+TraceStatus traceStatus();
+// Chrome trace event format, loadable in chrome://tracing and Perfetto.
+// Only valid once the capture has been stopped; returns an empty trace
+// while a capture is running.
+std::string traceExportChrome();
+// Label shown for the calling thread in the exported trace.
+void traceSetThreadName(const char *name);
+
+inline void traceInstant(const char *name, const char *category, int64_t arg = 0) {
+    if (traceEnabled()) {
+        detail::traceEmit(name, category, traceNowNs(), 0, arg, 'i');
+    }
+}
+
+// Records the lifetime of the enclosing scope as one complete event.
+class TraceScope {
+public:
+    TraceScope(const char *name, const char *category, int64_t arg = 0)
+        : name_(name), category_(category), arg_(arg), start_ns_(traceEnabled() ? traceNowNs() : 0) {}
+
+    ~TraceScope() {
+        if (start_ns_ != 0 && traceEnabled()) {
+            detail::traceEmit(name_, category_, start_ns_, traceNowNs() - start_ns_, arg_, 'X');
+        }
+    }
+
+    // Attaches a value learned inside the scope, e.g. the comId of a
+    // received telegram.
+    void setArg(int64_t arg) { arg_ = arg; }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name_;
+    const char *category_;
+    int64_t arg_;
+    int64_t start_ns_;
+};
+
+}  // namespace trdp
@@ -10,15 +10,27 @@ namespace trdp {
 class TrdpConfigLoader {
 public:
     void loadFromXml(const std::string &xml_path, const std::string &host_name);
+    // Resolves the telegram roles of several hosts from one parse of the XML.
+    // Datasets are shared; every host gets its own copy of each interface.
+    // An entry may be written as "name@ip" to bind that host's sessions to
+    // another address than the interface host-ip; hosts that would end up
+    // on the same address of an interface are rejected, so with several
+    // hosts all but one need an "@ip". With more than one host, telegrams a
+    // host neither sends nor receives are left out for it.
+    void loadFromXml(const std::string &xml_path, const std::vector<std::string> &host_names);
 
     const std::vector<InterfaceDef> &interfaces() const;
     const std::vector<PdTelegramDef> &pdTelegrams() const;
     const std::vector<Dataset> &datasets() const;
+    const std::vector<std::string> &hostNames() const;
+    const MemoryConfig &memory() const;
 
 private:
     std::vector<InterfaceDef> interfaces_;
     std::vector<PdTelegramDef> pdTelegrams_;
     std::vector<Dataset> datasets_;
+    std::vector<std::string> hostNames_;
+    MemoryConfig memory_ {};
 };
 
 }  // namespace trdp
@@ -24,10 +24,35 @@ enum class Direction {
     SourceSink
 };
 
+// <mem-config> of the device: size of the TRDP memory pool (0 = plain
+// heap) and the number of blocks preallocated per block size.
+struct MemoryConfig {
+    uint32_t size;
+    std::vector<uint32_t> prealloc;
+};
+
 struct InterfaceDef {
     std::string name;
     uint32_t network_id;
     std::string host_ip;
+    std::string host_name;
+    // <trdp-process> of the interface.
+    uint32_t cycle_us;
+    uint32_t priority;
+    uint8_t options;
+    // <pd-com-parameter> defaults for the interface's telegrams.
+    uint8_t pd_qos;
+    uint8_t pd_ttl;
+    uint32_t pd_timeout_us;
+    uint8_t pd_to_behavior;
+    uint16_t pd_port;
+};
+
+// One <source> of a telegram. uri2 names the redundant partner of uri1 and
+// is empty for a non-redundant source.
+struct PdSourceDef {
+    std::string uri1;
+    std::string uri2;
 };
 
 struct PdTelegramDef {
@@ -36,8 +61,21 @@ struct PdTelegramDef {
     uint32_t dataset_id;
     Direction direction;
     uint32_t cycle_us;
+    // PD telegram without a cycle time: only sent when pulled (Pr/Pp).
+    bool pull;
     bool marshall;
     std::string interface_name;
+    std::string host_name;
+    std::vector<PdSourceDef> sources;
+    // <destination> URIs; sent telegrams are published to the first one
+    // that resolves to an address.
+    std::vector<std::string> destinations;
+    // Resolved from the telegram's <com-parameter> and <pd-parameter>,
+    // falling back to the interface defaults.
+    uint8_t qos;
+    uint8_t ttl;
+    uint32_t timeout_us;
+    uint8_t to_behavior;
 };
 
 }  // namespace trdp
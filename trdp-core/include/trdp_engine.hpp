@@ -3,20 +3,59 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "trdp_config.hpp"
+#include "trdp/config_job.hpp"
+#include "trdp/dataset_layout.hpp"
+#include "trdp/md_session.hpp"
+#include "trdp/metrics.hpp"
+#include "trdp/pd_change_queue.hpp"
+#include "trdp/pd_capture.hpp"
+#include "trdp/pd_generator.hpp"
+#include "trdp/pd_history.hpp"
+#include "trdp/pd_pull.hpp"
+#include "trdp/pd_replay.hpp"
+#include "trdp/pd_scenario.hpp"
+#include "trdp/pd_watch.hpp"
+#include "trdp/engine_clock.hpp"
+#include "trdp/pd_loopback.hpp"
+#include "trdp/pd_shm.hpp"
+#include "trdp/pd_state.hpp"
+#include "trdp/pd_subscription.hpp"
+#include "trdp/state_journal.hpp"
 
 #include <trdp_if_light.h>
 
 namespace trdp {
 
+// What the telegram states of one configuration point into. A load
+// replaces it as a whole; holders of a reference keep it alive past that.
+struct PdDefinitions {
+    std::vector<Dataset> datasets;
+    std::vector<PdTelegramDef> pd_defs;
+    std::vector<DatasetLayout> layouts;
+    std::shared_ptr<TelegramMetricsTable> metrics;
+};
+
+// Copy of one telegram's state as returned by getPdSnapshot(). The engine
+// itself keeps the scheduling fields in PdTxSlot and the rest in PdState.
 struct PdRuntime {
+    // Keeps def, layout and metrics valid after a later load.
+    std::shared_ptr<const PdDefinitions> definitions;
     const PdTelegramDef *def;
+    const DatasetLayout *layout;
+    TelegramMetrics *metrics;
     std::vector<uint8_t> tx_payload;
     bool tx_enabled;
     std::chrono::steady_clock::time_point next_tx_due;
@@ -24,16 +63,24 @@ struct PdRuntime {
     std::chrono::steady_clock::time_point last_rx_time;
     bool last_rx_valid;
     uint64_t rx_count;
+    uint64_t change_count;
+    std::chrono::steady_clock::time_point last_change_time;
     uint64_t tx_count;
+    uint64_t tx_missed_cycles;
+    double tx_last_lateness_us;
     uint64_t timeout_count;
     double last_period_us;
     double avg_period_us;
+    PdSourceSet sources;
 };
 
 struct InterfaceRuntime {
     InterfaceDef def;
     TRDP_APP_SESSION_T appHandle;
-    std::vector<PdRuntime *> pd_list;
+    std::vector<PdState *> pd_list;
+    // Socket receive buffer requested for the session's sockets, sized from
+    // the PD traffic expected on the interface.
+    uint32_t rx_buffer_bytes;
 };
 
 struct DecodedField {
@@ -42,32 +89,404 @@ struct DecodedField {
     std::vector<int64_t> values;
 };
 
+struct PdValueUpdate {
+    uint32_t com_id;
+    std::map<std::string, double> values;
+    std::string host_name;
+};
+
+struct PdBatchResult {
+    size_t updated_telegrams;
+    size_t updated_fields;
+    std::vector<uint32_t> unknown_com_ids;
+};
+
+struct HistoryQuery {
+    uint32_t com_id;
+    std::string interface_name;
+    std::string host_name;
+    std::string field;
+    uint32_t index;
+    int64_t from_us;
+    int64_t to_us;
+    size_t max_points;
+    DownsampleMode mode;
+};
+
+struct HistoryResult {
+    std::string error;
+    size_t raw_points;
+    std::vector<SeriesPoint> points;
+};
+
+using MdResultHandler = std::function<void(const MdResult &)>;
+using PdWatchHandler = std::function<void(const PdWatchEvent &)>;
+
 class TrdpEngine {
 public:
     void loadConfig(const std::string &xml_path, const std::string &host_name);
+    // Emulates several devices of the same XML in one engine; each host gets
+    // its own sessions and roles (see TrdpConfigLoader). Wherever a host
+    // name can be passed below, an empty one matches any host.
+    //
+    // The file is parsed and validated into a staging copy while the
+    // current configuration keeps running, and swapped in once the new
+    // sessions are open. If opening them fails, the previous configuration
+    // is reopened (progress->rolled_back); MD sessions, responders, PD
+    // pulls, captures and replays are dropped either way.
+    void loadConfig(const std::string &xml_path, const std::vector<std::string> &host_names,
+                    ConfigLoadProgress *progress = nullptr);
+    // Runs loadConfig() on a background thread and returns the job id.
+    uint64_t submitConfigLoad(const std::string &xml_path, const std::vector<std::string> &host_names);
+    std::optional<ConfigJobStatus> configJob(uint64_t id) const;
+    std::vector<ConfigJobStatus> configJobs() const;
     void start();
     void stop();
     std::vector<PdRuntime> getPdSnapshot() const;
-    void enablePd(uint32_t com_id, bool enable);
-    void setPdValues(uint32_t com_id, const std::map<std::string, double> &values);
+    void enablePd(uint32_t com_id, bool enable, const std::string &host_name = {});
+    void setPdValues(uint32_t com_id, const std::map<std::string, double> &values, const std::string &host_name = {});
+    // Patches the named fields of every listed telegram in place; fields that
+    // are not mentioned keep their current value. The whole batch is applied
+    // under a single lock so the scheduler never sends a half-applied step.
+    PdBatchResult setPdValuesBatch(const std::vector<PdValueUpdate> &updates);
+    // Signal generators on fields of cyclically sent telegrams (see
+    // trdp/pd_generator.hpp). The scheduler evaluates them right before each
+    // send, so every packet on the wire carries a fresh value and they
+    // override values set through setPdValues(). Dropped by loadConfig().
+    uint64_t addGenerator(const PdGeneratorSpec &spec);
+    bool removeGenerator(uint64_t id);
+    std::vector<PdGeneratorStatus> generatorStatus() const;
     std::vector<DecodedField> decodeLastRx(const PdRuntime &pd) const;
+    // Decodes a payload with the dataset of the given comId, e.g. one taken
+    // from pdChanges().
+    std::vector<DecodedField> decodePayload(uint32_t com_id, const uint8_t *data, size_t size) const;
     void onPdReceive(TRDP_APP_SESSION_T, const TRDP_PD_INFO_T *, const uint8_t *, uint32_t);
+    // Runs a PD through the receive path as if the stack had delivered it on
+    // the given interface (empty names pick the first one). For benchmarks
+    // and tests without a network; returns false for an unknown interface.
+    bool injectPd(const TRDP_PD_INFO_T &info, const uint8_t *data, uint32_t size, const std::string &if_name = {},
+                  const std::string &host_name = {});
+
+    // In-process subscribers for tools that embed the engine. Callbacks see
+    // the telegram's RX slot directly (PdRxView), without a copy; comId 0
+    // subscribes to every telegram. Registrations survive config loads.
+    uint64_t subscribePd(uint32_t com_id, PdRxCallback callback);
+    bool unsubscribePd(uint64_t id);
+    // Calls visit(const PdRxView &) with the latest sample of the cursor's
+    // telegram if one arrived since the previous poll, and returns whether
+    // it did. The view is only valid inside `visit`, which runs with the
+    // engine state locked. Throws for an unknown telegram.
+    template <typename Visitor>
+    bool pollPd(PdCursor &cursor, Visitor &&visit) const;
+
+    // Time source for scheduling, timestamps and timeouts; nullptr restores
+    // the steady clock. Only while the scheduler is stopped.
+    void setClock(std::shared_ptr<EngineClock> clock);
+    // Configurations loaded after this open no TRDP sessions: every sent
+    // telegram is delivered in memory to the other telegrams with its comId,
+    // and receive timeouts are detected by the engine. MD and PD pulls are
+    // not available on such interfaces.
+    void setLoopback(bool enable);
+    // Advances a VirtualClock by `duration` in loopback mode, running every
+    // send, delivery and timeout that falls into it on the calling thread
+    // and skipping the idle time in between, so long runs finish in a
+    // fraction of real time with deterministic results. A scenario `load`
+    // step is run synchronously at its offset, and its errors are thrown
+    // from here. The scheduler thread must not be running.
+    void runFor(std::chrono::nanoseconds duration);
+
+    // Number of received samples kept per receiving telegram (default
+    // kDefaultHistoryDepth, 0 turns history off). Storage is preallocated
+    // for every such telegram on each load, so deep histories on large
+    // configurations cost depth x dataset size each. Takes effect
+    // immediately and discards the samples collected so far.
+    void setHistoryDepth(size_t depth);
+    // Returns one field of a telegram over [from_us, to_us] (steady clock
+    // microseconds), downsampled to at most max_points.
+    HistoryResult queryHistory(const HistoryQuery &query) const;
+
+    // Mirrors every telegram's counters, timestamps and latest RX/TX payload
+    // into the POSIX shared-memory segment `name` (layout in trdp/pd_shm.hpp)
+    // for local readers; an empty name turns it off. The segment is created
+    // again on every config load. Creation errors do not throw but show up
+    // in shmExportStatus().error.
+    void setShmExport(const std::string &name);
+    PdShmStatus shmExportStatus() const;
+
+    // Journals the loaded configuration and the payloads and TX flags set
+    // through setPdValues(), setPdValuesBatch() and enablePd() to `path`
+    // (format in trdp/state_journal.hpp), written by a background thread.
+    // Returns what the journal held; a warm start loads that configuration
+    // and hands the state to restoreState() before start().
+    JournalState openStateJournal(const std::string &path);
+    // Applies journaled payloads and TX flags to the matching sent
+    // telegrams and returns how many were found.
+    size_t restoreState(const JournalState &state);
+    StateJournalStatus stateJournalStatus() const;
+
+    // Records every received PD into a memory-mapped ring file. Loading a new
+    // configuration stops an active capture.
+    void startCapture(const std::string &path, uint32_t slot_count);
+    void stopCapture();
+    PdCaptureStatus captureStatus() const;
+
+    // Sends the payloads of a capture file again from the matching sent
+    // telegrams, at their recorded offsets: through their publications on
+    // TRDP sessions, through the loopback otherwise. A telegram without a
+    // publication counts the sends as tx_errors. Cyclic sends of the
+    // telegrams in the capture are suspended until the replay ends;
+    // disabled telegrams stay silent and their records count as skipped.
+    // Loading a new configuration stops an active replay.
+    void startReplay(const ReplayOptions &options);
+    void stopReplay();
+    ReplayStatus replayStatus() const;
+
+    // Runs a scenario script (format in trdp/pd_scenario.hpp) from the
+    // scheduler, replacing one that is still running. Telegrams and fields
+    // are resolved here, so an unknown one throws before anything runs.
+    // Loading a new configuration stops the scenario.
+    void startScenario(const ScenarioOptions &options);
+    void stopScenario();
+    ScenarioStatus scenarioStatus() const;
+
+    // Message data. Requests are asynchronous: mdRequest() sends `count`
+    // requests and returns their ids immediately; each outcome is delivered
+    // once through the result handler and stays queryable via mdResult().
+    // An empty interface name selects the first interface.
+    std::vector<uint64_t> mdRequest(const MdRequestOptions &options);
+    void mdNotify(const MdRequestOptions &options);
+    // Answers incoming requests for a comId with a fixed payload.
+    void addMdResponder(const MdResponderOptions &options);
+    void removeMdResponder(uint32_t com_id, const std::string &if_name, const std::string &host_name = {});
+    std::optional<MdResult> mdResult(uint64_t id) const;
+    std::vector<MdStatsSnapshot> mdStats() const;
+    size_t mdPendingCount() const;
+    // Called from the TRDP processing thread; must not block.
+    void setMdResultHandler(MdResultHandler handler);
+    void onMdReceive(TRDP_APP_SESSION_T, const TRDP_MD_INFO_T *, const uint8_t *, uint32_t);
+
+    // Issues tlp_request for a pull telegram every interval_us until `count`
+    // requests were sent (0 = until removed). Replies arrive through the
+    // subscription of reply_com_id (defaults to com_id) on the same interface.
+    uint64_t startPdPull(const PdPullOptions &options);
+    bool stopPdPull(uint64_t id);
+    std::vector<PdPullStatus> pdPullStatus() const;
+    std::vector<PdPullStatsSnapshot> pdPullStats() const;
+
+    // Rules on decoded fields, evaluated in the receive path whenever a
+    // telegram's payload changes. Rules refer to the loaded configuration
+    // and are dropped by loadConfig().
+    uint64_t addWatch(const PdWatchSpec &spec);
+    bool removeWatch(uint64_t id);
+    std::vector<PdWatchStatus> watchStatus() const;
+    // Called from the TRDP processing thread with the engine state locked;
+    // must not block or call back into the engine.
+    void setWatchHandler(PdWatchHandler handler);
+
+    // Received payloads that differ from the previous reception of their
+    // telegram, in arrival order. The queue outlives config reloads;
+    // consumers keep their own cursor (see PdChangeQueue::poll).
+    const PdChangeQueue &pdChanges() const;
+
+    // Most recent changes of the active source of any telegram, oldest
+    // first (see PdSourceSet). Kept across config reloads.
+    std::vector<PdSwitchoverEvent> switchovers() const;
+
+    // Lock-free views for metric scrapes; neither takes state_mtx_.
+    const EngineMetrics &engineMetrics() const;
+    std::shared_ptr<const TelegramMetricsTable> telegramMetrics() const;
 
 private:
+    // Everything a configuration load replaces, built off to the side and
+    // swapped in as a whole.
+    struct LoadedConfig {
+        std::vector<std::string> host_names;
+        MemoryConfig memory;
+        std::shared_ptr<PdDefinitions> definitions;
+        std::vector<InterfaceRuntime> interfaces;
+        std::vector<PdTxSlot> pd_tx_slots;
+        std::vector<PdState> pd_states;
+        PayloadArena pd_arena;
+        std::unordered_map<uint32_t, std::vector<PdState *>> pd_by_com_id;
+    };
+
+    std::vector<std::string> host_names_;
+    MemoryConfig memory_config_;
     std::vector<InterfaceRuntime> interfaces_;
-    std::vector<PdTelegramDef> pd_defs_;
-    std::vector<PdRuntime> pd_runtimes_;
-    std::vector<Dataset> datasets_;
-    std::atomic<bool> running_;
+    // Shared with snapshots; everything else of a configuration is freed
+    // when the next load replaces it.
+    std::shared_ptr<const PdDefinitions> definitions_;
+    // Hot/cold split of the per-telegram state. Both vectors and the arena
+    // are sized once in loadConfig(); pointers into them stay valid until
+    // the next load.
+    std::vector<PdTxSlot> pd_tx_slots_;
+    std::vector<PdState> pd_states_;
+    PayloadArena pd_arena_;
+    std::vector<PdHistory> histories_;
+    size_t history_depth_ {kDefaultHistoryDepth};
+    std::unordered_map<uint32_t, std::vector<PdState *>> pd_by_com_id_;
+    std::atomic<bool> running_ {false};
     std::thread pd_thread_;
+    std::shared_ptr<EngineClock> clock_ {std::make_shared<SteadyEngineClock>()};
+    // Scheduler-side state, touched by whichever thread drives
+    // schedulerStep(): the scheduler thread or runFor().
+    std::chrono::steady_clock::time_point next_md_sweep_;
     mutable std::mutex state_mtx_;
+    mutable EngineMetrics engine_metrics_;
+    std::shared_ptr<TelegramMetricsTable> telegram_metrics_;
+    PdRecorder recorder_;
+    mutable std::mutex capture_mtx_;
+    PdReplayer replayer_;
+    mutable std::mutex replay_mtx_;
+
+    struct MdResponder {
+        MdResponderOptions options;
+        TRDP_APP_SESSION_T appHandle;
+        TRDP_LIS_T listener;
+    };
+
+    // md_mtx_ guards the responders and the result handler. It is never held
+    // across a TRDP call: the stack invokes onMdReceive with its session
+    // mutex held, so the opposite order would deadlock.
+    MdSessionTable md_sessions_;
+    std::vector<MdResponder> md_responders_;
+    MdResultHandler md_result_handler_;
+    mutable std::mutex md_mtx_;
+
+    PdPullTable pd_pulls_;
+    PdChangeQueue pd_changes_ {4096u, kPdMaxPayload};
+
+    // Guarded by state_mtx_.
+    PdSubscriberTable pd_subscribers_;
+    PdGeneratorTable pd_generators_;
+    PdShmExport shm_export_;
+    PdLoopback loopback_;
+    std::string shm_name_;
+    std::string shm_error_;
+    static constexpr size_t kSwitchoverHistory = 256u;
+    std::deque<PdSwitchoverEvent> switchovers_;
+    PdWatchTable pd_watches_;
+    std::vector<PdWatchEvent> watch_fired_;
+    PdWatchHandler watch_handler_;
+    std::mutex watch_mtx_;
+
+    // load_mtx_ serializes loads. session_mtx_ is held while a load replaces
+    // the TRDP sessions and by every entry point that uses a session outside
+    // the scheduler thread; like md_mtx_, it is never taken in a callback.
+    std::mutex load_mtx_;
+    std::mutex session_mtx_;
+    // loopback_mode_ applies to the next load; loopback_active_ says whether
+    // the loaded configuration runs on loopback, so a rollback reopens it
+    // the way it was.
+    bool loopback_mode_ {false};
+    bool loopback_active_ {false};
+    std::chrono::steady_clock::time_point loopback_epoch_;
+    PdLoopback::Batch loopback_batch_;
+    std::vector<PdState *> loopback_expired_;
+
+    // A started scenario with its steps bound to the loaded telegrams.
+    // Guarded by state_mtx_.
+    struct ScenarioRun {
+        struct FieldValue {
+            const FieldLayout *field;
+            double value;
+        };
+        struct Step {
+            std::chrono::nanoseconds offset;
+            ScenarioAction action;
+            PdState *state;
+            std::vector<FieldValue> values;
+            std::string path;
+            std::vector<std::string> host_names;
+        };
+        bool active;
+        std::string path;
+        std::vector<Step> steps;
+        std::chrono::nanoseconds length;
+        uint32_t loops;
+        uint32_t passes_done;
+        size_t next;
+        uint64_t executed;
+        std::chrono::steady_clock::time_point started;
+        std::chrono::steady_clock::time_point pass_start;
+        std::chrono::steady_clock::time_point ended;
+        double max_lateness_us;
+    };
+    ScenarioRun scenario_ {};
+    StateJournal state_journal_;
+    // Declared last so its worker is joined before anything it loads into
+    // is destroyed.
+    ConfigJobQueue config_jobs_ {[this](const std::string &path, const std::vector<std::string> &host_names,
+                                        ConfigLoadProgress &progress) { loadConfig(path, host_names, &progress); }};
 
     void pdSchedulerLoop();
-    InterfaceRuntime *findInterface(const std::string &name);
-    PdRuntime *findPdRuntime(uint32_t com_id, const std::string &if_name);
-    const Dataset *findDataset(uint32_t id) const;
-    void sendPdOnInterface(InterfaceRuntime &iface, PdRuntime &pd_runtime);
+    // Returns a scenario load step that came due; the caller runs it once
+    // no engine lock is held.
+    std::optional<ScenarioRun::Step> schedulerStep(std::chrono::steady_clock::time_point now);
+    // Runs the scenario steps due at `now`. A load step is handed back in
+    // `load` so it can be submitted once state_mtx_ is released.
+    void runScenario(std::chrono::steady_clock::time_point now, std::optional<ScenarioRun::Step> &load);
+    std::optional<std::chrono::steady_clock::time_point> nextScenarioDue() const;
+    void setTxEnabled(PdState &state, bool enable, std::chrono::steady_clock::time_point now);
+    void deliverLoopback();
+    void expireLoopbackTimeouts(std::chrono::steady_clock::time_point now);
+    std::optional<std::chrono::steady_clock::time_point> loopbackTimeoutDeadline(const PdState &state) const;
+    std::chrono::steady_clock::time_point clockNow() const { return clock_->now(); }
+    void processSessions();
+    void sendPdPulls(std::chrono::steady_clock::time_point now);
+    void publishMdResult(const MdResult &result);
+    void openShmExport(uint64_t generation);
+    void receivePd(InterfaceRuntime &iface, const TRDP_PD_INFO_T &msg, const uint8_t *data, uint32_t size);
+    PdRxView rxView(const PdState &state) const;
+    void dropMdResponders(uint32_t com_id, const std::string &if_name, const std::string &host_name);
+    InterfaceRuntime *findInterface(const std::string &name, const std::string &host_name);
+    std::string interfaceLabel(const InterfaceRuntime &iface) const;
+    // `sending` skips sink-only telegrams, otherwise source-only ones are
+    // skipped, so a comId shared by several hosts resolves to the side the
+    // caller acts on.
+    PdState *findPdState(uint32_t com_id, const std::string &if_name, const std::string &host_name, bool sending);
+    const PdState *findPdState(uint32_t com_id, const std::string &if_name, const std::string &host_name,
+                               bool sending) const;
+    void resetHistories();
+    void stageConfig(LoadedConfig &staged) const;
+    void openSessions(std::vector<InterfaceRuntime> &interfaces, std::vector<PdState> &states,
+                      const MemoryConfig &memory, bool loopback);
+    size_t patchPdValues(PdState &pd, const std::map<std::string, double> &values);
+    void journalPayload(const PdState &pd);
+    // Both call into the stack with state_mtx_ held, which is only safe on
+    // the thread that also runs processSessions(): the receive callbacks
+    // take state_mtx_ with the stack's session mutex held.
+    void sendPdOnInterface(InterfaceRuntime &iface, const PdState &pd);
+    // Hands the current payload of a pull reply to the stack without sending.
+    void updatePdOnInterface(InterfaceRuntime &iface, const PdState &pd);
+    // Resolves a capture interface label ("iface" or "host/iface") to a
+    // sent telegram. Caller holds state_mtx_.
+    PdState *findReplayState(uint32_t com_id, const std::string &if_name);
+    void markReplaying(const std::vector<ReplayTelegram> &telegrams);
+    void clearReplaying();
+    bool replayPd(uint32_t com_id, const std::string &if_name, const uint8_t *data, uint32_t size);
 };
 
+template <typename Visitor>
+bool TrdpEngine::pollPd(PdCursor &cursor, Visitor &&visit) const {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    const PdState *state = findPdState(cursor.com_id, cursor.interface_name, cursor.host_name, false);
+    if (state == nullptr) {
+        throw std::runtime_error("Unknown PD telegram");
+    }
+    // A reload starts the count over; treat that like a fresh cursor.
+    if (state->rx_count < cursor.seen) {
+        cursor.seen = 0u;
+    }
+    if (state->rx_count == cursor.seen) {
+        return false;
+    }
+
+    cursor.skipped += state->rx_count - cursor.seen - 1u;
+    cursor.seen = state->rx_count;
+    visit(rxView(*state));
+    return true;
+}
+
 }  // namespace trdp
 
@@ -0,0 +1,205 @@
+#include "trdp/config_job.hpp"
+
+#include <algorithm>
+#include <exception>
+
+#include "trdp/trace.hpp"
+
+namespace trdp {
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point since, std::chrono::steady_clock::time_point now) {
+    return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(now - since).count();
+}
+
+}  // namespace
+
+const char *configLoadPhaseName(ConfigLoadPhase phase) {
+    switch (phase) {
+        case ConfigLoadPhase::Parse:
+            return "parse";
+        case ConfigLoadPhase::Validate:
+            return "validate";
+        case ConfigLoadPhase::Stop:
+            return "stop";
+        case ConfigLoadPhase::Open:
+            return "open";
+        case ConfigLoadPhase::Activate:
+            return "activate";
+    }
+    return "?";
+}
+
+const char *configJobStateName(ConfigJobState state) {
+    switch (state) {
+        case ConfigJobState::Queued:
+            return "queued";
+        case ConfigJobState::Running:
+            return "running";
+        case ConfigJobState::Succeeded:
+            return "succeeded";
+        case ConfigJobState::Failed:
+            return "failed";
+    }
+    return "?";
+}
+
+ConfigJobQueue::ConfigJobQueue(Runner runner) : runner_(std::move(runner)) {}
+
+ConfigJobQueue::~ConfigJobQueue() { stop(); }
+
+uint64_t ConfigJobQueue::submit(const std::string &path, const std::vector<std::string> &host_names) {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    ConfigJobStatus job {};
+    job.id = next_id_++;
+    job.path = path;
+    job.host_names = host_names;
+    job.state = ConfigJobState::Queued;
+    jobs_.push_back(std::move(job));
+    pending_.push_back(jobs_.back().id);
+
+    // Queued jobs are never evicted, only finished ones.
+    while (jobs_.size() > kConfigJobHistory) {
+        const auto it = std::find_if(jobs_.begin(), jobs_.end(), [](const ConfigJobStatus &entry) {
+            return entry.state == ConfigJobState::Succeeded || entry.state == ConfigJobState::Failed;
+        });
+        if (it == jobs_.end()) {
+            break;
+        }
+        jobs_.erase(it);
+    }
+
+    // The worker is started lazily so a process that daemonizes after
+    // constructing the engine does not lose it in the fork.
+    stop_requested_ = false;
+    if (!thread_.joinable()) {
+        thread_ = std::thread(&ConfigJobQueue::run, this);
+    }
+    wake_.notify_one();
+    return jobs_.back().id;
+}
+
+std::optional<ConfigJobStatus> ConfigJobQueue::status(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (const auto &job : jobs_) {
+        if (job.id == id) {
+            return job;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<ConfigJobStatus> ConfigJobQueue::list() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return std::vector<ConfigJobStatus>(jobs_.rbegin(), jobs_.rend());
+}
+
+void ConfigJobQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_requested_ = true;
+        for (const uint64_t id : pending_) {
+            if (ConfigJobStatus *job = findLocked(id)) {
+                job->state = ConfigJobState::Failed;
+                job->error = "Cancelled";
+            }
+        }
+        pending_.clear();
+    }
+    wake_.notify_one();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+ConfigJobStatus *ConfigJobQueue::findLocked(uint64_t id) {
+    for (auto &job : jobs_) {
+        if (job.id == id) {
+            return &job;
+        }
+    }
+    return nullptr;
+}
+
+void ConfigJobQueue::enterPhase(uint64_t id, ConfigLoadPhase phase) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mtx_);
+    ConfigJobStatus *job = findLocked(id);
+    if (job == nullptr) {
+        return;
+    }
+
+    auto &previous = job->phases[static_cast<size_t>(job->phase)];
+    if (previous.started && !previous.finished) {
+        previous.finished = true;
+        previous.duration_ms = elapsedMs(phase_start_, now);
+    }
+
+    job->phase = phase;
+    job->phases[static_cast<size_t>(phase)].started = true;
+    job->total_ms = elapsedMs(job_start_, now);
+    phase_start_ = now;
+}
+
+void ConfigJobQueue::run() {
+    traceSetThreadName("config-loader");
+
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+        wake_.wait(lock, [this]() { return stop_requested_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            return;
+        }
+
+        const uint64_t id = pending_.front();
+        pending_.pop_front();
+        ConfigJobStatus *job = findLocked(id);
+        if (job == nullptr) {
+            continue;
+        }
+        job->state = ConfigJobState::Running;
+        const std::string path = job->path;
+        const std::vector<std::string> hostNames = job->host_names;
+        job_start_ = std::chrono::steady_clock::now();
+        phase_start_ = job_start_;
+        lock.unlock();
+
+        ConfigLoadProgress progress;
+        progress.on_phase = [this, id](ConfigLoadPhase phase) { enterPhase(id, phase); };
+
+        std::string error;
+        bool failed = false;
+        try {
+            runner_(path, hostNames, progress);
+        } catch (const std::exception &ex) {
+            failed = true;
+            error = ex.what();
+        } catch (...) {
+            failed = true;
+            error = "Unknown error";
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        lock.lock();
+        job = findLocked(id);
+        if (job == nullptr) {
+            continue;
+        }
+
+        // A failed phase keeps finished == false but still reports how
+        // long it ran before it gave up.
+        auto &current = job->phases[static_cast<size_t>(job->phase)];
+        if (current.started && !current.finished) {
+            current.finished = !failed;
+            current.duration_ms = elapsedMs(phase_start_, now);
+        }
+        job->state = failed ? ConfigJobState::Failed : ConfigJobState::Succeeded;
+        job->total_ms = elapsedMs(job_start_, now);
+        job->rolled_back = progress.rolled_back;
+        job->error = std::move(error);
+    }
+}
+
+}  // namespace trdp
@@ -1,6 +1,7 @@
 #include "trdp/core.hpp"
 
-#include <iostream>
+#include "trdp/log.hpp"
+
 #include <utility>
 
 namespace trdp {
@@ -15,12 +16,12 @@ void TrdpEngine::loadConfig(const std::string &xml_path, const std::string &host
 
 void TrdpEngine::start() {
     running_ = true;
-    std::cout << "Starting TRDP engine for host " << host_name_ << " using config " << config_path_ << "..." << std::endl;
+    logEvent(LogModule::Engine, LogLevel::Info, "engine.started", {{"host", host_name_}, {"config", config_path_}});
 }
 
 void TrdpEngine::stop() {
     if (running_) {
-        std::cout << "Stopping TRDP engine..." << std::endl;
+        logEvent(LogModule::Engine, LogLevel::Info, "engine.stopped");
         running_ = false;
     }
 }
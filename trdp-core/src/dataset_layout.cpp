@@ -0,0 +1,124 @@
+#include "trdp/dataset_layout.hpp"
+
+#include <trdp_types.h>
+
+namespace trdp {
+
+const FieldLayout *DatasetLayout::findField(const std::string &name) const {
+    for (const auto &field : fields) {
+        if (field.name == name) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+DatasetLayout buildDatasetLayout(const Dataset &dataset) {
+    DatasetLayout layout {};
+    layout.dataset_id = dataset.id;
+    layout.size = 0u;
+    layout.complete = true;
+    layout.fields.reserve(dataset.elements.size());
+
+    for (const auto &element : dataset.elements) {
+        const uint32_t size = elementSize(element.type);
+        if (size == 0u) {
+            layout.complete = false;
+            break;
+        }
+
+        FieldLayout field {};
+        field.name = element.name;
+        field.type = element.type;
+        field.array_size = element.array_size == 0u ? 1u : element.array_size;
+        field.offset = layout.size;
+        field.element_size = size;
+        layout.fields.push_back(field);
+
+        layout.size += size * field.array_size;
+    }
+
+    return layout;
+}
+
+uint32_t elementSize(uint32_t type) {
+    switch (type) {
+        case TRDP_BOOL8:
+        case TRDP_UINT8:
+        case TRDP_INT8:
+            return 1u;
+        case TRDP_UINT16:
+        case TRDP_INT16:
+            return 2u;
+        case TRDP_UINT32:
+        case TRDP_INT32:
+            return 4u;
+        default:
+            return 0u;
+    }
+}
+
+void encodeElement(uint8_t *dst, uint32_t type, double value) {
+    switch (type) {
+        case TRDP_BOOL8: {
+            dst[0] = value != 0.0 ? 1u : 0u;
+            break;
+        }
+        case TRDP_UINT8: {
+            dst[0] = static_cast<uint8_t>(value);
+            break;
+        }
+        case TRDP_INT8: {
+            dst[0] = static_cast<uint8_t>(static_cast<int8_t>(value));
+            break;
+        }
+        case TRDP_UINT16:
+        case TRDP_INT16: {
+            const uint16_t v = type == TRDP_UINT16 ? static_cast<uint16_t>(value)
+                                                   : static_cast<uint16_t>(static_cast<int16_t>(value));
+            dst[0] = static_cast<uint8_t>((v >> 8) & 0xFFu);
+            dst[1] = static_cast<uint8_t>(v & 0xFFu);
+            break;
+        }
+        case TRDP_UINT32:
+        case TRDP_INT32: {
+            const uint32_t v = type == TRDP_UINT32 ? static_cast<uint32_t>(value)
+                                                   : static_cast<uint32_t>(static_cast<int32_t>(value));
+            dst[0] = static_cast<uint8_t>((v >> 24) & 0xFFu);
+            dst[1] = static_cast<uint8_t>((v >> 16) & 0xFFu);
+            dst[2] = static_cast<uint8_t>((v >> 8) & 0xFFu);
+            dst[3] = static_cast<uint8_t>(v & 0xFFu);
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+int64_t decodeElement(const uint8_t *src, uint32_t type) {
+    switch (type) {
+        case TRDP_BOOL8:
+        case TRDP_UINT8:
+            return static_cast<int64_t>(src[0]);
+        case TRDP_INT8:
+            return static_cast<int64_t>(static_cast<int8_t>(src[0]));
+        case TRDP_UINT16:
+            return static_cast<int64_t>(static_cast<uint16_t>((static_cast<uint16_t>(src[0]) << 8u) |
+                                                              static_cast<uint16_t>(src[1])));
+        case TRDP_INT16:
+            return static_cast<int64_t>(static_cast<int16_t>((static_cast<uint16_t>(src[0]) << 8u) |
+                                                             static_cast<uint16_t>(src[1])));
+        case TRDP_UINT32:
+            return static_cast<int64_t>((static_cast<uint32_t>(src[0]) << 24u) | (static_cast<uint32_t>(src[1]) << 16u) |
+                                        (static_cast<uint32_t>(src[2]) << 8u) | static_cast<uint32_t>(src[3]));
+        case TRDP_INT32:
+            return static_cast<int64_t>(static_cast<int32_t>(
+                (static_cast<uint32_t>(src[0]) << 24u) | (static_cast<uint32_t>(src[1]) << 16u) |
+                (static_cast<uint32_t>(src[2]) << 8u) | static_cast<uint32_t>(src[3])));
+        default:
+            return 0;
+    }
+}
+
+}  // namespace trdp
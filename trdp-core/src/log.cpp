@@ -0,0 +1,460 @@
+#include "trdp/log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace trdp {
+namespace detail {
+
+std::atomic<bool> g_log_active {false};
+
+static_assert(kLogModuleCount == 6u, "add a default level for the new module");
+std::atomic<uint8_t> g_log_levels[kLogModuleCount] = {
+    {static_cast<uint8_t>(LogLevel::Info)}, {static_cast<uint8_t>(LogLevel::Info)},
+    {static_cast<uint8_t>(LogLevel::Info)}, {static_cast<uint8_t>(LogLevel::Info)},
+    {static_cast<uint8_t>(LogLevel::Info)}, {static_cast<uint8_t>(LogLevel::Info)},
+};
+
+}  // namespace detail
+
+namespace {
+
+constexpr size_t kRateSlots = 512u;
+constexpr auto kWriterIdle = std::chrono::milliseconds(2);
+constexpr size_t kWriteChunk = 64u * 1024u;
+
+struct LogRecord {
+    int64_t time_ns;
+    const char *event;
+    LogModule module;
+    LogLevel level;
+    uint8_t field_count;
+    uint32_t suppressed;
+    LogField fields[kLogMaxFields];
+};
+
+// Bounded multi-producer queue after Vyukov: a cell's sequence number says
+// whether it is free for the producer at `pos` (seq == pos) or holds a
+// record for the consumer (seq == pos + 1). Only the writer thread pops.
+class LogQueue {
+public:
+    explicit LogQueue(size_t capacity) : mask_(capacity - 1u), cells_(new Cell[capacity]) {
+        for (size_t idx = 0u; idx < capacity; ++idx) {
+            cells_[idx].seq.store(idx, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(const LogRecord &record) {
+        uint64_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells_[pos & mask_];
+            const uint64_t seq = cell.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<int64_t>(seq - pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+                    cell.record = record;
+                    cell.seq.store(pos + 1u, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(LogRecord &record) {
+        Cell &cell = cells_[head_ & mask_];
+        if (cell.seq.load(std::memory_order_acquire) != head_ + 1u) {
+            return false;
+        }
+        record = cell.record;
+        cell.seq.store(head_ + mask_ + 1u, std::memory_order_release);
+        head_++;
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<uint64_t> seq;
+        LogRecord record;
+    };
+
+    const uint64_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<uint64_t> tail_ {0u};
+    alignas(64) uint64_t head_ {0u};
+};
+
+// Fixed window per second, indexed by the event name's address. Names
+// that share a slot share its budget.
+struct RateSlot {
+    std::atomic<int64_t> window {-1};
+    std::atomic<uint32_t> count {0u};
+    std::atomic<uint32_t> suppressed {0u};
+};
+
+struct LogRegistry {
+    std::mutex mtx;
+    std::unique_ptr<LogQueue> queue;
+    std::thread writer;
+    std::FILE *sink {nullptr};
+    std::string path;
+    std::atomic<bool> stopping {false};
+    std::atomic<uint32_t> rate_limit {0u};
+    std::atomic<uint64_t> written {0u};
+    std::atomic<uint64_t> dropped {0u};
+    std::atomic<uint64_t> suppressed {0u};
+    RateSlot slots[kRateSlots];
+};
+
+LogRegistry &registry() {
+    static LogRegistry instance;
+    return instance;
+}
+
+int64_t wallNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+bool admit(LogRegistry &reg, const char *event, int64_t now_ns, uint32_t &suppressed) {
+    const uint32_t limit = reg.rate_limit.load(std::memory_order_relaxed);
+    if (limit == 0u) {
+        return true;
+    }
+
+    RateSlot &slot = reg.slots[(reinterpret_cast<uintptr_t>(event) >> 3u) % kRateSlots];
+    const int64_t window = now_ns / 1000000000;
+    int64_t seen = slot.window.load(std::memory_order_relaxed);
+    if (seen != window && slot.window.compare_exchange_strong(seen, window, std::memory_order_relaxed)) {
+        slot.count.store(0u, std::memory_order_relaxed);
+    }
+    if (slot.count.fetch_add(1u, std::memory_order_relaxed) >= limit) {
+        slot.suppressed.fetch_add(1u, std::memory_order_relaxed);
+        reg.suppressed.fetch_add(1u, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed = slot.suppressed.exchange(0u, std::memory_order_relaxed);
+    return true;
+}
+
+void appendEscaped(std::string &out, const char *text) {
+    for (const char *c = text != nullptr ? text : ""; *c != '\0'; ++c) {
+        switch (*c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            default:
+                if (static_cast<unsigned char>(*c) < 0x20u) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(*c));
+                    out += escaped;
+                } else {
+                    out += *c;
+                }
+                break;
+        }
+    }
+}
+
+void appendRecord(std::string &out, const LogRecord &record) {
+    const std::time_t seconds = static_cast<std::time_t>(record.time_ns / 1000000000);
+    std::tm utc {};
+    gmtime_r(&seconds, &utc);
+    char buffer[64];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &utc);
+    out += "{\"time\":\"";
+    out += buffer;
+    std::snprintf(buffer, sizeof(buffer), ".%06lldZ", static_cast<long long>((record.time_ns % 1000000000) / 1000));
+    out += buffer;
+    out += "\",\"level\":\"";
+    out += logLevelToString(record.level);
+    out += "\",\"module\":\"";
+    out += logModuleToString(record.module);
+    out += "\",\"event\":\"";
+    appendEscaped(out, record.event);
+    out += '"';
+
+    for (uint8_t idx = 0u; idx < record.field_count; ++idx) {
+        const LogField &field = record.fields[idx];
+        out += ",\"";
+        appendEscaped(out, field.key);
+        out += "\":";
+        switch (field.kind) {
+            case LogValueKind::Int:
+                out += std::to_string(field.i);
+                break;
+            case LogValueKind::Uint:
+                out += std::to_string(field.u);
+                break;
+            case LogValueKind::Double:
+                if (std::isfinite(field.d)) {
+                    std::snprintf(buffer, sizeof(buffer), "%.10g", field.d);
+                    out += buffer;
+                } else {
+                    out += "null";
+                }
+                break;
+            case LogValueKind::Text:
+                out += '"';
+                appendEscaped(out, field.text);
+                out += '"';
+                break;
+            case LogValueKind::None:
+                out += "null";
+                break;
+        }
+    }
+    if (record.suppressed > 0u) {
+        out += ",\"suppressed\":";
+        out += std::to_string(record.suppressed);
+    }
+    out += "}\n";
+}
+
+void writerLoop(LogRegistry &reg) {
+    std::string out;
+    LogRecord record;
+    while (true) {
+        // Read before draining so records queued ahead of logStop() are
+        // written before the loop ends.
+        const bool stop = reg.stopping.load(std::memory_order_acquire);
+        uint64_t count = 0u;
+        while (reg.queue->pop(record)) {
+            appendRecord(out, record);
+            count++;
+            if (out.size() >= kWriteChunk) {
+                std::fwrite(out.data(), 1u, out.size(), reg.sink);
+                out.clear();
+            }
+        }
+        if (!out.empty()) {
+            std::fwrite(out.data(), 1u, out.size(), reg.sink);
+            out.clear();
+        }
+        if (count > 0u) {
+            std::fflush(reg.sink);
+            reg.written.fetch_add(count, std::memory_order_relaxed);
+        } else if (stop) {
+            return;
+        } else {
+            std::this_thread::sleep_for(kWriterIdle);
+        }
+    }
+}
+
+size_t roundUpPow2(size_t value) {
+    size_t result = 1u;
+    while (result < value) {
+        result <<= 1u;
+    }
+    return result;
+}
+
+}  // namespace
+
+void LogField::setText(const char *value) {
+    std::strncpy(text, value != nullptr ? value : "", kLogTextSize - 1u);
+}
+
+namespace detail {
+
+void logEmit(LogModule module, LogLevel level, const char *event, std::initializer_list<LogField> fields) {
+    LogRegistry &reg = registry();
+    const int64_t now = wallNowNs();
+    uint32_t suppressed = 0u;
+    if (!admit(reg, event, now, suppressed)) {
+        return;
+    }
+
+    LogRecord record;
+    record.time_ns = now;
+    record.event = event;
+    record.module = module;
+    record.level = level;
+    record.suppressed = suppressed;
+    record.field_count = 0u;
+    for (const LogField &field : fields) {
+        if (record.field_count == kLogMaxFields) {
+            break;
+        }
+        record.fields[record.field_count++] = field;
+    }
+
+    // The queue exists from the first start on and is never freed, so a
+    // producer racing logStop() still has somewhere to write.
+    if (!reg.queue->push(record)) {
+        reg.dropped.fetch_add(1u, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace detail
+
+void logStart(const LogOptions &options) {
+    logStop();
+
+    LogRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    std::FILE *sink = stderr;
+    if (!options.path.empty()) {
+        sink = std::fopen(options.path.c_str(), "a");
+        if (sink == nullptr) {
+            throw std::runtime_error("Failed to open log file: " + options.path);
+        }
+    }
+
+    if (!reg.queue) {
+        reg.queue = std::make_unique<LogQueue>(roundUpPow2(std::max<size_t>(options.queue_size, 2u)));
+    }
+    reg.sink = sink;
+    reg.path = options.path;
+    reg.rate_limit.store(options.rate_limit, std::memory_order_relaxed);
+    reg.stopping.store(false, std::memory_order_relaxed);
+    reg.writer = std::thread(writerLoop, std::ref(reg));
+    detail::g_log_active.store(true, std::memory_order_release);
+}
+
+void logStop() {
+    LogRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    if (!reg.writer.joinable()) {
+        return;
+    }
+
+    detail::g_log_active.store(false, std::memory_order_release);
+    reg.stopping.store(true, std::memory_order_release);
+    reg.writer.join();
+    if (reg.sink != stderr) {
+        std::fclose(reg.sink);
+    }
+    reg.sink = nullptr;
+}
+
+LogStatus logStatus() {
+    LogRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    return LogStatus {reg.writer.joinable(), reg.path, reg.written.load(std::memory_order_relaxed),
+                      reg.dropped.load(std::memory_order_relaxed), reg.suppressed.load(std::memory_order_relaxed)};
+}
+
+void logSetLevel(LogModule module, LogLevel level) {
+    detail::g_log_levels[static_cast<size_t>(module)].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+LogLevel logLevel(LogModule module) {
+    return static_cast<LogLevel>(detail::g_log_levels[static_cast<size_t>(module)].load(std::memory_order_relaxed));
+}
+
+void logSetLevels(const std::string &spec) {
+    // Parsed completely before anything is applied.
+    std::vector<std::pair<size_t, LogLevel>> levels;
+    size_t begin = 0u;
+    while (begin <= spec.size()) {
+        const size_t end = std::min(spec.find(',', begin), spec.size());
+        const std::string entry = spec.substr(begin, end - begin);
+        begin = end + 1u;
+        if (entry.empty()) {
+            continue;
+        }
+
+        const auto eq = entry.find('=');
+        if (eq == std::string::npos) {
+            const LogLevel level = parseLogLevel(entry);
+            for (size_t module = 0u; module < kLogModuleCount; ++module) {
+                levels.emplace_back(module, level);
+            }
+        } else {
+            levels.emplace_back(static_cast<size_t>(parseLogModule(entry.substr(0u, eq))),
+                                parseLogLevel(entry.substr(eq + 1u)));
+        }
+    }
+
+    for (const auto &entry : levels) {
+        logSetLevel(static_cast<LogModule>(entry.first), entry.second);
+    }
+}
+
+LogLevel parseLogLevel(const std::string &text) {
+    if (text == "trace") {
+        return LogLevel::Trace;
+    }
+    if (text == "debug") {
+        return LogLevel::Debug;
+    }
+    if (text == "info") {
+        return LogLevel::Info;
+    }
+    if (text == "warn") {
+        return LogLevel::Warn;
+    }
+    if (text == "error") {
+        return LogLevel::Error;
+    }
+    if (text == "off") {
+        return LogLevel::Off;
+    }
+    throw std::runtime_error("Unknown log level: " + text);
+}
+
+LogModule parseLogModule(const std::string &text) {
+    for (size_t module = 0u; module < kLogModuleCount; ++module) {
+        if (text == logModuleToString(static_cast<LogModule>(module))) {
+            return static_cast<LogModule>(module);
+        }
+    }
+    throw std::runtime_error("Unknown log module: " + text);
+}
+
+const char *logLevelToString(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace:
+            return "trace";
+        case LogLevel::Debug:
+            return "debug";
+        case LogLevel::Info:
+            return "info";
+        case LogLevel::Warn:
+            return "warn";
+        case LogLevel::Error:
+            return "error";
+        case LogLevel::Off:
+            return "off";
+    }
+    return "?";
+}
+
+const char *logModuleToString(LogModule module) {
+    switch (module) {
+        case LogModule::Engine:
+            return "engine";
+        case LogModule::Config:
+            return "config";
+        case LogModule::PdRx:
+            return "pd.rx";
+        case LogModule::PdTx:
+            return "pd.tx";
+        case LogModule::Scheduler:
+            return "scheduler";
+        case LogModule::Md:
+            return "md";
+        case LogModule::Count:
+            break;
+    }
+    return "?";
+}
+
+}  // namespace trdp
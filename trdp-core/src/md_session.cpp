@@ -0,0 +1,162 @@
+#include "trdp/md_session.hpp"
+
+#include <utility>
+
+namespace trdp {
+
+MdComIdStats::MdComIdStats()
+    : rtt_us({100.0, 250.0, 500.0, 1000.0, 2500.0, 5000.0, 10000.0, 25000.0, 50000.0, 100000.0, 250000.0, 500000.0,
+              1000000.0, 5000000.0}) {}
+
+MdSessionTable::MdSessionTable(size_t completed_capacity) : completed_capacity_(completed_capacity) {}
+
+uint64_t MdSessionTable::add(uint32_t com_id, Clock::time_point sent, Clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    const uint64_t id = next_id_++;
+    pending_.emplace(id, Pending {com_id, sent, deadline});
+    return id;
+}
+
+std::optional<MdResult> MdSessionTable::complete(uint64_t id, MdState state, int32_t result_code, uint32_t src_ip,
+                                                 const uint8_t *data, uint32_t size, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    const auto it = pending_.find(id);
+    if (it == pending_.end()) {
+        const auto done = completed_.find(id);
+        if (done != completed_.end() && state == MdState::Replied) {
+            done->second.replies++;
+        }
+        return std::nullopt;
+    }
+
+    MdResult result {};
+    result.id = id;
+    result.com_id = it->second.com_id;
+    result.state = state;
+    result.result_code = result_code;
+    result.src_ip = src_ip;
+    result.replies = state == MdState::Replied ? 1u : 0u;
+    result.rtt_us = std::chrono::duration<double, std::micro>(now - it->second.sent).count();
+    if (data != nullptr && size > 0u) {
+        result.reply_payload.assign(data, data + size);
+    }
+    pending_.erase(it);
+
+    auto &comIdStats = stats(result.com_id);
+    switch (state) {
+        case MdState::Replied:
+            comIdStats.replies.add();
+            comIdStats.rtt_us.observe(result.rtt_us);
+            break;
+        case MdState::Timeout:
+            comIdStats.timeouts.add();
+            break;
+        default:
+            comIdStats.errors.add();
+            break;
+    }
+
+    storeCompleted(result);
+    return result;
+}
+
+std::vector<MdResult> MdSessionTable::expire(Clock::time_point now) {
+    std::vector<MdResult> expired;
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        if (it->second.deadline > now) {
+            ++it;
+            continue;
+        }
+
+        MdResult result {};
+        result.id = it->first;
+        result.com_id = it->second.com_id;
+        result.state = MdState::Timeout;
+        result.rtt_us = std::chrono::duration<double, std::micro>(now - it->second.sent).count();
+        stats(result.com_id).timeouts.add();
+
+        storeCompleted(result);
+        expired.push_back(std::move(result));
+        it = pending_.erase(it);
+    }
+
+    return expired;
+}
+
+void MdSessionTable::clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    pending_.clear();
+}
+
+std::optional<MdResult> MdSessionTable::find(uint64_t id) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    const auto pending = pending_.find(id);
+    if (pending != pending_.end()) {
+        MdResult result {};
+        result.id = id;
+        result.com_id = pending->second.com_id;
+        result.state = MdState::Pending;
+        return result;
+    }
+
+    const auto done = completed_.find(id);
+    if (done != completed_.end()) {
+        return done->second;
+    }
+    return std::nullopt;
+}
+
+size_t MdSessionTable::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return pending_.size();
+}
+
+void MdSessionTable::increment(uint32_t com_id, Counter MdComIdStats::*counter) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    (stats(com_id).*counter).add();
+}
+
+MdComIdStats &MdSessionTable::stats(uint32_t com_id) {
+    auto &slot = stats_[com_id];
+    if (!slot) {
+        slot = std::make_unique<MdComIdStats>();
+    }
+    return *slot;
+}
+
+std::vector<MdStatsSnapshot> MdSessionTable::statsSnapshot() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    std::vector<MdStatsSnapshot> snapshot;
+    snapshot.reserve(stats_.size());
+    for (const auto &entry : stats_) {
+        const MdComIdStats &s = *entry.second;
+        snapshot.push_back(MdStatsSnapshot {entry.first,
+                                            s.requests.value(),
+                                            s.replies.value(),
+                                            s.timeouts.value(),
+                                            s.errors.value(),
+                                            s.notifications_sent.value(),
+                                            s.requests_received.value(),
+                                            s.notifications_received.value(),
+                                            s.confirms_received.value(),
+                                            s.rtt_us.snapshot()});
+    }
+    return snapshot;
+}
+
+void MdSessionTable::storeCompleted(MdResult result) {
+    completed_order_.push_back(result.id);
+    completed_[result.id] = std::move(result);
+
+    while (completed_order_.size() > completed_capacity_) {
+        completed_.erase(completed_order_.front());
+        completed_order_.pop_front();
+    }
+}
+
+}  // namespace trdp
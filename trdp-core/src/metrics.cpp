@@ -0,0 +1,56 @@
+#include "trdp/metrics.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace trdp {
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)), buckets_(new std::atomic<uint64_t>[bounds_.size() + 1u]) {
+    std::sort(bounds_.begin(), bounds_.end());
+    for (size_t idx = 0u; idx <= bounds_.size(); ++idx) {
+        buckets_[idx].store(0u, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(double value) {
+    const auto it = std::lower_bound(bounds_.begin(), bounds_.end(), value);
+    const auto bucket = static_cast<size_t>(it - bounds_.begin());
+    buckets_[bucket].fetch_add(1u, std::memory_order_relaxed);
+    count_.fetch_add(1u, std::memory_order_relaxed);
+
+    double sum = sum_.load(std::memory_order_relaxed);
+    while (!sum_.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot snapshot {};
+    snapshot.bounds = bounds_;
+    snapshot.counts.reserve(bounds_.size() + 1u);
+    for (size_t idx = 0u; idx <= bounds_.size(); ++idx) {
+        snapshot.counts.push_back(buckets_[idx].load(std::memory_order_relaxed));
+    }
+    snapshot.count = count_.load(std::memory_order_relaxed);
+    snapshot.sum = sum_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+TelegramMetrics::TelegramMetrics(uint32_t com_id, std::string name, std::string interface_name, std::string host_name)
+    : com_id(com_id),
+      name(std::move(name)),
+      interface_name(std::move(interface_name)),
+      host_name(std::move(host_name)),
+      rx_period_us({100.0, 500.0, 1000.0, 2000.0, 5000.0, 10000.0, 20000.0, 50000.0, 100000.0, 200000.0, 500000.0,
+                    1000000.0, 2000000.0, 5000000.0}),
+      tx_lateness_us({10.0, 50.0, 100.0, 250.0, 500.0, 1000.0, 2000.0, 5000.0, 10000.0, 50000.0, 100000.0}),
+      rx_loss_burst({1.0, 2.0, 3.0, 5.0, 10.0, 20.0, 50.0, 100.0, 1000.0, 10000.0}),
+      switchover_gap_us({1000.0, 5000.0, 10000.0, 20000.0, 50000.0, 100000.0, 200000.0, 500000.0, 1000000.0,
+                         5000000.0}) {}
+
+EngineMetrics::EngineMetrics()
+    : scheduler_lateness_us({10.0, 50.0, 100.0, 250.0, 500.0, 1000.0, 2000.0, 5000.0, 10000.0, 50000.0}),
+      rx_callback_ns({250.0, 500.0, 1000.0, 2500.0, 5000.0, 10000.0, 25000.0, 50000.0, 100000.0, 1000000.0}),
+      snapshot_bytes({1024.0, 4096.0, 16384.0, 65536.0, 262144.0, 1048576.0, 4194304.0, 16777216.0}) {}
+
+}  // namespace trdp
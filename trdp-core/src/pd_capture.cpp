@@ -0,0 +1,380 @@
+#include "trdp/pd_capture.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trdp {
+namespace {
+
+constexpr char kCaptureMagic[8] = {'W', 'T', 'R', 'D', 'P', 'C', 'A', 'P'};
+constexpr uint16_t kTrdpPdPort = 17224u;
+constexpr uint16_t kTrdpProtocolVersion = 0x0100u;
+constexpr uint32_t kPdHeaderSize = 40u;
+
+static_assert(sizeof(CaptureFileHeader) <= kCaptureHeaderSize, "capture header must fit in the header page");
+
+uint32_t slotSize() {
+    const uint32_t raw = static_cast<uint32_t>(sizeof(CaptureSlotHeader)) + kCaptureMaxPayload;
+    return (raw + 63u) & ~63u;
+}
+
+uint64_t oldestRecord(uint64_t head, uint32_t slot_count) { return head > slot_count ? head - slot_count : 0u; }
+
+uint32_t crc32(const uint8_t *data, size_t size) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t idx = 0u; idx < size; ++idx) {
+        crc ^= data[idx];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1u) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+void putBe16(std::vector<uint8_t> &buf, uint16_t v) {
+    buf.push_back(static_cast<uint8_t>(v >> 8u));
+    buf.push_back(static_cast<uint8_t>(v));
+}
+
+void putBe32(std::vector<uint8_t> &buf, uint32_t v) {
+    putBe16(buf, static_cast<uint16_t>(v >> 16u));
+    putBe16(buf, static_cast<uint16_t>(v));
+}
+
+template <typename T>
+void writeRaw(std::ostream &out, T value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void writePadding(std::ostream &out, size_t size) {
+    static const char zeros[4] = {0, 0, 0, 0};
+    out.write(zeros, static_cast<std::streamsize>((4u - (size % 4u)) % 4u));
+}
+
+size_t padded(size_t size) { return (size + 3u) & ~static_cast<size_t>(3u); }
+
+void writeSectionHeader(std::ostream &out) {
+    const uint32_t length = 28u;
+    writeRaw<uint32_t>(out, 0x0A0D0D0Au);
+    writeRaw<uint32_t>(out, length);
+    writeRaw<uint32_t>(out, 0x1A2B3C4Du);
+    writeRaw<uint16_t>(out, 1u);
+    writeRaw<uint16_t>(out, 0u);
+    writeRaw<int64_t>(out, -1);
+    writeRaw<uint32_t>(out, length);
+}
+
+void writeInterfaceDescription(std::ostream &out, const std::string &name) {
+    const size_t nameOption = 4u + padded(name.size());
+    const size_t tsresolOption = 4u + 4u;
+    const auto length = static_cast<uint32_t>(20u + nameOption + tsresolOption + 4u);
+
+    writeRaw<uint32_t>(out, 1u);
+    writeRaw<uint32_t>(out, length);
+    writeRaw<uint16_t>(out, 101u);  // LINKTYPE_RAW
+    writeRaw<uint16_t>(out, 0u);
+    writeRaw<uint32_t>(out, 0u);
+
+    writeRaw<uint16_t>(out, 2u);  // if_name
+    writeRaw<uint16_t>(out, static_cast<uint16_t>(name.size()));
+    out.write(name.data(), static_cast<std::streamsize>(name.size()));
+    writePadding(out, name.size());
+
+    writeRaw<uint16_t>(out, 9u);  // if_tsresol: nanoseconds
+    writeRaw<uint16_t>(out, 1u);
+    writeRaw<uint8_t>(out, 9u);
+    writePadding(out, 1u);
+
+    writeRaw<uint32_t>(out, 0u);  // opt_endofopt
+    writeRaw<uint32_t>(out, length);
+}
+
+void buildPacket(const PdCaptureReader::Entry &entry, std::vector<uint8_t> &packet) {
+    const uint32_t trdpSize = kPdHeaderSize + entry.captured_size;
+    const uint32_t udpSize = 8u + kPdHeaderSize + entry.payload_size;
+    const uint32_t ipSize = 20u + udpSize;
+
+    packet.clear();
+    packet.reserve(28u + trdpSize);
+
+    putBe16(packet, 0x4500u);
+    putBe16(packet, static_cast<uint16_t>(ipSize));
+    putBe16(packet, 0u);
+    putBe16(packet, 0x4000u);
+    putBe16(packet, 0x4011u);  // TTL 64, UDP
+    putBe16(packet, 0u);
+    putBe32(packet, entry.src_ip);
+    putBe32(packet, entry.dest_ip);
+
+    uint32_t sum = 0u;
+    for (size_t idx = 0u; idx < 20u; idx += 2u) {
+        sum += (static_cast<uint32_t>(packet[idx]) << 8u) | packet[idx + 1u];
+    }
+    while ((sum >> 16u) != 0u) {
+        sum = (sum & 0xFFFFu) + (sum >> 16u);
+    }
+    const auto checksum = static_cast<uint16_t>(~sum);
+    packet[10] = static_cast<uint8_t>(checksum >> 8u);
+    packet[11] = static_cast<uint8_t>(checksum);
+
+    putBe16(packet, kTrdpPdPort);
+    putBe16(packet, kTrdpPdPort);
+    putBe16(packet, static_cast<uint16_t>(udpSize));
+    putBe16(packet, 0u);
+
+    const size_t headerStart = packet.size();
+    putBe32(packet, entry.seq_count);
+    putBe16(packet, kTrdpProtocolVersion);
+    putBe16(packet, entry.msg_type);
+    putBe32(packet, entry.com_id);
+    putBe32(packet, 0u);
+    putBe32(packet, 0u);
+    putBe32(packet, entry.payload_size);
+    putBe32(packet, 0u);
+    putBe32(packet, 0u);
+    putBe32(packet, 0u);
+
+    const uint32_t fcs = crc32(packet.data() + headerStart, kPdHeaderSize - 4u);
+    packet.push_back(static_cast<uint8_t>(fcs));
+    packet.push_back(static_cast<uint8_t>(fcs >> 8u));
+    packet.push_back(static_cast<uint8_t>(fcs >> 16u));
+    packet.push_back(static_cast<uint8_t>(fcs >> 24u));
+
+    packet.insert(packet.end(), entry.payload, entry.payload + entry.captured_size);
+}
+
+}  // namespace
+
+PdRecorder::~PdRecorder() { stop(); }
+
+void PdRecorder::start(const std::string &path, uint32_t slot_count, const std::vector<CaptureInterface> &interfaces) {
+    stop();
+
+    if (slot_count == 0u) {
+        throw std::runtime_error("Capture ring needs at least one slot");
+    }
+
+    const size_t size = kCaptureHeaderSize + static_cast<size_t>(slot_count) * slotSize();
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create capture file: " + path);
+    }
+
+    if (::posix_fallocate(fd, 0, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to preallocate capture file: " + path);
+    }
+
+    void *mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map capture file: " + path);
+    }
+
+    base_ = static_cast<uint8_t *>(mapping);
+    mapped_size_ = size;
+    path_ = path;
+    slot_count_ = slot_count;
+    truncated_ = 0u;
+
+    auto *header = new (base_) CaptureFileHeader {};
+    std::memcpy(header->magic, kCaptureMagic, sizeof(kCaptureMagic));
+    header->version = kCaptureVersion;
+    header->header_size = kCaptureHeaderSize;
+    header->slot_size = slotSize();
+    header->slot_count = slot_count;
+    header->max_payload = kCaptureMaxPayload;
+    header->interface_count = static_cast<uint32_t>(std::min<size_t>(interfaces.size(), kCaptureMaxInterfaces));
+    for (uint32_t idx = 0u; idx < header->interface_count; ++idx) {
+        header->interface_ips[idx] = interfaces[idx].ip;
+        std::strncpy(header->interface_names[idx], interfaces[idx].name.c_str(), sizeof(header->interface_names[idx]) - 1u);
+    }
+    header->head.store(0u, std::memory_order_release);
+
+    active_.store(true);
+}
+
+void PdRecorder::stop() {
+    active_.store(false);
+    while (writers_.load() != 0u) {
+        std::this_thread::yield();
+    }
+
+    if (base_ != nullptr) {
+        ::msync(base_, mapped_size_, MS_ASYNC);
+        ::munmap(base_, mapped_size_);
+        base_ = nullptr;
+        mapped_size_ = 0u;
+    }
+}
+
+void PdRecorder::append(const PdCaptureRecord &record) {
+    writers_.fetch_add(1u);
+    if (active_.load()) {
+        auto *header = reinterpret_cast<CaptureFileHeader *>(base_);
+        const uint64_t n = header->head.fetch_add(1u, std::memory_order_relaxed);
+        uint8_t *slot = base_ + kCaptureHeaderSize + (n % slot_count_) * static_cast<size_t>(header->slot_size);
+        auto *slotHeader = reinterpret_cast<CaptureSlotHeader *>(slot);
+
+        const uint32_t captured = std::min(record.payload_size, kCaptureMaxPayload);
+        if (captured < record.payload_size) {
+            truncated_.fetch_add(1u, std::memory_order_relaxed);
+        }
+
+        slotHeader->commit.store(2u * n + 1u, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slotHeader->timestamp_ns = record.timestamp_ns;
+        slotHeader->com_id = record.com_id;
+        slotHeader->seq_count = record.seq_count;
+        slotHeader->src_ip = record.src_ip;
+        slotHeader->dest_ip = record.dest_ip;
+        slotHeader->msg_type = record.msg_type;
+        slotHeader->interface_index = record.interface_index;
+        slotHeader->payload_size = static_cast<uint16_t>(std::min<uint32_t>(record.payload_size, 0xFFFFu));
+        slotHeader->captured_size = static_cast<uint16_t>(captured);
+        if (captured > 0u) {
+            std::memcpy(slot + sizeof(CaptureSlotHeader), record.payload, captured);
+        }
+        slotHeader->commit.store(2u * n + 2u, std::memory_order_release);
+    }
+    writers_.fetch_sub(1u);
+}
+
+PdCaptureStatus PdRecorder::status() const {
+    PdCaptureStatus status {};
+    status.active = active_.load();
+    status.path = path_;
+    status.slot_count = slot_count_;
+    status.truncated = truncated_.load(std::memory_order_relaxed);
+    if (status.active && base_ != nullptr) {
+        status.records = reinterpret_cast<const CaptureFileHeader *>(base_)->head.load(std::memory_order_relaxed);
+    }
+    return status;
+}
+
+PdCaptureReader::PdCaptureReader(const std::string &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open capture file: " + path);
+    }
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < kCaptureHeaderSize) {
+        ::close(fd);
+        throw std::runtime_error("Capture file is truncated: " + path);
+    }
+
+    void *mapping = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map capture file: " + path);
+    }
+
+    base_ = static_cast<const uint8_t *>(mapping);
+    mapped_size_ = static_cast<size_t>(info.st_size);
+
+    const auto *header = reinterpret_cast<const CaptureFileHeader *>(base_);
+    const size_t expected = kCaptureHeaderSize + static_cast<size_t>(header->slot_count) * header->slot_size;
+    if (std::memcmp(header->magic, kCaptureMagic, sizeof(kCaptureMagic)) != 0 || header->version != kCaptureVersion ||
+        header->slot_size < sizeof(CaptureSlotHeader) + header->max_payload || expected > mapped_size_ ||
+        header->interface_count > kCaptureMaxInterfaces) {
+        ::munmap(const_cast<uint8_t *>(base_), mapped_size_);
+        base_ = nullptr;
+        throw std::runtime_error("Not a webTRDP capture file: " + path);
+    }
+
+    for (uint32_t idx = 0u; idx < header->interface_count; ++idx) {
+        const char *name = header->interface_names[idx];
+        interfaces_.push_back(CaptureInterface {std::string(name, strnlen(name, sizeof(header->interface_names[idx]))),
+                                                header->interface_ips[idx]});
+    }
+}
+
+PdCaptureReader::~PdCaptureReader() {
+    if (base_ != nullptr) {
+        ::munmap(const_cast<uint8_t *>(base_), mapped_size_);
+    }
+}
+
+void PdCaptureReader::forEach(const std::function<void(const Entry &)> &visit) const {
+    const auto *header = reinterpret_cast<const CaptureFileHeader *>(base_);
+    const uint64_t head = header->head.load(std::memory_order_acquire);
+    // The file may still be written by a live recorder, so the payload is
+    // copied before the commit re-check, like PdChangeQueue::poll().
+    std::vector<uint8_t> scratch(header->max_payload);
+
+    for (uint64_t n = oldestRecord(head, header->slot_count); n < head; ++n) {
+        const uint8_t *slot = base_ + header->header_size + (n % header->slot_count) * static_cast<size_t>(header->slot_size);
+        const auto *slotHeader = reinterpret_cast<const CaptureSlotHeader *>(slot);
+
+        if (slotHeader->commit.load(std::memory_order_acquire) != 2u * n + 2u) {
+            continue;
+        }
+
+        Entry entry {};
+        entry.timestamp_ns = slotHeader->timestamp_ns;
+        entry.com_id = slotHeader->com_id;
+        entry.seq_count = slotHeader->seq_count;
+        entry.src_ip = slotHeader->src_ip;
+        entry.dest_ip = slotHeader->dest_ip;
+        entry.msg_type = slotHeader->msg_type;
+        entry.interface_index = slotHeader->interface_index;
+        entry.payload_size = slotHeader->payload_size;
+        entry.captured_size = std::min<uint32_t>(slotHeader->captured_size, header->max_payload);
+        if (entry.captured_size > 0u) {
+            std::memcpy(scratch.data(), slot + sizeof(CaptureSlotHeader), entry.captured_size);
+        }
+        entry.payload = scratch.data();
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slotHeader->commit.load(std::memory_order_relaxed) != 2u * n + 2u) {
+            continue;
+        }
+
+        visit(entry);
+    }
+}
+
+void exportPcapng(const PdCaptureReader &reader, std::ostream &out) {
+    writeSectionHeader(out);
+
+    const auto &interfaces = reader.interfaces();
+    for (const auto &iface : interfaces) {
+        writeInterfaceDescription(out, iface.name);
+    }
+    if (interfaces.empty()) {
+        writeInterfaceDescription(out, "trdp");
+    }
+
+    const auto interfaceCount = static_cast<uint32_t>(std::max<size_t>(interfaces.size(), 1u));
+
+    std::vector<uint8_t> packet;
+    reader.forEach([&](const PdCaptureReader::Entry &entry) {
+        buildPacket(entry, packet);
+
+        const uint32_t originalSize = 28u + kPdHeaderSize + entry.payload_size;
+        const auto length = static_cast<uint32_t>(32u + padded(packet.size()));
+
+        writeRaw<uint32_t>(out, 6u);
+        writeRaw<uint32_t>(out, length);
+        writeRaw<uint32_t>(out, entry.interface_index < interfaceCount ? entry.interface_index : 0u);
+        writeRaw<uint32_t>(out, static_cast<uint32_t>(entry.timestamp_ns >> 32u));
+        writeRaw<uint32_t>(out, static_cast<uint32_t>(entry.timestamp_ns));
+        writeRaw<uint32_t>(out, static_cast<uint32_t>(packet.size()));
+        writeRaw<uint32_t>(out, originalSize);
+        out.write(reinterpret_cast<const char *>(packet.data()), static_cast<std::streamsize>(packet.size()));
+        writePadding(out, packet.size());
+        writeRaw<uint32_t>(out, length);
+    });
+}
+
+}  // namespace trdp
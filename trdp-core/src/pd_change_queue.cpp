@@ -0,0 +1,43 @@
+#include "trdp/pd_change_queue.hpp"
+
+#include <algorithm>
+
+namespace trdp {
+namespace {
+
+size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1u;
+    while (result < value) {
+        result <<= 1u;
+    }
+    return result;
+}
+
+}  // namespace
+
+PdChangeQueue::PdChangeQueue(size_t capacity, size_t payload_size)
+    : mask_(roundUpPowerOfTwo(std::max<size_t>(capacity, 2u)) - 1u),
+      payload_size_(payload_size),
+      slots_(new Slot[mask_ + 1u]),
+      payload_(new uint8_t[(mask_ + 1u) * payload_size_]()) {}
+
+void PdChangeQueue::publish(uint32_t com_id, uint32_t src_ip, int64_t time_ns, const uint8_t *data, uint32_t size) {
+    const uint64_t seq = head_.fetch_add(1u, std::memory_order_acq_rel);
+    Slot &slot = slots_[seq & mask_];
+    const uint32_t stored = std::min<uint32_t>(size, static_cast<uint32_t>(payload_size_));
+
+    slot.seq.store(seq * 2u + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.time_ns = time_ns;
+    slot.com_id = com_id;
+    slot.src_ip = src_ip;
+    slot.size = stored;
+    if (stored > 0u && data != nullptr) {
+        std::memcpy(payload_.get() + (seq & mask_) * payload_size_, data, stored);
+    }
+
+    slot.seq.store(seq * 2u + 2u, std::memory_order_release);
+}
+
+}  // namespace trdp
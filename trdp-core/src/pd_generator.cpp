@@ -0,0 +1,191 @@
+#include "trdp/pd_generator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace trdp {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// xorshift64*: small state and cheap enough to run for every send.
+double nextUniform(uint64_t &state) {
+    state ^= state >> 12u;
+    state ^= state << 25u;
+    state ^= state >> 27u;
+    return static_cast<double>((state * 0x2545F4914F6CDD1Dull) >> 11u) * 0x1.0p-53;
+}
+
+void validate(const PdGeneratorSpec &spec) {
+    if (spec.max < spec.min) {
+        throw std::runtime_error("Generator max must not be below min");
+    }
+    switch (spec.kind) {
+        case GeneratorKind::Ramp:
+        case GeneratorKind::Sine:
+        case GeneratorKind::Square:
+            if (spec.period_us == 0u) {
+                throw std::runtime_error("Generator period must not be zero");
+            }
+            if (spec.kind == GeneratorKind::Square && (spec.duty < 0.0 || spec.duty > 1.0)) {
+                throw std::runtime_error("Square duty must be between 0 and 1");
+            }
+            break;
+        case GeneratorKind::Counter:
+        case GeneratorKind::RandomWalk:
+            break;
+        case GeneratorKind::Table:
+            if (spec.table.empty()) {
+                throw std::runtime_error("Table generator needs at least one value");
+            }
+            break;
+    }
+}
+
+}  // namespace
+
+GeneratorKind parseGeneratorKind(const std::string &text) {
+    if (text == "ramp") {
+        return GeneratorKind::Ramp;
+    }
+    if (text == "sine") {
+        return GeneratorKind::Sine;
+    }
+    if (text == "square") {
+        return GeneratorKind::Square;
+    }
+    if (text == "counter") {
+        return GeneratorKind::Counter;
+    }
+    if (text == "random_walk") {
+        return GeneratorKind::RandomWalk;
+    }
+    if (text == "table") {
+        return GeneratorKind::Table;
+    }
+    throw std::runtime_error("Unknown generator kind: " + text);
+}
+
+const char *generatorKindToString(GeneratorKind kind) {
+    switch (kind) {
+        case GeneratorKind::Ramp:
+            return "ramp";
+        case GeneratorKind::Sine:
+            return "sine";
+        case GeneratorKind::Square:
+            return "square";
+        case GeneratorKind::Counter:
+            return "counter";
+        case GeneratorKind::RandomWalk:
+            return "random_walk";
+        case GeneratorKind::Table:
+            return "table";
+    }
+    return "?";
+}
+
+void PdGeneratorTable::reset(size_t slot_count) {
+    slots_.clear();
+    slots_.resize(slot_count);
+}
+
+uint64_t PdGeneratorTable::add(const PdGeneratorSpec &spec, const DatasetLayout &layout, uint32_t tx_slot,
+                               std::chrono::steady_clock::time_point start) {
+    if (tx_slot >= slots_.size()) {
+        throw std::runtime_error("PD telegram is not sent");
+    }
+    const FieldLayout *field = layout.findField(spec.field);
+    if (field == nullptr) {
+        throw std::runtime_error("Unknown dataset field: " + spec.field);
+    }
+    validate(spec);
+
+    Generator generator {};
+    generator.id = next_id_++;
+    generator.spec = spec;
+    generator.field = *field;
+    generator.start = start;
+    generator.current = spec.kind == GeneratorKind::RandomWalk ? (spec.min + spec.max) / 2.0 : spec.min;
+    // A zero state would stay zero forever.
+    generator.rng = spec.seed != 0u ? spec.seed : 0x9E3779B97F4A7C15ull;
+    slots_[tx_slot].push_back(std::move(generator));
+    return slots_[tx_slot].back().id;
+}
+
+bool PdGeneratorTable::remove(uint64_t id) {
+    for (auto &slot : slots_) {
+        const auto it = std::find_if(slot.begin(), slot.end(),
+                                     [id](const Generator &generator) { return generator.id == id; });
+        if (it != slot.end()) {
+            slot.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<PdGeneratorStatus> PdGeneratorTable::status() const {
+    std::vector<PdGeneratorStatus> result;
+    for (const auto &slot : slots_) {
+        for (const auto &generator : slot) {
+            result.push_back({generator.id, generator.spec, generator.evaluations, generator.last_value});
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [](const PdGeneratorStatus &lhs, const PdGeneratorStatus &rhs) { return lhs.id < rhs.id; });
+    return result;
+}
+
+void PdGeneratorTable::apply(uint32_t tx_slot, uint8_t *payload, std::chrono::steady_clock::time_point when) {
+    for (auto &generator : slots_[tx_slot]) {
+        const double value = evaluate(generator, when);
+        uint8_t *dst = payload + generator.field.offset;
+        for (uint32_t idx = 0u; idx < generator.field.array_size; ++idx) {
+            encodeElement(dst, generator.field.type, value);
+            dst += generator.field.element_size;
+        }
+    }
+}
+
+double PdGeneratorTable::evaluate(Generator &generator, std::chrono::steady_clock::time_point when) {
+    const PdGeneratorSpec &spec = generator.spec;
+    const double span = spec.max - spec.min;
+    const double period = static_cast<double>(spec.period_us);
+    const double elapsedUs = std::max(0.0, std::chrono::duration<double, std::micro>(when - generator.start).count());
+
+    double value = spec.min;
+    switch (spec.kind) {
+        case GeneratorKind::Ramp:
+            value = spec.min + span * (std::fmod(elapsedUs, period) / period);
+            break;
+        case GeneratorKind::Sine:
+            value = spec.min + span * 0.5 * (1.0 + std::sin(2.0 * kPi * elapsedUs / period + spec.phase_deg * kPi / 180.0));
+            break;
+        case GeneratorKind::Square:
+            value = std::fmod(elapsedUs, period) < spec.duty * period ? spec.max : spec.min;
+            break;
+        case GeneratorKind::Counter:
+            value = generator.current;
+            generator.current += spec.step;
+            if (span > 0.0 && generator.current > spec.max) {
+                generator.current = spec.min;
+            }
+            break;
+        case GeneratorKind::RandomWalk:
+            generator.current += spec.step * (2.0 * nextUniform(generator.rng) - 1.0);
+            generator.current = std::min(spec.max, std::max(spec.min, generator.current));
+            value = generator.current;
+            break;
+        case GeneratorKind::Table:
+            value = spec.table[generator.table_index];
+            generator.table_index = (generator.table_index + 1u) % spec.table.size();
+            break;
+    }
+
+    generator.evaluations++;
+    generator.last_value = value;
+    return value;
+}
+
+}  // namespace trdp
@@ -0,0 +1,130 @@
+#include "trdp/pd_history.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace trdp {
+namespace {
+
+std::vector<SeriesPoint> minMaxBuckets(const std::vector<SeriesPoint> &points, size_t max_points) {
+    std::vector<SeriesPoint> result;
+    const size_t buckets = std::max<size_t>(max_points / 2u, 1u);
+    result.reserve(buckets * 2u);
+
+    for (size_t bucket = 0u; bucket < buckets; ++bucket) {
+        const size_t begin = bucket * points.size() / buckets;
+        const size_t end = (bucket + 1u) * points.size() / buckets;
+        if (begin == end) {
+            continue;
+        }
+
+        const auto bounds = std::minmax_element(points.begin() + static_cast<std::ptrdiff_t>(begin),
+                                                points.begin() + static_cast<std::ptrdiff_t>(end),
+                                                [](const SeriesPoint &a, const SeriesPoint &b) { return a.value < b.value; });
+        const SeriesPoint &low = *bounds.first;
+        const SeriesPoint &high = *bounds.second;
+
+        if (bounds.first == bounds.second) {
+            result.push_back(low);
+        } else if (low.t_us <= high.t_us) {
+            result.push_back(low);
+            result.push_back(high);
+        } else {
+            result.push_back(high);
+            result.push_back(low);
+        }
+    }
+
+    return result;
+}
+
+// Largest-Triangle-Three-Buckets (Steinarsson, 2013).
+std::vector<SeriesPoint> lttb(const std::vector<SeriesPoint> &points, size_t max_points) {
+    if (max_points < 3u) {
+        return {points.front(), points.back()};
+    }
+
+    std::vector<SeriesPoint> result;
+    result.reserve(max_points);
+    result.push_back(points.front());
+
+    const double every = static_cast<double>(points.size() - 2u) / static_cast<double>(max_points - 2u);
+    size_t selected = 0u;
+
+    for (size_t bucket = 0u; bucket < max_points - 2u; ++bucket) {
+        const auto nextBegin = static_cast<size_t>(std::floor(static_cast<double>(bucket + 1u) * every)) + 1u;
+        const auto nextEnd = std::min(static_cast<size_t>(std::floor(static_cast<double>(bucket + 2u) * every)) + 1u,
+                                      points.size());
+
+        double avgT = 0.0;
+        double avgV = 0.0;
+        for (size_t idx = nextBegin; idx < nextEnd; ++idx) {
+            avgT += static_cast<double>(points[idx].t_us);
+            avgV += points[idx].value;
+        }
+        const auto nextCount = static_cast<double>(std::max<size_t>(nextEnd - nextBegin, 1u));
+        avgT /= nextCount;
+        avgV /= nextCount;
+
+        const auto begin = static_cast<size_t>(std::floor(static_cast<double>(bucket) * every)) + 1u;
+        const auto end = std::min(nextBegin, points.size() - 1u);
+        const SeriesPoint &anchor = points[selected];
+
+        double bestArea = -1.0;
+        size_t best = begin;
+        for (size_t idx = begin; idx < end; ++idx) {
+            const double area = std::fabs((static_cast<double>(anchor.t_us) - avgT) * (points[idx].value - anchor.value) -
+                                          (static_cast<double>(anchor.t_us - points[idx].t_us)) * (avgV - anchor.value));
+            if (area > bestArea) {
+                bestArea = area;
+                best = idx;
+            }
+        }
+
+        result.push_back(points[best]);
+        selected = best;
+    }
+
+    result.push_back(points.back());
+    return result;
+}
+
+}  // namespace
+
+void PdHistory::reset(size_t capacity, size_t payload_size) {
+    capacity_ = capacity;
+    payload_size_ = payload_size;
+    head_ = 0u;
+    count_ = 0u;
+    times_us_.assign(capacity, 0);
+    sizes_.assign(capacity, 0u);
+    data_.assign(capacity * payload_size, 0u);
+}
+
+void PdHistory::push(std::chrono::steady_clock::time_point time, const uint8_t *data, size_t size) {
+    if (capacity_ == 0u) {
+        return;
+    }
+
+    const size_t stored = std::min(size, payload_size_);
+    uint8_t *slot = data_.data() + head_ * payload_size_;
+    if (stored > 0u) {
+        std::memcpy(slot, data, stored);
+    }
+
+    times_us_[head_] = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+    sizes_[head_] = static_cast<uint32_t>(stored);
+    head_ = (head_ + 1u) % capacity_;
+    count_ = std::min(count_ + 1u, capacity_);
+}
+
+std::vector<SeriesPoint> downsample(const std::vector<SeriesPoint> &points, size_t max_points, DownsampleMode mode) {
+    if (max_points == 0u || points.size() <= max_points) {
+        return points;
+    }
+
+    return mode == DownsampleMode::Lttb ? lttb(points, max_points) : minMaxBuckets(points, max_points);
+}
+
+}  // namespace trdp
@@ -0,0 +1,25 @@
+#include "trdp/pd_loopback.hpp"
+
+namespace trdp {
+
+void PdLoopback::send(const PdState &sender, uint32_t com_id, uint32_t seq_count, const uint8_t *data, uint32_t size) {
+    const auto offset = static_cast<uint32_t>(queued_.bytes.size());
+    if (size > 0u) {
+        queued_.bytes.insert(queued_.bytes.end(), data, data + size);
+    }
+    queued_.packets.push_back(Packet {&sender, com_id, seq_count, offset, size});
+}
+
+void PdLoopback::drain(Batch &batch) {
+    batch.packets.clear();
+    batch.bytes.clear();
+    batch.packets.swap(queued_.packets);
+    batch.bytes.swap(queued_.bytes);
+}
+
+void PdLoopback::clear() {
+    queued_.packets.clear();
+    queued_.bytes.clear();
+}
+
+}  // namespace trdp
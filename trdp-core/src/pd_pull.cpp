@@ -0,0 +1,154 @@
+#include "trdp/pd_pull.hpp"
+
+#include <algorithm>
+
+namespace trdp {
+
+PdPullTable::Stats::Stats()
+    : rtt_us({100.0, 250.0, 500.0, 1000.0, 2500.0, 5000.0, 10000.0, 25000.0, 50000.0, 100000.0, 250000.0, 500000.0,
+              1000000.0}) {}
+
+uint64_t PdPullTable::add(const PdPullOptions &options, TRDP_IP_ADDR_T dest_ip, TRDP_APP_SESSION_T appHandle,
+                          TRDP_SUB_T subHandle, Clock::time_point start) {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    Job job {};
+    job.id = next_id_++;
+    job.options = options;
+    job.dest_ip = dest_ip;
+    job.appHandle = appHandle;
+    job.subHandle = subHandle;
+    job.next_due = start;
+    job.remaining = options.count;
+    job.active = true;
+    job.stats = &stats(options.com_id);
+    jobs_.push_back(std::move(job));
+    return jobs_.back().id;
+}
+
+bool PdPullTable::remove(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    const auto it = std::find_if(jobs_.begin(), jobs_.end(), [id](const Job &job) { return job.id == id; });
+    if (it == jobs_.end()) {
+        return false;
+    }
+    jobs_.erase(it);
+    return true;
+}
+
+void PdPullTable::clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    jobs_.clear();
+}
+
+std::vector<PdPullSend> PdPullTable::collectDue(Clock::time_point now) {
+    std::vector<PdPullSend> due;
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto &job : jobs_) {
+        expire(job, now);
+
+        if (!job.active || now < job.next_due) {
+            continue;
+        }
+
+        due.push_back(PdPullSend {job.id, job.options.com_id, job.options.reply_com_id, job.dest_ip, job.appHandle,
+                                  job.subHandle});
+        job.outstanding.push_back(now);
+        job.sent++;
+        job.stats->requests.add();
+
+        const auto interval = std::chrono::microseconds(job.options.interval_us);
+        job.next_due += interval;
+        // After a stall, resume on the timeline instead of bursting to catch up.
+        if (job.next_due <= now) {
+            job.next_due += interval * ((now - job.next_due) / interval + 1);
+        }
+
+        if (job.remaining > 0u && --job.remaining == 0u) {
+            job.active = false;
+        }
+    }
+
+    return due;
+}
+
+void PdPullTable::markFailed(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    for (auto &job : jobs_) {
+        if (job.id == id && !job.outstanding.empty()) {
+            job.outstanding.pop_back();
+            job.errors++;
+            return;
+        }
+    }
+}
+
+bool PdPullTable::matchReply(TRDP_APP_SESSION_T appHandle, uint32_t com_id, TRDP_IP_ADDR_T src_ip, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    for (auto &job : jobs_) {
+        if (job.appHandle != appHandle || job.options.reply_com_id != com_id || job.dest_ip != src_ip) {
+            continue;
+        }
+
+        expire(job, now);
+        if (job.outstanding.empty()) {
+            continue;
+        }
+
+        const double rttUs = std::chrono::duration<double, std::micro>(now - job.outstanding.front()).count();
+        job.outstanding.pop_front();
+        job.replies++;
+        job.stats->replies.add();
+        job.stats->rtt_us.observe(rttUs);
+        return true;
+    }
+
+    return false;
+}
+
+std::vector<PdPullStatus> PdPullTable::status() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    std::vector<PdPullStatus> result;
+    result.reserve(jobs_.size());
+    for (const auto &job : jobs_) {
+        result.push_back(PdPullStatus {job.id, job.options, job.active, job.sent, job.replies, job.timeouts, job.errors,
+                                       job.outstanding.size()});
+    }
+    return result;
+}
+
+std::vector<PdPullStatsSnapshot> PdPullTable::statsSnapshot() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    std::vector<PdPullStatsSnapshot> result;
+    result.reserve(stats_.size());
+    for (const auto &entry : stats_) {
+        result.push_back(PdPullStatsSnapshot {entry.first, entry.second->requests.value(), entry.second->replies.value(),
+                                              entry.second->timeouts.value(), entry.second->rtt_us.snapshot()});
+    }
+    return result;
+}
+
+PdPullTable::Stats &PdPullTable::stats(uint32_t com_id) {
+    auto &slot = stats_[com_id];
+    if (!slot) {
+        slot = std::make_unique<Stats>();
+    }
+    return *slot;
+}
+
+void PdPullTable::expire(Job &job, Clock::time_point now) {
+    const auto timeout = std::chrono::microseconds(job.options.timeout_us);
+    while (!job.outstanding.empty() && now - job.outstanding.front() > timeout) {
+        job.outstanding.pop_front();
+        job.timeouts++;
+        job.stats->timeouts.add();
+    }
+}
+
+}  // namespace trdp
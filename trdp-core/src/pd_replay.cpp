@@ -0,0 +1,134 @@
+#include "trdp/pd_replay.hpp"
+
+#include "trdp/pd_capture.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace trdp {
+
+PdReplayer::~PdReplayer() { stop(); }
+
+void PdReplayer::start(const ReplayOptions &options, ReplaySink sink, ReplayHooks hooks) {
+    if (!(options.speed > 0.0)) {
+        throw std::runtime_error("Replay speed must be greater than zero");
+    }
+
+    stop();
+
+    PdCaptureReader reader(options.path);
+
+    interface_names_.clear();
+    for (const auto &iface : reader.interfaces()) {
+        interface_names_.push_back(iface.name);
+    }
+
+    records_.clear();
+    payloads_.clear();
+    reader.forEach([&](const PdCaptureReader::Entry &entry) {
+        if (!options.com_ids.empty() && options.com_ids.count(entry.com_id) == 0u) {
+            return;
+        }
+        if (entry.interface_index >= interface_names_.size()) {
+            return;
+        }
+        if (!options.interfaces.empty() && options.interfaces.count(interface_names_[entry.interface_index]) == 0u) {
+            return;
+        }
+
+        records_.push_back(Record {entry.timestamp_ns, entry.com_id, entry.interface_index, payloads_.size(),
+                                   entry.captured_size});
+        payloads_.insert(payloads_.end(), entry.payload, entry.payload + entry.captured_size);
+    });
+
+    std::set<std::pair<uint32_t, uint32_t>> seen;
+    std::vector<ReplayTelegram> telegrams;
+    for (const auto &record : records_) {
+        if (seen.emplace(record.com_id, record.interface_index).second) {
+            telegrams.push_back(ReplayTelegram {record.com_id, interface_names_[record.interface_index]});
+        }
+    }
+
+    options_ = options;
+    sink_ = std::move(sink);
+    hooks_ = std::move(hooks);
+    if (hooks_.begin) {
+        hooks_.begin(telegrams);
+    }
+    sent_ = 0u;
+    skipped_ = 0u;
+    max_lateness_us_ = 0.0;
+    stop_requested_ = false;
+    active_ = true;
+    thread_ = std::thread(&PdReplayer::run, this);
+}
+
+void PdReplayer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_requested_ = true;
+    }
+    wake_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    active_ = false;
+}
+
+ReplayStatus PdReplayer::status() const {
+    ReplayStatus status {};
+    status.active = active_.load();
+    status.path = options_.path;
+    status.speed = options_.speed;
+    status.total = records_.size();
+    status.sent = sent_.load();
+    status.skipped = skipped_.load();
+    status.max_lateness_us = max_lateness_us_.load();
+    return status;
+}
+
+void PdReplayer::run() {
+    runRecords();
+    if (hooks_.end) {
+        hooks_.end();
+    }
+    active_ = false;
+}
+
+void PdReplayer::runRecords() {
+    if (records_.empty()) {
+        return;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const uint64_t firstNs = records_.front().timestamp_ns;
+
+    for (const auto &record : records_) {
+        // Wall-clock capture stamps can step backwards; never schedule before start.
+        const uint64_t elapsedNs = record.timestamp_ns > firstNs ? record.timestamp_ns - firstNs : 0u;
+        const auto offsetNs = static_cast<double>(elapsedNs) / options_.speed;
+        const auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::nano>(offsetNs));
+
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            if (wake_.wait_until(lock, deadline, [this] { return stop_requested_; })) {
+                break;
+            }
+        }
+
+        const double latenessUs = std::chrono::duration<double, std::micro>(Clock::now() - deadline).count();
+        if (latenessUs > max_lateness_us_.load(std::memory_order_relaxed)) {
+            max_lateness_us_.store(latenessUs, std::memory_order_relaxed);
+        }
+
+        if (sink_(record.com_id, interface_names_[record.interface_index], payloads_.data() + record.offset, record.size)) {
+            sent_++;
+        } else {
+            skipped_++;
+        }
+    }
+}
+
+}  // namespace trdp
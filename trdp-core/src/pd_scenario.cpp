@@ -0,0 +1,167 @@
+#include "trdp/pd_scenario.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace trdp {
+namespace {
+
+[[noreturn]] void fail(uint32_t line, const std::string &message) {
+    throw std::runtime_error("Scenario line " + std::to_string(line) + ": " + message);
+}
+
+uint64_t parseOffset(const std::string &token, uint32_t line) {
+    size_t used = 0u;
+    double value = 0.0;
+    try {
+        value = std::stod(token, &used);
+    } catch (const std::exception &) {
+        fail(line, "invalid offset '" + token + "'");
+    }
+
+    const std::string unit = token.substr(used);
+    double scale = 1.0;
+    if (unit == "ms") {
+        scale = 1000.0;
+    } else if (unit == "s") {
+        scale = 1000000.0;
+    } else if (!unit.empty() && unit != "us") {
+        fail(line, "unknown offset unit '" + unit + "'");
+    }
+    if (!(value >= 0.0)) {
+        fail(line, "offset must not be negative");
+    }
+    return static_cast<uint64_t>(std::llround(value * scale));
+}
+
+void parseTarget(const std::string &token, ScenarioStep &step) {
+    const auto at = token.find('@');
+    try {
+        step.com_id = static_cast<uint32_t>(std::stoul(token.substr(0u, at)));
+    } catch (const std::exception &) {
+        fail(step.line, "invalid comId '" + token + "'");
+    }
+    if (at != std::string::npos) {
+        step.host_name = token.substr(at + 1u);
+    }
+}
+
+std::vector<std::string> splitHosts(const std::string &token) {
+    std::vector<std::string> hosts;
+    std::stringstream stream(token);
+    std::string host;
+    while (std::getline(stream, host, ',')) {
+        if (!host.empty()) {
+            hosts.push_back(host);
+        }
+    }
+    return hosts;
+}
+
+}  // namespace
+
+Scenario parseScenario(std::istream &input) {
+    Scenario scenario {};
+    bool explicitEnd = false;
+    std::string text;
+    uint32_t lineNo = 0u;
+
+    while (std::getline(input, text)) {
+        lineNo++;
+        const auto hash = text.find('#');
+        if (hash != std::string::npos) {
+            text.erase(hash);
+        }
+
+        std::istringstream tokens(text);
+        std::string offset;
+        if (!(tokens >> offset)) {
+            continue;
+        }
+
+        ScenarioStep step {};
+        step.line = lineNo;
+        step.offset_us = parseOffset(offset, lineNo);
+
+        std::string action;
+        if (!(tokens >> action)) {
+            fail(lineNo, "missing action");
+        }
+
+        std::string target;
+        if (action == "set" || action == "enable" || action == "disable") {
+            if (!(tokens >> target)) {
+                fail(lineNo, "missing comId");
+            }
+            parseTarget(target, step);
+        }
+
+        if (action == "set") {
+            step.action = ScenarioAction::Set;
+            std::string assignment;
+            while (tokens >> assignment) {
+                const auto eq = assignment.find('=');
+                if (eq == std::string::npos || eq == 0u) {
+                    fail(lineNo, "expected field=value, got '" + assignment + "'");
+                }
+                try {
+                    step.values.emplace_back(assignment.substr(0u, eq), std::stod(assignment.substr(eq + 1u)));
+                } catch (const std::exception &) {
+                    fail(lineNo, "invalid value in '" + assignment + "'");
+                }
+            }
+            if (step.values.empty()) {
+                fail(lineNo, "set needs at least one field=value");
+            }
+        } else if (action == "enable") {
+            step.action = ScenarioAction::Enable;
+        } else if (action == "disable") {
+            step.action = ScenarioAction::Disable;
+        } else if (action == "load") {
+            step.action = ScenarioAction::Load;
+            if (!(tokens >> step.path)) {
+                fail(lineNo, "load needs a configuration path");
+            }
+            std::string hosts;
+            if (tokens >> hosts) {
+                step.host_names = splitHosts(hosts);
+            }
+        } else if (action == "end") {
+            scenario.length_us = step.offset_us;
+            explicitEnd = true;
+            continue;
+        } else {
+            fail(lineNo, "unknown action '" + action + "'");
+        }
+
+        std::string extra;
+        if (step.action != ScenarioAction::Set && (tokens >> extra)) {
+            fail(lineNo, "unexpected '" + extra + "'");
+        }
+        scenario.steps.push_back(std::move(step));
+    }
+
+    std::stable_sort(scenario.steps.begin(), scenario.steps.end(),
+                     [](const ScenarioStep &lhs, const ScenarioStep &rhs) { return lhs.offset_us < rhs.offset_us; });
+
+    const uint64_t lastOffset = scenario.steps.empty() ? 0u : scenario.steps.back().offset_us;
+    if (!explicitEnd) {
+        scenario.length_us = lastOffset;
+    } else if (scenario.length_us < lastOffset) {
+        throw std::runtime_error("Scenario end lies before its last step");
+    }
+    return scenario;
+}
+
+Scenario loadScenarioFile(const std::string &path) {
+    std::ifstream input(path);
+    if (!input.is_open()) {
+        throw std::runtime_error("Failed to open scenario: " + path);
+    }
+    return parseScenario(input);
+}
+
+}  // namespace trdp
@@ -0,0 +1,200 @@
+#include "trdp/pd_shm.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trdp {
+namespace {
+
+constexpr char kShmMagic[8] = {'W', 'T', 'R', 'D', 'P', 'S', 'H', 'M'};
+
+static_assert(sizeof(ShmFileHeader) <= kShmHeaderSize, "shm header must fit in the header page");
+
+uint64_t align64(uint64_t offset) { return (offset + 63u) & ~static_cast<uint64_t>(63u); }
+
+int64_t steadyNs(std::chrono::steady_clock::time_point time) {
+    if (time.time_since_epoch().count() == 0) {
+        return 0;
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+template <size_t N>
+void copyName(char (&dest)[N], const std::string &src) {
+    std::strncpy(dest, src.c_str(), N - 1u);
+}
+
+// Odd while the record is being written; see the read protocol in pd_shm.hpp.
+uint32_t beginWrite(ShmSlot &slot) {
+    const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return seq;
+}
+
+void endWrite(ShmSlot &slot, uint32_t seq) { slot.seq.store(seq + 2u, std::memory_order_release); }
+
+}  // namespace
+
+PdShmExport::~PdShmExport() { close(); }
+
+void PdShmExport::open(const std::string &name, const std::vector<PdState> &states, uint64_t generation) {
+    close();
+
+    if (name.empty()) {
+        throw std::runtime_error("Shared memory export needs a name");
+    }
+    const std::string shmName = name.front() == '/' ? name : "/" + name;
+
+    const auto slotCount = static_cast<uint32_t>(states.size());
+    uint64_t size = kShmHeaderSize + static_cast<uint64_t>(slotCount) * kShmSlotSize;
+    std::vector<uint64_t> rxOffsets(states.size());
+    std::vector<uint64_t> txOffsets(states.size());
+    for (size_t idx = 0u; idx < states.size(); ++idx) {
+        rxOffsets[idx] = size = align64(size);
+        size += states[idx].rx_capacity;
+        txOffsets[idx] = size = align64(size);
+        size += states[idx].tx_capacity;
+    }
+    size = align64(size);
+
+    // Readers still holding a previous segment keep their mapping; the name
+    // only ever refers to a fully initialised one.
+    ::shm_unlink(shmName.c_str());
+    const int fd = ::shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create shared memory segment: " + shmName);
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        ::shm_unlink(shmName.c_str());
+        throw std::runtime_error("Failed to size shared memory segment: " + shmName);
+    }
+
+    void *mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ::shm_unlink(shmName.c_str());
+        throw std::runtime_error("Failed to map shared memory segment: " + shmName);
+    }
+
+    base_ = static_cast<uint8_t *>(mapping);
+    mapped_size_ = size;
+    name_ = shmName;
+    slot_count_ = slotCount;
+    generation_ = generation;
+
+    for (uint32_t idx = 0u; idx < slotCount; ++idx) {
+        const PdState &state = states[idx];
+        auto *record = new (slot(idx)) ShmSlot {};
+        record->com_id = state.def->com_id;
+        record->dataset_id = state.def->dataset_id;
+        record->direction = static_cast<uint8_t>(state.def->direction);
+        copyName(record->name, state.def->name);
+        copyName(record->interface_name, state.def->interface_name);
+        copyName(record->host_name, state.def->host_name);
+        record->rx_offset = rxOffsets[idx];
+        record->tx_offset = txOffsets[idx];
+        record->rx_capacity = state.rx_capacity;
+        record->tx_capacity = state.tx_capacity;
+    }
+
+    auto *header = new (base_) ShmFileHeader {};
+    header->version = kShmVersion;
+    header->header_size = kShmHeaderSize;
+    header->slot_size = kShmSlotSize;
+    header->slot_count = slotCount;
+    header->segment_size = size;
+    header->generation = generation;
+    header->created_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    // The magic goes in last so a reader that sees it sees the whole table.
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, kShmMagic, sizeof(kShmMagic));
+}
+
+void PdShmExport::close() {
+    if (base_ == nullptr) {
+        return;
+    }
+
+    reinterpret_cast<ShmFileHeader *>(base_)->retired.store(1u, std::memory_order_release);
+    ::munmap(base_, mapped_size_);
+    ::shm_unlink(name_.c_str());
+    base_ = nullptr;
+    mapped_size_ = 0u;
+    slot_count_ = 0u;
+}
+
+PdShmStatus PdShmExport::status() const {
+    PdShmStatus status {};
+    status.active = active();
+    status.name = name_;
+    status.slot_count = slot_count_;
+    status.size = mapped_size_;
+    status.generation = generation_;
+    return status;
+}
+
+ShmSlot *PdShmExport::slot(uint32_t index) const {
+    return reinterpret_cast<ShmSlot *>(base_ + kShmHeaderSize + static_cast<size_t>(index) * kShmSlotSize);
+}
+
+void PdShmExport::writeRx(uint32_t index, const PdState &state, bool timed_out) {
+    if (base_ == nullptr || index >= slot_count_) {
+        return;
+    }
+
+    ShmSlot &record = *slot(index);
+    const uint32_t seq = beginWrite(record);
+    record.rx_size = std::min(state.rx_size, record.rx_capacity);
+    if (record.rx_size > 0u) {
+        std::memcpy(base_ + record.rx_offset, state.rx_payload, record.rx_size);
+    }
+    record.last_src_ip = state.last_src_ip;
+    record.last_seq_count = state.last_seq;
+    record.rx_count = state.rx_count;
+    record.change_count = state.change_count;
+    record.timeout_count = state.timeout_count;
+    record.rx_lost = state.metrics->rx_lost.value();
+    record.rx_duplicates = state.metrics->rx_duplicates.value();
+    record.last_rx_ns = steadyNs(state.last_rx_time);
+    record.last_change_ns = steadyNs(state.last_change_time);
+    uint8_t flags = record.flags & kShmTxEnabled;
+    if (state.last_rx_valid) {
+        flags |= kShmRxValid;
+    }
+    if (timed_out) {
+        flags |= kShmTimedOut;
+    }
+    record.flags = flags;
+    endWrite(record, seq);
+}
+
+void PdShmExport::writeTx(uint32_t index, const PdState &state, const PdTxSlot &tx,
+                          std::chrono::steady_clock::time_point when) {
+    if (base_ == nullptr || index >= slot_count_) {
+        return;
+    }
+
+    ShmSlot &record = *slot(index);
+    const uint32_t seq = beginWrite(record);
+    record.tx_size = std::min(state.tx_size, record.tx_capacity);
+    if (record.tx_size > 0u) {
+        std::memcpy(base_ + record.tx_offset, state.tx_payload, record.tx_size);
+    }
+    record.tx_count = tx.tx_count;
+    record.tx_missed_cycles = tx.missed_cycles;
+    record.last_tx_ns = steadyNs(when);
+    record.flags = static_cast<uint8_t>(tx.enabled ? (record.flags | kShmTxEnabled) : (record.flags & ~kShmTxEnabled));
+    endWrite(record, seq);
+}
+
+}  // namespace trdp
@@ -0,0 +1,116 @@
+#include "trdp/pd_source.hpp"
+
+namespace trdp {
+
+SeqOutcome PdSeqTracker::track(uint32_t seq, uint32_t &burst) {
+    burst = 0u;
+    if (!valid) {
+        valid = true;
+        last_seq = seq;
+        window = 1u;
+        return SeqOutcome::First;
+    }
+
+    // Unsigned wrap-around: ahead < 2^31 means the counter moved forward.
+    const uint32_t ahead = seq - last_seq;
+    if (ahead == 0u) {
+        duplicates++;
+        return SeqOutcome::Duplicate;
+    }
+
+    if (ahead < 0x80000000u) {
+        window = ahead < kWindow ? (window << ahead) | 1u : 1u;
+        last_seq = seq;
+        if (ahead == 1u) {
+            return SeqOutcome::InOrder;
+        }
+        burst = ahead - 1u;
+        lost += burst;
+        if (burst > longest_burst) {
+            longest_burst = burst;
+        }
+        return SeqOutcome::Gap;
+    }
+
+    const uint32_t behind = last_seq - seq;
+    if (behind < kWindow) {
+        const uint64_t bit = uint64_t {1u} << behind;
+        if ((window & bit) != 0u) {
+            duplicates++;
+            return SeqOutcome::Duplicate;
+        }
+        window |= bit;
+        reordered++;
+        if (lost > 0u) {
+            lost--;
+        }
+        return SeqOutcome::Reordered;
+    }
+
+    resets++;
+    last_seq = seq;
+    window = 1u;
+    return SeqOutcome::Reset;
+}
+
+void PdSourceSet::expect(uint32_t src_ip) { lookup(src_ip).configured = true; }
+
+PdSource &PdSourceSet::lookup(uint32_t src_ip) {
+    for (uint8_t idx = 0u; idx < count_; ++idx) {
+        if (sources_[idx].src_ip == src_ip) {
+            return sources_[idx];
+        }
+    }
+
+    // When full, the source heard from least recently gives up its slot;
+    // the active one is kept.
+    int slot = count_;
+    if (count_ < kPdMaxSources) {
+        count_++;
+    } else {
+        slot = -1;
+        for (int idx = 0; idx < static_cast<int>(kPdMaxSources); ++idx) {
+            if (idx != active_ && (slot < 0 || sources_[idx].last_rx_time < sources_[slot].last_rx_time)) {
+                slot = idx;
+            }
+        }
+        evicted_++;
+    }
+
+    sources_[slot] = PdSource {};
+    sources_[slot].src_ip = src_ip;
+    return sources_[slot];
+}
+
+bool PdSourceSet::receive(PdSource &source, std::chrono::steady_clock::time_point now, std::chrono::nanoseconds hold,
+                          PdSwitchover &switched) {
+    if (source.rx_count > 0u) {
+        source.last_period_us =
+            std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(now - source.last_rx_time).count();
+        source.avg_period_us += (source.last_period_us - source.avg_period_us) / static_cast<double>(source.rx_count);
+    }
+    source.last_rx_time = now;
+    source.rx_count++;
+
+    const auto index = static_cast<int8_t>(&source - sources_.data());
+    if (index == active_) {
+        return false;
+    }
+    if (active_ < 0) {
+        active_ = index;
+        return false;
+    }
+
+    const PdSource &current = sources_[static_cast<size_t>(active_)];
+    const auto silence = now - current.last_rx_time;
+    if (silence <= hold) {
+        return false;
+    }
+
+    switched = PdSwitchover {current.src_ip, source.src_ip,
+                             std::chrono::duration_cast<std::chrono::nanoseconds>(silence).count()};
+    active_ = index;
+    return true;
+}
+
+}  // namespace trdp
@@ -0,0 +1,34 @@
+#include "trdp/pd_state.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace trdp {
+
+size_t PayloadArena::footprint(size_t size) { return (size + 7u) & ~static_cast<size_t>(7u); }
+
+void PayloadArena::reset(size_t capacity) {
+    storage_.reset(capacity > 0u ? new uint8_t[capacity] : nullptr);
+    if (capacity > 0u) {
+        std::memset(storage_.get(), 0, capacity);
+    }
+    capacity_ = capacity;
+    used_ = 0u;
+}
+
+uint8_t *PayloadArena::carve(size_t size) {
+    if (size == 0u) {
+        return nullptr;
+    }
+
+    const size_t needed = footprint(size);
+    if (needed > capacity_ - used_) {
+        throw std::runtime_error("PD payload arena exhausted");
+    }
+
+    uint8_t *slice = storage_.get() + used_;
+    used_ += needed;
+    return slice;
+}
+
+}  // namespace trdp
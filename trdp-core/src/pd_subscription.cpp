@@ -0,0 +1,52 @@
+#include "trdp/pd_subscription.hpp"
+
+#include <algorithm>
+
+namespace trdp {
+
+uint64_t PdSubscriberTable::add(uint32_t com_id, PdRxCallback callback) {
+    const uint64_t id = next_id_++;
+    by_com_id_[com_id].push_back(Entry {id, std::move(callback)});
+    count_++;
+    return id;
+}
+
+bool PdSubscriberTable::remove(uint64_t id) {
+    for (auto it = by_com_id_.begin(); it != by_com_id_.end(); ++it) {
+        auto &entries = it->second;
+        const auto entry =
+            std::find_if(entries.begin(), entries.end(), [id](const Entry &candidate) { return candidate.id == id; });
+        if (entry == entries.end()) {
+            continue;
+        }
+
+        entries.erase(entry);
+        if (entries.empty()) {
+            by_com_id_.erase(it);
+        }
+        count_--;
+        return true;
+    }
+    return false;
+}
+
+void PdSubscriberTable::dispatch(const PdRxView &view) const {
+    const auto exact = by_com_id_.find(view.com_id);
+    if (exact != by_com_id_.end()) {
+        for (const auto &entry : exact->second) {
+            entry.callback(view);
+        }
+    }
+
+    if (view.com_id == 0u) {
+        return;
+    }
+    const auto wildcard = by_com_id_.find(0u);
+    if (wildcard != by_com_id_.end()) {
+        for (const auto &entry : wildcard->second) {
+            entry.callback(view);
+        }
+    }
+}
+
+}  // namespace trdp
@@ -0,0 +1,158 @@
+#include "trdp/pd_watch.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace trdp {
+namespace {
+
+bool holds(WatchOp op, double value, double threshold) {
+    switch (op) {
+        case WatchOp::Greater:
+            return value > threshold;
+        case WatchOp::GreaterEqual:
+            return value >= threshold;
+        case WatchOp::Less:
+            return value < threshold;
+        case WatchOp::LessEqual:
+            return value <= threshold;
+        case WatchOp::Equal:
+            return value == threshold;
+        case WatchOp::NotEqual:
+            return value != threshold;
+        case WatchOp::Changed:
+            return false;
+    }
+    return false;
+}
+
+}  // namespace
+
+WatchOp parseWatchOp(const std::string &text) {
+    if (text == ">" || text == "gt") {
+        return WatchOp::Greater;
+    }
+    if (text == ">=" || text == "ge") {
+        return WatchOp::GreaterEqual;
+    }
+    if (text == "<" || text == "lt") {
+        return WatchOp::Less;
+    }
+    if (text == "<=" || text == "le") {
+        return WatchOp::LessEqual;
+    }
+    if (text == "==" || text == "eq") {
+        return WatchOp::Equal;
+    }
+    if (text == "!=" || text == "ne") {
+        return WatchOp::NotEqual;
+    }
+    if (text == "changed") {
+        return WatchOp::Changed;
+    }
+    throw std::runtime_error("Unknown watch operator: " + text);
+}
+
+const char *watchOpToString(WatchOp op) {
+    switch (op) {
+        case WatchOp::Greater:
+            return ">";
+        case WatchOp::GreaterEqual:
+            return ">=";
+        case WatchOp::Less:
+            return "<";
+        case WatchOp::LessEqual:
+            return "<=";
+        case WatchOp::Equal:
+            return "==";
+        case WatchOp::NotEqual:
+            return "!=";
+        case WatchOp::Changed:
+            return "changed";
+    }
+    return "?";
+}
+
+uint64_t PdWatchTable::add(const PdWatchSpec &spec, const DatasetLayout &layout, const void *target) {
+    const FieldLayout *field = layout.findField(spec.field);
+    if (field == nullptr) {
+        throw std::runtime_error("Unknown dataset field: " + spec.field);
+    }
+    if (spec.index >= field->array_size) {
+        throw std::runtime_error("Field index out of range");
+    }
+    if (spec.bit >= static_cast<int32_t>(field->element_size * 8u)) {
+        throw std::runtime_error("Bit index out of range");
+    }
+
+    Rule rule {};
+    rule.id = next_id_++;
+    rule.spec = spec;
+    rule.target = target;
+    rule.offset = field->offset + spec.index * field->element_size;
+    rule.type = field->type;
+    rule.element_size = field->element_size;
+    rules_.push_back(std::move(rule));
+    return rules_.back().id;
+}
+
+const void *PdWatchTable::remove(uint64_t id) {
+    const auto it = std::find_if(rules_.begin(), rules_.end(), [id](const Rule &rule) { return rule.id == id; });
+    if (it == rules_.end()) {
+        return nullptr;
+    }
+    const void *target = it->target;
+    rules_.erase(it);
+    return target;
+}
+
+void PdWatchTable::clear() { rules_.clear(); }
+
+size_t PdWatchTable::countFor(const void *target) const {
+    return static_cast<size_t>(
+        std::count_if(rules_.begin(), rules_.end(), [target](const Rule &rule) { return rule.target == target; }));
+}
+
+std::vector<PdWatchStatus> PdWatchTable::status() const {
+    std::vector<PdWatchStatus> result;
+    result.reserve(rules_.size());
+    for (const auto &rule : rules_) {
+        result.push_back(PdWatchStatus {rule.id, rule.spec, rule.hits, rule.condition, rule.has_value, rule.last_value,
+                                        rule.last_hit_ns});
+    }
+    return result;
+}
+
+void PdWatchTable::evaluate(const void *target, const uint8_t *data, size_t size, int64_t time_ns,
+                            std::vector<PdWatchEvent> &fired) {
+    for (auto &rule : rules_) {
+        if (rule.target != target || static_cast<size_t>(rule.offset) + rule.element_size > size) {
+            continue;
+        }
+
+        int64_t value = decodeElement(data + rule.offset, rule.type);
+        if (rule.spec.bit >= 0) {
+            value = (static_cast<uint64_t>(value) >> rule.spec.bit) & 1u;
+        }
+
+        bool fire = false;
+        if (rule.spec.op == WatchOp::Changed) {
+            fire = rule.has_value && value != rule.last_value;
+        } else {
+            const bool condition = holds(rule.spec.op, static_cast<double>(value), rule.spec.threshold);
+            fire = condition && !rule.condition;
+            rule.condition = condition;
+        }
+
+        if (fire) {
+            rule.hits++;
+            rule.last_hit_ns = time_ns;
+            fired.push_back(PdWatchEvent {rule.id, rule.spec.com_id, time_ns, value, rule.has_value ? rule.last_value : value});
+        }
+
+        rule.last_value = value;
+        rule.has_value = true;
+    }
+}
+
+}  // namespace trdp
@@ -0,0 +1,460 @@
+#include "trdp/state_journal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace trdp {
+namespace {
+
+constexpr char kJournalMagic[8] = {'W', 'T', 'R', 'D', 'P', 'J', 'N', 'L'};
+constexpr size_t kFileHeaderSize = 16u;
+constexpr size_t kRecordHeaderSize = 8u;
+constexpr auto kFlushInterval = std::chrono::milliseconds(100);
+// The log is rewritten once it is this many times its last snapshot, but
+// never for less than kCompactMinBytes.
+constexpr uint64_t kCompactFactor = 4u;
+constexpr uint64_t kCompactMinBytes = 256u * 1024u;
+
+enum RecordType : uint8_t {
+    kRecordConfig = 1u,
+    kRecordPayload = 2u,
+    kRecordEnabled = 3u,
+};
+
+uint32_t fnv1a(const uint8_t *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t idx = 0u; idx < size; ++idx) {
+        hash = (hash ^ data[idx]) * 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+void put(std::vector<uint8_t> &out, T value) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void putString(std::vector<uint8_t> &out, const std::string &text) {
+    const auto size = static_cast<uint16_t>(std::min<size_t>(text.size(), UINT16_MAX));
+    put(out, size);
+    out.insert(out.end(), text.begin(), text.begin() + size);
+}
+
+// Reserves the record header; endRecord() fills it in once the body is
+// complete.
+size_t beginRecord(std::vector<uint8_t> &out, RecordType type) {
+    const size_t start = out.size();
+    out.resize(start + kRecordHeaderSize);
+    put(out, static_cast<uint8_t>(type));
+    return start;
+}
+
+void endRecord(std::vector<uint8_t> &out, size_t start) {
+    const auto size = static_cast<uint32_t>(out.size() - start - kRecordHeaderSize);
+    const uint32_t checksum = fnv1a(out.data() + start + kRecordHeaderSize, size);
+    std::memcpy(out.data() + start, &size, sizeof(size));
+    std::memcpy(out.data() + start + sizeof(size), &checksum, sizeof(checksum));
+}
+
+class Reader {
+public:
+    Reader(const uint8_t *data, size_t size) : pos_(data), end_(data + size) {}
+
+    template <typename T>
+    bool get(T &value) {
+        if (static_cast<size_t>(end_ - pos_) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool getBytes(std::vector<uint8_t> &bytes, size_t size) {
+        if (static_cast<size_t>(end_ - pos_) < size) {
+            return false;
+        }
+        bytes.assign(pos_, pos_ + size);
+        pos_ += size;
+        return true;
+    }
+
+    bool getString(std::string &text) {
+        uint16_t size = 0u;
+        if (!get(size) || static_cast<size_t>(end_ - pos_) < size) {
+            return false;
+        }
+        text.assign(reinterpret_cast<const char *>(pos_), size);
+        pos_ += size;
+        return true;
+    }
+
+    bool atEnd() const { return pos_ == end_; }
+
+private:
+    const uint8_t *pos_;
+    const uint8_t *end_;
+};
+
+bool writeAll(int fd, const uint8_t *data, size_t size) {
+    while (size > 0u) {
+        const ssize_t written = ::write(fd, data, size);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+}  // namespace
+
+StateJournal::~StateJournal() { close(); }
+
+JournalState StateJournal::open(const std::string &path) {
+    close();
+
+    std::vector<uint8_t> data;
+    {
+        std::ifstream input(path, std::ios::binary);
+        if (input.is_open()) {
+            data.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        }
+    }
+
+    JournalState state {};
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        path_ = path;
+        xml_path_.clear();
+        host_names_.clear();
+        entries_.clear();
+        dirty_.clear();
+        config_dirty_ = false;
+        error_.clear();
+        records_written_ = 0u;
+        compactions_ = 0u;
+
+        if (!data.empty()) {
+            uint32_t version = 0u;
+            if (data.size() < kFileHeaderSize || std::memcmp(data.data(), kJournalMagic, sizeof(kJournalMagic)) != 0) {
+                throw std::runtime_error("Not a state journal: " + path);
+            }
+            std::memcpy(&version, data.data() + sizeof(kJournalMagic), sizeof(version));
+            if (version != kJournalVersion) {
+                throw std::runtime_error("Unsupported state journal version in " + path);
+            }
+
+            size_t offset = kFileHeaderSize;
+            while (data.size() - offset >= kRecordHeaderSize) {
+                uint32_t size = 0u;
+                uint32_t checksum = 0u;
+                std::memcpy(&size, data.data() + offset, sizeof(size));
+                std::memcpy(&checksum, data.data() + offset + sizeof(size), sizeof(checksum));
+                const uint8_t *body = data.data() + offset + kRecordHeaderSize;
+                if (size > data.size() - offset - kRecordHeaderSize || fnv1a(body, size) != checksum ||
+                    !replayRecord(body, size)) {
+                    break;
+                }
+                offset += kRecordHeaderSize + size;
+            }
+        }
+
+        state.xml_path = xml_path_;
+        state.host_names = host_names_;
+        state.telegrams.reserve(entries_.size());
+        for (const auto &entry : entries_) {
+            state.telegrams.push_back({entry.first.first, entry.first.second, entry.second.has_payload,
+                                       entry.second.payload, entry.second.has_enabled, entry.second.enabled});
+        }
+    }
+
+    // Starting from a fresh snapshot drops the history and any torn tail.
+    compact();
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    active_ = true;
+    stopping_ = false;
+    writer_ = std::thread(&StateJournal::writerLoop, this);
+    return state;
+}
+
+void StateJournal::close() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!active_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    writer_.join();
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    active_ = false;
+}
+
+StateJournalStatus StateJournal::status() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    StateJournalStatus status {};
+    status.active = active_;
+    status.path = path_;
+    status.telegrams = entries_.size();
+    status.records_written = records_written_;
+    status.compactions = compactions_;
+    status.file_size = file_size_;
+    status.error = error_;
+    return status;
+}
+
+void StateJournal::recordConfig(const std::string &xml_path, const std::vector<std::string> &host_names) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!active_) {
+        return;
+    }
+    xml_path_ = xml_path;
+    host_names_ = host_names;
+    entries_.clear();
+    dirty_.clear();
+    config_dirty_ = true;
+}
+
+void StateJournal::recordPayload(uint32_t com_id, const std::string &host_name, const uint8_t *data, size_t size) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!active_) {
+        return;
+    }
+    Entry &entry = touch({com_id, host_name});
+    entry.has_payload = true;
+    entry.payload.assign(data, data + size);
+}
+
+void StateJournal::recordEnabled(uint32_t com_id, const std::string &host_name, bool enabled) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!active_) {
+        return;
+    }
+    Entry &entry = touch({com_id, host_name});
+    entry.has_enabled = true;
+    entry.enabled = enabled;
+}
+
+StateJournal::Entry &StateJournal::touch(const Key &key) {
+    Entry &entry = entries_[key];
+    if (!entry.dirty) {
+        entry.dirty = true;
+        dirty_.push_back(key);
+    }
+    return entry;
+}
+
+bool StateJournal::replayRecord(const uint8_t *body, size_t size) {
+    Reader reader(body, size);
+    uint8_t type = 0u;
+    if (!reader.get(type)) {
+        return false;
+    }
+
+    if (type == kRecordConfig) {
+        std::string xmlPath;
+        uint16_t hostCount = 0u;
+        if (!reader.getString(xmlPath) || !reader.get(hostCount)) {
+            return false;
+        }
+        std::vector<std::string> hostNames(hostCount);
+        for (auto &hostName : hostNames) {
+            if (!reader.getString(hostName)) {
+                return false;
+            }
+        }
+        xml_path_ = std::move(xmlPath);
+        host_names_ = std::move(hostNames);
+        entries_.clear();
+        return reader.atEnd();
+    }
+
+    Key key;
+    if (!reader.get(key.first) || !reader.getString(key.second)) {
+        return false;
+    }
+    if (type == kRecordPayload) {
+        uint16_t payloadSize = 0u;
+        std::vector<uint8_t> payload;
+        if (!reader.get(payloadSize) || !reader.getBytes(payload, payloadSize)) {
+            return false;
+        }
+        Entry &entry = entries_[key];
+        entry.has_payload = true;
+        entry.payload = std::move(payload);
+        return reader.atEnd();
+    }
+    if (type == kRecordEnabled) {
+        uint8_t enabled = 0u;
+        if (!reader.get(enabled)) {
+            return false;
+        }
+        Entry &entry = entries_[key];
+        entry.has_enabled = true;
+        entry.enabled = enabled != 0u;
+        return reader.atEnd();
+    }
+    return false;
+}
+
+void StateJournal::writerLoop() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+        cv_.wait_for(lock, kFlushInterval, [this]() { return stopping_; });
+        const bool stop = stopping_;
+        lock.unlock();
+        // The last flush runs after stop was requested so nothing recorded
+        // before close() is lost.
+        flush();
+        lock.lock();
+        if (stop) {
+            return;
+        }
+    }
+}
+
+void StateJournal::flush() {
+    std::vector<uint8_t> out;
+    uint64_t records = 0u;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (config_dirty_) {
+            records += appendConfig(out);
+            config_dirty_ = false;
+        }
+        for (const auto &key : dirty_) {
+            const auto it = entries_.find(key);
+            if (it == entries_.end() || !it->second.dirty) {
+                continue;
+            }
+            records += appendEntry(out, it->first, it->second);
+            it->second.dirty = false;
+        }
+        dirty_.clear();
+    }
+    if (out.empty()) {
+        return;
+    }
+
+    bool written = writeAll(fd_, out.data(), out.size()) && ::fdatasync(fd_) == 0;
+    bool compactNow = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (written) {
+            file_size_ += out.size();
+            records_written_ += records;
+            compactNow = file_size_ > std::max(kCompactMinBytes, snapshot_size_ * kCompactFactor);
+        } else {
+            error_ = "Failed to append to state journal: " + path_;
+        }
+    }
+
+    // A failed append may have left a partial record; a fresh snapshot
+    // replaces it.
+    if (!written || compactNow) {
+        try {
+            compact();
+        } catch (const std::exception &ex) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            error_ = ex.what();
+        }
+    }
+}
+
+void StateJournal::compact() {
+    std::vector<uint8_t> out(kFileHeaderSize, 0u);
+    std::memcpy(out.data(), kJournalMagic, sizeof(kJournalMagic));
+    std::memcpy(out.data() + sizeof(kJournalMagic), &kJournalVersion, sizeof(kJournalVersion));
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        path = path_;
+        appendConfig(out);
+        for (auto &entry : entries_) {
+            appendEntry(out, entry.first, entry.second);
+            entry.second.dirty = false;
+        }
+        dirty_.clear();
+        config_dirty_ = false;
+    }
+
+    // Written next to the log and renamed over it, so a crash leaves
+    // either the old log or the complete snapshot.
+    const std::string tmpPath = path + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create state journal: " + tmpPath);
+    }
+    if (!writeAll(fd, out.data(), out.size()) || ::fdatasync(fd) != 0 || ::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        ::close(fd);
+        ::unlink(tmpPath.c_str());
+        throw std::runtime_error("Failed to write state journal: " + path);
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    // The descriptor now refers to the renamed file, positioned at its end.
+    fd_ = fd;
+    file_size_ = snapshot_size_ = out.size();
+    compactions_++;
+    error_.clear();
+}
+
+size_t StateJournal::appendEntry(std::vector<uint8_t> &out, const Key &key, const Entry &entry) const {
+    size_t records = 0u;
+    if (entry.has_payload) {
+        const size_t start = beginRecord(out, kRecordPayload);
+        put(out, key.first);
+        putString(out, key.second);
+        const auto size = static_cast<uint16_t>(std::min<size_t>(entry.payload.size(), UINT16_MAX));
+        put(out, size);
+        out.insert(out.end(), entry.payload.begin(), entry.payload.begin() + size);
+        endRecord(out, start);
+        records++;
+    }
+    if (entry.has_enabled) {
+        const size_t start = beginRecord(out, kRecordEnabled);
+        put(out, key.first);
+        putString(out, key.second);
+        put(out, static_cast<uint8_t>(entry.enabled ? 1u : 0u));
+        endRecord(out, start);
+        records++;
+    }
+    return records;
+}
+
+size_t StateJournal::appendConfig(std::vector<uint8_t> &out) const {
+    if (xml_path_.empty()) {
+        return 0u;
+    }
+    const size_t start = beginRecord(out, kRecordConfig);
+    putString(out, xml_path_);
+    put(out, static_cast<uint16_t>(host_names_.size()));
+    for (const auto &hostName : host_names_) {
+        putString(out, hostName);
+    }
+    endRecord(out, start);
+    return 1u;
+}
+
+}  // namespace trdp
@@ -0,0 +1,252 @@
+#include "trdp/trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace trdp {
+namespace detail {
+
+std::atomic<bool> g_trace_enabled {false};
+
+}  // namespace detail
+
+namespace {
+
+struct TraceRecord {
+    const char *name;
+    const char *category;
+    int64_t start_ns;
+    int64_t duration_ns;
+    int64_t arg;
+    char phase;
+};
+
+// Written only by its owning thread. `records` is resized by the owner when
+// it first writes into a new capture; readers only look at it after
+// traceStop() has waited for `writing` to drop.
+struct ThreadRing {
+    uint32_t tid {0u};
+    std::string name;
+    uint64_t generation {0u};
+    std::vector<TraceRecord> records;
+    std::atomic<uint64_t> head {0u};
+    std::atomic<bool> writing {false};
+};
+
+struct TraceRegistry {
+    std::mutex mtx;
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    std::atomic<uint64_t> generation {0u};
+    size_t capacity {0u};
+    int64_t epoch_ns {0};
+    bool active {false};
+    uint32_t next_tid {1u};
+};
+
+TraceRegistry &registry() {
+    static TraceRegistry instance;
+    return instance;
+}
+
+ThreadRing &localRing() {
+    thread_local std::shared_ptr<ThreadRing> ring;
+    if (!ring) {
+        auto created = std::make_shared<ThreadRing>();
+        TraceRegistry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mtx);
+        created->tid = reg.next_tid++;
+        reg.rings.push_back(created);
+        ring = std::move(created);
+    }
+    return *ring;
+}
+
+void appendEscaped(std::ostringstream &out, const char *text) {
+    for (const char *c = text != nullptr ? text : ""; *c != '\0'; ++c) {
+        switch (*c) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            default:
+                if (static_cast<unsigned char>(*c) < 0x20u) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(*c));
+                    out << escaped;
+                } else {
+                    out << *c;
+                }
+                break;
+        }
+    }
+}
+
+void appendMicros(std::ostringstream &out, int64_t ns) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%lld.%03lld", static_cast<long long>(ns / 1000), static_cast<long long>(ns % 1000));
+    out << buffer;
+}
+
+}  // namespace
+
+namespace detail {
+
+void traceEmit(const char *name, const char *category, int64_t start_ns, int64_t duration_ns, int64_t arg, char phase) {
+    ThreadRing &ring = localRing();
+
+    // Pairs with traceStop(): either the stop sees `writing` and waits, or
+    // this thread sees the capture disabled and backs out.
+    ring.writing.store(true, std::memory_order_seq_cst);
+    if (!g_trace_enabled.load(std::memory_order_seq_cst)) {
+        ring.writing.store(false, std::memory_order_release);
+        return;
+    }
+
+    TraceRegistry &reg = registry();
+    const uint64_t generation = reg.generation.load(std::memory_order_acquire);
+    if (ring.generation != generation) {
+        std::lock_guard<std::mutex> lock(reg.mtx);
+        ring.records.assign(reg.capacity, TraceRecord {});
+        ring.head.store(0u, std::memory_order_relaxed);
+        ring.generation = generation;
+    }
+
+    if (!ring.records.empty()) {
+        const uint64_t head = ring.head.load(std::memory_order_relaxed);
+        ring.records[head % ring.records.size()] = TraceRecord {name, category, start_ns, duration_ns, arg, phase};
+        ring.head.store(head + 1u, std::memory_order_relaxed);
+    }
+
+    ring.writing.store(false, std::memory_order_release);
+}
+
+}  // namespace detail
+
+void traceStart(size_t events_per_thread) {
+    TraceRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+
+    // Rings of threads that have exited are only referenced from here.
+    reg.rings.erase(std::remove_if(reg.rings.begin(), reg.rings.end(),
+                                   [](const std::shared_ptr<ThreadRing> &ring) { return ring.use_count() == 1; }),
+                    reg.rings.end());
+
+    reg.capacity = std::max<size_t>(events_per_thread, 1u);
+    reg.epoch_ns = traceNowNs();
+    reg.active = true;
+    reg.generation.fetch_add(1u, std::memory_order_acq_rel);
+    detail::g_trace_enabled.store(true, std::memory_order_seq_cst);
+}
+
+void traceStop() {
+    TraceRegistry &reg = registry();
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        std::lock_guard<std::mutex> lock(reg.mtx);
+        if (!reg.active) {
+            return;
+        }
+        reg.active = false;
+        detail::g_trace_enabled.store(false, std::memory_order_seq_cst);
+        rings = reg.rings;
+    }
+
+    // A writer may be blocked on reg.mtx while flagged as writing, so the
+    // wait happens outside the lock.
+    for (const auto &ring : rings) {
+        while (ring->writing.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+TraceStatus traceStatus() {
+    TraceRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+
+    TraceStatus status {reg.active, reg.capacity, 0u, 0u, 0u};
+    const uint64_t generation = reg.generation.load(std::memory_order_acquire);
+    for (const auto &ring : reg.rings) {
+        if (ring->generation != generation) {
+            continue;
+        }
+        const uint64_t head = ring->head.load(std::memory_order_relaxed);
+        const uint64_t kept = std::min<uint64_t>(head, reg.capacity);
+        status.threads++;
+        status.events += kept;
+        status.overwritten += head - kept;
+    }
+    return status;
+}
+
+std::string traceExportChrome() {
+    TraceRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"trdp-engine\"}}";
+
+    if (reg.active) {
+        out << "]}";
+        return out.str();
+    }
+
+    const uint64_t generation = reg.generation.load(std::memory_order_acquire);
+    for (const auto &ring : reg.rings) {
+        if (ring->generation != generation || ring->records.empty()) {
+            continue;
+        }
+
+        out << ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid << ",\"args\":{\"name\":\"";
+        if (ring->name.empty()) {
+            out << "thread-" << ring->tid;
+        } else {
+            appendEscaped(out, ring->name.c_str());
+        }
+        out << "\"}}";
+
+        const uint64_t head = ring->head.load(std::memory_order_relaxed);
+        const size_t size = ring->records.size();
+        const uint64_t first = head > size ? head - size : 0u;
+        for (uint64_t seq = first; seq < head; ++seq) {
+            const TraceRecord &record = ring->records[seq % size];
+            // Scopes opened during a previous capture end up here too.
+            if (record.start_ns < reg.epoch_ns) {
+                continue;
+            }
+            out << ",{\"name\":\"";
+            appendEscaped(out, record.name);
+            out << "\",\"cat\":\"";
+            appendEscaped(out, record.category);
+            out << "\",\"ph\":\"" << record.phase << "\",\"pid\":1,\"tid\":" << ring->tid << ",\"ts\":";
+            appendMicros(out, record.start_ns - reg.epoch_ns);
+            if (record.phase == 'X') {
+                out << ",\"dur\":";
+                appendMicros(out, record.duration_ns);
+            } else {
+                out << ",\"s\":\"t\"";
+            }
+            out << ",\"args\":{\"arg\":" << record.arg << "}}";
+        }
+    }
+
+    out << "]}";
+    return out.str();
+}
+
+void traceSetThreadName(const char *name) {
+    ThreadRing &ring = localRing();
+    TraceRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    ring.name = name != nullptr ? name : "";
+}
+
+}  // namespace trdp
@@ -3,6 +3,7 @@
 #include "trdp_config.hpp"
 
 #include <fstream>
+#include <iterator>
 #include <stdexcept>
 #include <regex>
 #include <sstream>
@@ -66,7 +67,7 @@ std::unordered_map<uint32_t, std::string> parseTelegramNames(const std::string &
     return comIdToName;
 }
 
-Direction determineDirection(const TRDP_EXCHG_PAR_T &exchange, const std::string &host_name) {
+Direction determineDirection(const TRDP_EXCHG_PAR_T &exchange, const std::string &host_name, bool &involved) {
     bool isSource = false;
     bool isDestination = false;
 
@@ -85,6 +86,8 @@ Direction determineDirection(const TRDP_EXCHG_PAR_T &exchange, const std::string
         }
     }
 
+    involved = isSource || isDestination;
+
     if (isSource && isDestination) {
         return Direction::SourceSink;
     }
@@ -98,12 +101,52 @@ Direction determineDirection(const TRDP_EXCHG_PAR_T &exchange, const std::string
     return mapDirection(exchange.type);
 }
 
+const TRDP_COM_PAR_T *findComPar(const TRDP_COM_PAR_T *params, UINT32 count, UINT32 id) {
+    for (UINT32 idx = 0u; idx < count; ++idx) {
+        if (params[idx].id == id) {
+            return &params[idx];
+        }
+    }
+    return nullptr;
+}
+
+struct HostSpec {
+    std::string name;
+    std::string ip;
+};
+
+HostSpec parseHostSpec(const std::string &entry) {
+    const auto at = entry.find('@');
+    if (at == std::string::npos) {
+        return HostSpec {entry, {}};
+    }
+    return HostSpec {entry.substr(0u, at), entry.substr(at + 1u)};
+}
+
 }  // namespace
 
 void TrdpConfigLoader::loadFromXml(const std::string &xml_path, const std::string &host_name) {
+    loadFromXml(xml_path, std::vector<std::string> {host_name});
+}
+
+void TrdpConfigLoader::loadFromXml(const std::string &xml_path, const std::vector<std::string> &host_names) {
     interfaces_.clear();
     pdTelegrams_.clear();
     datasets_.clear();
+    hostNames_.clear();
+    memory_ = MemoryConfig {};
+
+    if (host_names.empty()) {
+        throw std::runtime_error("At least one host name is required");
+    }
+
+    std::vector<HostSpec> hosts;
+    hosts.reserve(host_names.size());
+    for (const auto &entry : host_names) {
+        hosts.push_back(parseHostSpec(entry));
+        hostNames_.push_back(hosts.back().name);
+    }
+    const bool multiHost = hosts.size() > 1u;
 
     TRDP_XML_DOC_HANDLE_T docHandle {};
     TRDP_ERR_T result = tau_prepareXmlDoc(xml_path.c_str(), &docHandle);
@@ -131,6 +174,9 @@ void TrdpConfigLoader::loadFromXml(const std::string &xml_path, const std::strin
             throw std::runtime_error("Failed to read TRDP device configuration");
         }
 
+        memory_.size = memConfig.size;
+        memory_.prealloc.assign(std::begin(memConfig.prealloc), std::end(memConfig.prealloc));
+
         result = tau_readXmlDatasetConfig(&docHandle, &numComId, &pComIdMap, &numDataset, &ppDataset);
         if (result != TRDP_NO_ERR) {
             throw std::runtime_error("Failed to read TRDP dataset configuration");
@@ -153,13 +199,20 @@ void TrdpConfigLoader::loadFromXml(const std::string &xml_path, const std::strin
             datasets_.push_back(dataset);
         }
 
-        interfaces_.reserve(numIfConfig);
+        interfaces_.reserve(static_cast<size_t>(numIfConfig) * hosts.size());
         for (UINT32 idx = 0u; idx < numIfConfig; ++idx) {
-            InterfaceDef iface {};
-            iface.name = pIfConfig[idx].ifName;
-            iface.network_id = pIfConfig[idx].networkId;
-            iface.host_ip = vos_ipDotted(pIfConfig[idx].hostIp);
-            interfaces_.push_back(iface);
+            // Hosts without "@ip" inherit the interface host-ip, and two
+            // sessions on one address would receive each other's traffic.
+            std::unordered_map<std::string, std::string> hostByIp;
+            for (const auto &host : hosts) {
+                const std::string ip = host.ip.empty() ? std::string(vos_ipDotted(pIfConfig[idx].hostIp)) : host.ip;
+                const auto inserted = hostByIp.emplace(ip, host.name);
+                if (!inserted.second) {
+                    throw std::runtime_error("Hosts '" + inserted.first->second + "' and '" + host.name +
+                                             "' both use " + ip + " on interface " + pIfConfig[idx].ifName +
+                                             "; give each host its own address as name@ip");
+                }
+            }
 
             TRDP_PROCESS_CONFIG_T processConfig {};
             TRDP_PD_CONFIG_T pdConfig {};
@@ -172,21 +225,71 @@ void TrdpConfigLoader::loadFromXml(const std::string &xml_path, const std::strin
                 throw std::runtime_error("Failed to read TRDP interface configuration");
             }
 
-            for (UINT32 telIdx = 0u; telIdx < numExchgPar; ++telIdx) {
-                const TRDP_EXCHG_PAR_T &exchange = pExchgPar[telIdx];
-                PdTelegramDef telegram {};
-
-                const auto nameIt = nameMap.find(exchange.comId);
-                telegram.name = nameIt != nameMap.end() ? nameIt->second : std::string {};
-                telegram.com_id = exchange.comId;
-                telegram.dataset_id = exchange.datasetId;
-                telegram.direction = determineDirection(exchange, host_name);
-                telegram.cycle_us = exchange.pPdPar != nullptr ? exchange.pPdPar->cycle : 0u;
-                telegram.marshall = exchange.pPdPar != nullptr ? (exchange.pPdPar->flags & TRDP_FLAGS_MARSHALL) != 0u
-                                                               : (pdConfig.flags & TRDP_FLAGS_MARSHALL) != 0u;
-                telegram.interface_name = iface.name;
-
-                pdTelegrams_.push_back(telegram);
+            for (const auto &host : hosts) {
+                InterfaceDef iface {};
+                iface.name = pIfConfig[idx].ifName;
+                iface.network_id = pIfConfig[idx].networkId;
+                iface.host_ip = host.ip.empty() ? std::string(vos_ipDotted(pIfConfig[idx].hostIp)) : host.ip;
+                iface.host_name = host.name;
+                iface.cycle_us = processConfig.cycleTime;
+                iface.priority = processConfig.priority;
+                iface.options = processConfig.options;
+                iface.pd_qos = pdConfig.sendParam.qos;
+                iface.pd_ttl = pdConfig.sendParam.ttl;
+                iface.pd_timeout_us = pdConfig.timeout;
+                iface.pd_to_behavior = static_cast<uint8_t>(pdConfig.toBehavior);
+                iface.pd_port = pdConfig.port;
+                interfaces_.push_back(iface);
+
+                for (UINT32 telIdx = 0u; telIdx < numExchgPar; ++telIdx) {
+                    const TRDP_EXCHG_PAR_T &exchange = pExchgPar[telIdx];
+                    PdTelegramDef telegram {};
+
+                    bool involved = false;
+                    telegram.direction = determineDirection(exchange, host.name, involved);
+                    if (multiHost && !involved) {
+                        continue;
+                    }
+
+                    const auto nameIt = nameMap.find(exchange.comId);
+                    telegram.name = nameIt != nameMap.end() ? nameIt->second : std::string {};
+                    telegram.com_id = exchange.comId;
+                    telegram.dataset_id = exchange.datasetId;
+                    telegram.cycle_us = exchange.pPdPar != nullptr ? exchange.pPdPar->cycle : 0u;
+                    telegram.pull = exchange.pPdPar != nullptr && exchange.pPdPar->cycle == 0u;
+                    telegram.marshall = exchange.pPdPar != nullptr ? (exchange.pPdPar->flags & TRDP_FLAGS_MARSHALL) != 0u
+                                                                   : (pdConfig.flags & TRDP_FLAGS_MARSHALL) != 0u;
+                    telegram.interface_name = iface.name;
+                    telegram.host_name = host.name;
+                    for (uint32_t src = 0u; src < exchange.srcCnt; ++src) {
+                        const TRDP_SRC_T &source = exchange.pSrc[src];
+                        PdSourceDef sourceDef {};
+                        if (source.pUriHost1 != nullptr) {
+                            sourceDef.uri1 = *source.pUriHost1;
+                        }
+                        if (source.pUriHost2 != nullptr) {
+                            sourceDef.uri2 = *source.pUriHost2;
+                        }
+                        telegram.sources.push_back(std::move(sourceDef));
+                    }
+                    for (uint32_t dest = 0u; dest < exchange.destCnt; ++dest) {
+                        if (exchange.pDest[dest].pUriHost != nullptr) {
+                            telegram.destinations.emplace_back(*exchange.pDest[dest].pUriHost);
+                        }
+                    }
+
+                    const TRDP_COM_PAR_T *comPar = findComPar(pComPar, numComPar, exchange.comParId);
+                    telegram.qos = comPar != nullptr ? comPar->sendParam.qos : iface.pd_qos;
+                    telegram.ttl = comPar != nullptr ? comPar->sendParam.ttl : iface.pd_ttl;
+                    telegram.timeout_us = exchange.pPdPar != nullptr && exchange.pPdPar->timeout != 0u
+                                              ? exchange.pPdPar->timeout
+                                              : iface.pd_timeout_us;
+                    telegram.to_behavior = exchange.pPdPar != nullptr && exchange.pPdPar->toBehav != TRDP_TO_DEFAULT
+                                               ? static_cast<uint8_t>(exchange.pPdPar->toBehav)
+                                               : iface.pd_to_behavior;
+
+                    pdTelegrams_.push_back(telegram);
+                }
             }
 
             tau_freeTelegrams(numExchgPar, pExchgPar);
@@ -223,5 +326,9 @@ const std::vector<PdTelegramDef> &TrdpConfigLoader::pdTelegrams() const { return
 
 const std::vector<Dataset> &TrdpConfigLoader::datasets() const { return datasets_; }
 
+const std::vector<std::string> &TrdpConfigLoader::hostNames() const { return hostNames_; }
+
+const MemoryConfig &TrdpConfigLoader::memory() const { return memory_; }
+
 }  // namespace trdp
 
@@ -1,9 +1,16 @@
 #include "trdp_engine.hpp"
 
+#include "trdp/log.hpp"
+#include "trdp/trace.hpp"
 #include "trdp/trdp_config_loader.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <iterator>
+#include <sstream>
 #include <stdexcept>
+#include <sys/socket.h>
+#include <utility>
 
 #include <vos_sock.h>
 
@@ -15,50 +22,421 @@ void pdCallback(void *pUserRef, TRDP_APP_SESSION_T appHandle, const TRDP_PD_INFO
     }
 }
 
-void mdCallback(void *, TRDP_APP_SESSION_T, const TRDP_MD_INFO_T *, UINT8 *, UINT32) {
-    // MD handling not implemented yet
+void mdCallback(void *pRefCon, TRDP_APP_SESSION_T appHandle, const TRDP_MD_INFO_T *pMsg, UINT8 *pData, UINT32 dataSize) {
+    if (pRefCon != nullptr) {
+        static_cast<trdp::TrdpEngine *>(pRefCon)->onMdReceive(appHandle, pMsg, pData, dataSize);
+    }
+}
+
+constexpr uint32_t kMdDefaultReplyTimeoutUs = 1000000u;
+// Grace period before the engine expires a request the stack never reported on.
+constexpr auto kMdExpiryGrace = std::chrono::milliseconds(500);
+constexpr auto kMdSweepInterval = std::chrono::milliseconds(10);
+constexpr uint32_t kPdPullDefaultTimeoutUs = 1000000u;
+constexpr uint32_t kProcessDefaultCycleUs = 100000u;
+// Receive buffer sizing: the kernel charges each datagram its buffer
+// truesize, which is well above the TRDP payload.
+constexpr double kRxBacklogMs = 200.0;
+constexpr uint32_t kRxPacketOverhead = 768u;
+constexpr uint32_t kRxBufferMin = 256u * 1024u;
+constexpr uint32_t kRxBufferMax = 64u * 1024u * 1024u;
+
+// Subscription timeout of a telegram: its own, or two cycles.
+uint32_t pdTimeoutUs(const trdp::PdTelegramDef &def) {
+    return def.timeout_us > 0u ? def.timeout_us : (def.cycle_us > 0u ? def.cycle_us * 2u : 0u);
+}
+
+// A replayed payload may have been shorter than the dataset; the arena slot
+// always covers the full layout, so patches extend it with zeros first.
+void padTxPayload(trdp::PdState &pd) {
+    if (pd.tx_size < pd.layout->size) {
+        std::memset(pd.tx_payload + pd.tx_size, 0, pd.layout->size - pd.tx_size);
+        pd.tx_size = pd.layout->size;
+    }
+}
+
+void encodeField(uint8_t *payload, const trdp::FieldLayout &field, double value) {
+    uint8_t *dst = payload + field.offset;
+    for (uint32_t idx = 0u; idx < field.array_size; ++idx) {
+        trdp::encodeElement(dst, field.type, value);
+        dst += field.element_size;
+    }
+}
+
+// SO_RCVBUFFORCE goes past net.core.rmem_max but needs CAP_NET_ADMIN; the
+// plain option is the fallback and is capped by the kernel.
+void applyRxBuffer(TRDP_APP_SESSION_T appHandle, uint32_t bytes) {
+    TRDP_FDS_T sockets;
+    FD_ZERO(&sockets);
+    TRDP_TIME_T interval {};
+    TRDP_SOCK_T highest = -1;
+    tlc_getInterval(appHandle, &interval, &sockets, &highest);
+
+    const int size = static_cast<int>(bytes);
+    for (TRDP_SOCK_T sock = 0; sock <= highest; ++sock) {
+        if (!FD_ISSET(sock, &sockets)) {
+            continue;
+        }
+        if (setsockopt(sock, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) != 0) {
+            (void)setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        }
+    }
 }
 
 }  // namespace
 
 namespace trdp {
+namespace {
+
+// Decodes every field that lies completely inside `size` bytes; decoding
+// stops at the first field that does not.
+std::vector<DecodedField> decodeFields(const DatasetLayout &layout, const uint8_t *data, size_t size) {
+    std::vector<DecodedField> decoded;
+
+    for (const auto &field : layout.fields) {
+        if (field.offset + field.element_size * field.array_size > size) {
+            return decoded;
+        }
+
+        DecodedField entry {field.name, field.type, {}};
+        entry.values.reserve(field.array_size);
+
+        const uint8_t *src = data + field.offset;
+        for (uint32_t idx = 0u; idx < field.array_size; ++idx) {
+            entry.values.push_back(decodeElement(src, field.type));
+            src += field.element_size;
+        }
+
+        decoded.push_back(std::move(entry));
+    }
+
+    return decoded;
+}
+
+InterfaceRuntime *matchInterface(std::vector<InterfaceRuntime> &interfaces, const std::string &name,
+                                 const std::string &host_name) {
+    for (auto &iface : interfaces) {
+        if ((name.empty() || iface.def.name == name) && (host_name.empty() || iface.def.host_name == host_name)) {
+            return &iface;
+        }
+    }
+    return nullptr;
+}
+
+const DatasetLayout *matchLayout(const std::vector<DatasetLayout> &layouts, uint32_t dataset_id) {
+    for (const auto &layout : layouts) {
+        if (layout.dataset_id == dataset_id) {
+            return &layout;
+        }
+    }
+    return nullptr;
+}
+
+// A destination is an address (unicast or multicast) or the name of a host
+// emulated by the same configuration; anything else resolves to 0.
+TRDP_IP_ADDR_T resolveDestination(const PdTelegramDef &def, const std::vector<InterfaceRuntime> &interfaces) {
+    for (const auto &uri : def.destinations) {
+        const TRDP_IP_ADDR_T ip = vos_dottedIP(uri.c_str());
+        if (ip != 0u) {
+            return ip;
+        }
+        for (const auto &iface : interfaces) {
+            if (iface.def.host_name == uri) {
+                return vos_dottedIP(iface.def.host_ip.c_str());
+            }
+        }
+    }
+    return 0u;
+}
+
+}  // namespace
 
 void TrdpEngine::loadConfig(const std::string &xml_path, const std::string &host_name) {
+    loadConfig(xml_path, std::vector<std::string> {host_name}, nullptr);
+}
+
+void TrdpEngine::loadConfig(const std::string &xml_path, const std::vector<std::string> &host_names,
+                            ConfigLoadProgress *progress) {
+    TraceScope trace("loadConfig", "engine");
+    std::lock_guard<std::mutex> loadLock(load_mtx_);
+    const auto enter = [progress](ConfigLoadPhase phase) {
+        if (progress != nullptr && progress->on_phase) {
+            progress->on_phase(phase);
+        }
+    };
+
+    // Parse and Validate build the new configuration next to the running
+    // one; a failure there leaves the engine untouched.
+    enter(ConfigLoadPhase::Parse);
+    LoadedConfig staged;
+    staged.definitions = std::make_shared<PdDefinitions>();
+    {
+        TrdpConfigLoader loader;
+        loader.loadFromXml(xml_path, host_names);
+        // As given, "@ip" included, so a scenario reload binds the same
+        // addresses.
+        staged.host_names = host_names;
+        staged.memory = loader.memory();
+        staged.definitions->datasets = loader.datasets();
+        staged.definitions->pd_defs = loader.pdTelegrams();
+        for (const auto &ifaceDef : loader.interfaces()) {
+            InterfaceRuntime runtime {};
+            runtime.def = ifaceDef;
+            staged.interfaces.push_back(runtime);
+        }
+    }
+
+    enter(ConfigLoadPhase::Validate);
+    stageConfig(staged);
+
+    enter(ConfigLoadPhase::Stop);
+    // Everything that feeds the sessions or reads from them stops before
+    // they close. The replay thread sends under session_mtx_, so it is
+    // joined before that is taken.
+    stopReplay();
+    stopScenario();
+    stopCapture();
+    std::lock_guard<std::mutex> sessionLock(session_mtx_);
     const bool shouldRestart = running_;
-    if (shouldRestart || !interfaces_.empty()) {
+    const bool hadSessions = !interfaces_.empty();
+    if (shouldRestart || hadSessions) {
         stop();
     }
 
-    TrdpConfigLoader loader;
-    loader.loadFromXml(xml_path, host_name);
+    {
+        std::lock_guard<std::mutex> lock(md_mtx_);
+        md_responders_.clear();
+    }
+    md_sessions_.clear();
+    pd_pulls_.clear();
+
+    enter(ConfigLoadPhase::Open);
+    try {
+        openSessions(staged.interfaces, staged.pd_states, staged.memory, loopback_mode_);
+    } catch (const std::exception &ex) {
+        // The previous configuration is still intact, only its sessions were
+        // closed. Reopen them so a bad file never leaves the engine down.
+        if (!hadSessions) {
+            throw;
+        }
+        try {
+            openSessions(interfaces_, pd_states_, memory_config_, loopback_active_);
+        } catch (const std::exception &restoreEx) {
+            throw std::runtime_error(std::string(ex.what()) +
+                                     "; previous configuration could not be restored: " + restoreEx.what());
+        }
+        if (progress != nullptr) {
+            progress->rolled_back = true;
+        }
+        logEvent(LogModule::Config, LogLevel::Error, "config.rolled_back", {{"path", xml_path}, {"error", ex.what()}});
+        if (shouldRestart) {
+            start();
+        }
+        throw;
+    }
+
+    enter(ConfigLoadPhase::Activate);
+    // The previous configuration ends up in `staged` and is freed on return;
+    // snapshots still referring to it hold its definitions.
+    {
+        std::lock_guard<std::mutex> lock(state_mtx_);
+        pd_watches_.clear();
+
+        // Swapping moves whole buffers, so every pointer into the staged
+        // vectors (interfaces, states) stays valid.
+        host_names_.swap(staged.host_names);
+        std::swap(memory_config_, staged.memory);
+        definitions_ = std::exchange(staged.definitions, {});
+        interfaces_.swap(staged.interfaces);
+        loopback_active_ = !interfaces_.empty() && interfaces_.front().appHandle == nullptr;
+        pd_tx_slots_.swap(staged.pd_tx_slots);
+        pd_states_.swap(staged.pd_states);
+        pd_by_com_id_.swap(staged.pd_by_com_id);
+        std::swap(pd_arena_, staged.pd_arena);
+
+        resetHistories();
+        pd_generators_.reset(pd_tx_slots_.size());
+        loopback_.clear();
+
+        // Readers of the old segment see it retired and map the new one.
+        if (!shm_name_.empty()) {
+            openShmExport(engine_metrics_.config_loads.value() + 1u);
+        }
+    }
+    std::atomic_store(&telegram_metrics_, definitions_->metrics);
+    engine_metrics_.config_loads.add();
+    state_journal_.recordConfig(xml_path, host_names);
+    logEvent(LogModule::Config, LogLevel::Info, "config.loaded",
+             {{"path", xml_path}, {"hosts", host_names.size()}, {"interfaces", interfaces_.size()},
+              {"telegrams", pd_states_.size()}});
+
+    if (shouldRestart) {
+        start();
+    }
+}
+
+void TrdpEngine::stageConfig(LoadedConfig &staged) const {
+    PdDefinitions &defs = *staged.definitions;
+    defs.layouts.reserve(defs.datasets.size());
+    for (const auto &dataset : defs.datasets) {
+        defs.layouts.push_back(buildDatasetLayout(dataset));
+    }
+
+    defs.metrics = std::make_shared<TelegramMetricsTable>();
+    defs.metrics->reserve(defs.pd_defs.size());
+
+    staged.pd_states.reserve(defs.pd_defs.size());
+    size_t arenaSize = 0u;
+    size_t txSlotCount = 0u;
+    for (auto &pdDef : defs.pd_defs) {
+        defs.metrics->push_back(
+            std::make_unique<TelegramMetrics>(pdDef.com_id, pdDef.name, pdDef.interface_name, pdDef.host_name));
+
+        PdState state {};
+        state.def = &pdDef;
+        state.layout = matchLayout(defs.layouts, pdDef.dataset_id);
+        state.metrics = defs.metrics->back().get();
+        state.iface = matchInterface(staged.interfaces, pdDef.interface_name, pdDef.host_name);
+        if (state.iface == nullptr) {
+            throw std::runtime_error("Unknown interface for PD telegram");
+        }
+
+        // Payload slots are sized from the dataset. Without a complete
+        // layout the dataset length is unknown, so the protocol maximum is
+        // reserved instead.
+        const bool sized = state.layout != nullptr && state.layout->complete;
+        const uint32_t capacity = sized ? state.layout->size : kPdMaxPayload;
+        if (pdDef.direction != Direction::Sink) {
+            state.tx_capacity = capacity;
+            state.tx_size = state.layout != nullptr ? state.layout->size : 0u;
+            state.tx_slot = static_cast<uint32_t>(txSlotCount++);
+        } else {
+            state.tx_slot = kNoTxSlot;
+        }
+        if (pdDef.direction != Direction::Source) {
+            state.rx_capacity = capacity;
+            // Sources given as addresses are known before the first packet,
+            // so a redundant partner that never sends still shows up as
+            // standby. Host names cannot be matched against srcIpAddr.
+            for (const auto &source : pdDef.sources) {
+                for (const std::string *uri : {&source.uri1, &source.uri2}) {
+                    const TRDP_IP_ADDR_T ip = uri->empty() ? 0u : vos_dottedIP(uri->c_str());
+                    if (ip != 0u) {
+                        state.sources.expect(ip);
+                    }
+                }
+            }
+        }
+        arenaSize += PayloadArena::footprint(state.tx_capacity) + PayloadArena::footprint(state.rx_capacity);
+
+        staged.pd_states.push_back(state);
+    }
+
+    // Size each interface's receive buffer for kRxBacklogMs of its expected
+    // PD traffic, so a stalled processing loop drops nothing at the socket.
+    // Pull-only telegrams count as one packet.
+    std::vector<double> rxBytes(staged.interfaces.size(), 0.0);
+    for (const auto &state : staged.pd_states) {
+        if (state.rx_capacity == 0u) {
+            continue;
+        }
+        const double packets =
+            state.def->cycle_us > 0u ? kRxBacklogMs * 1000.0 / static_cast<double>(state.def->cycle_us) : 1.0;
+        rxBytes[static_cast<size_t>(state.iface - staged.interfaces.data())] +=
+            std::max(packets, 1.0) * static_cast<double>(state.rx_capacity + kRxPacketOverhead);
+    }
+    for (size_t idx = 0u; idx < staged.interfaces.size(); ++idx) {
+        staged.interfaces[idx].rx_buffer_bytes =
+            static_cast<uint32_t>(std::clamp(rxBytes[idx], static_cast<double>(kRxBufferMin), static_cast<double>(kRxBufferMax)));
+    }
+
+    staged.pd_arena.reset(arenaSize);
+    staged.pd_tx_slots.reserve(txSlotCount);
+    const auto now = clockNow();
+    for (auto &state : staged.pd_states) {
+        state.tx_payload = staged.pd_arena.carve(state.tx_capacity);
+        state.rx_payload = staged.pd_arena.carve(state.rx_capacity);
+        staged.pd_by_com_id[state.def->com_id].push_back(&state);
+
+        if (state.tx_slot != kNoTxSlot) {
+            PdTxSlot slot {};
+            slot.next_tx_due = now;
+            slot.cycle = state.def->pull ? std::chrono::microseconds(0) : std::chrono::microseconds(state.def->cycle_us);
+            slot.state = &state;
+            slot.metrics = state.metrics;
+            slot.enabled = true;
+            staged.pd_tx_slots.push_back(slot);
+        }
+    }
+}
 
-    datasets_ = loader.datasets();
-    pd_defs_ = loader.pdTelegrams();
+void TrdpEngine::openSessions(std::vector<InterfaceRuntime> &interfaces, std::vector<PdState> &states,
+                              const MemoryConfig &memory, bool loopback) {
+    if (loopback) {
+        // No stack at all: sends go to loopback_ and receptions are matched
+        // through pd_list exactly as for a real session.
+        for (auto &runtime : interfaces) {
+            runtime.appHandle = nullptr;
+            runtime.pd_list.clear();
+        }
+        for (auto &state : states) {
+            state.pub_handle = nullptr;
+            if (state.def->direction != Direction::Source) {
+                state.iface->pd_list.push_back(&state);
+            }
+        }
+        loopback_epoch_ = clockNow();
+        return;
+    }
 
-    interfaces_.clear();
-    pd_runtimes_.clear();
+    TRDP_MEM_CONFIG_T memConfig {};
+    memConfig.size = memory.size;
+    std::copy_n(memory.prealloc.begin(), std::min(memory.prealloc.size(), std::size(memConfig.prealloc)),
+                std::begin(memConfig.prealloc));
 
-    TRDP_ERR_T err = tlc_init(nullptr, this, nullptr);
+    TRDP_ERR_T err = tlc_init(nullptr, this, &memConfig);
     if (err != TRDP_NO_ERR) {
         throw std::runtime_error("tlc_init failed");
     }
 
-    for (const auto &ifaceDef : loader.interfaces()) {
-        InterfaceRuntime runtime {};
-        runtime.def = ifaceDef;
+    size_t opened = 0u;
+    const auto closeOpened = [&interfaces, &opened]() {
+        for (size_t idx = 0u; idx < opened; ++idx) {
+            tlc_closeSession(interfaces[idx].appHandle);
+        }
+        tlc_terminate();
+    };
+
+    for (auto &runtime : interfaces) {
+        const InterfaceDef &ifaceDef = runtime.def;
+        runtime.pd_list.clear();
 
         TRDP_PD_CONFIG_T pdConfig {};
         pdConfig.pfCbFunction = pdCallback;
         pdConfig.pRefCon = this;
+        pdConfig.sendParam.qos = ifaceDef.pd_qos;
+        pdConfig.sendParam.ttl = ifaceDef.pd_ttl;
+        pdConfig.timeout = ifaceDef.pd_timeout_us;
+        pdConfig.toBehavior = static_cast<TRDP_TO_BEHAVIOR_T>(ifaceDef.pd_to_behavior);
+        pdConfig.port = ifaceDef.pd_port;
 
         TRDP_MD_CONFIG_T mdConfig {};
         mdConfig.pfCbFunction = mdCallback;
         mdConfig.pRefCon = this;
+        mdConfig.flags = TRDP_FLAGS_CALLBACK;
+        mdConfig.replyTimeout = kMdDefaultReplyTimeoutUs;
+        mdConfig.confirmTimeout = kMdDefaultReplyTimeoutUs;
+        mdConfig.connectTimeout = 60000000u;
+        mdConfig.sendingTimeout = kMdDefaultReplyTimeoutUs;
+        mdConfig.udpPort = 17225u;
+        mdConfig.tcpPort = 17225u;
+        mdConfig.maxNumSessions = 4096u;
 
         TRDP_PROCESS_CONFIG_T processConfig {};
-        std::strncpy(processConfig.hostName, host_name.c_str(), sizeof(processConfig.hostName) - 1u);
-        processConfig.cycleTime = 100000u;
-        processConfig.options = TRDP_OPTION_BLOCK;
+        std::strncpy(processConfig.hostName, ifaceDef.host_name.c_str(), sizeof(processConfig.hostName) - 1u);
+        processConfig.cycleTime = ifaceDef.cycle_us > 0u ? ifaceDef.cycle_us : kProcessDefaultCycleUs;
+        processConfig.priority = ifaceDef.priority;
+        processConfig.options = static_cast<TRDP_OPTION_T>(ifaceDef.options | TRDP_OPTION_BLOCK);
 
         err = tlc_openSession(&runtime.appHandle,
                               vos_dottedIP(ifaceDef.host_ip.c_str()),
@@ -68,65 +446,116 @@ void TrdpEngine::loadConfig(const std::string &xml_path, const std::string &host
                               &mdConfig,
                               &processConfig);
         if (err != TRDP_NO_ERR) {
+            closeOpened();
             throw std::runtime_error("Failed to initialize TRDP session");
         }
-
-        interfaces_.push_back(runtime);
+        opened++;
     }
 
-    pd_runtimes_.reserve(pd_defs_.size());
-    for (auto &pdDef : pd_defs_) {
-        pd_runtimes_.push_back(PdRuntime {});
-        PdRuntime &runtime = pd_runtimes_.back();
-        runtime.def = &pdDef;
-        runtime.tx_enabled = pdDef.direction != Direction::Sink;
-        runtime.next_tx_due = std::chrono::steady_clock::now();
-        runtime.last_rx_valid = false;
-        runtime.rx_count = 0u;
-        runtime.tx_count = 0u;
-        runtime.timeout_count = 0u;
-        runtime.last_period_us = 0.0;
-        runtime.avg_period_us = 0.0;
+    for (auto &state : states) {
+        if (state.def->direction == Direction::Source) {
+            continue;
+        }
 
-        if (pdDef.direction != Direction::Source) {
-            InterfaceRuntime *iface = findInterface(pdDef.interface_name);
-            if (iface == nullptr) {
-                throw std::runtime_error("Unknown interface for PD telegram");
-            }
+        TRDP_COM_PARAM_T comParams {};
+        comParams.qos = state.def->qos;
+        comParams.ttl = state.def->ttl;
+        const uint32_t timeoutUs = pdTimeoutUs(*state.def);
+        // The state is handed back as pMsg->pUserRef, which saves the
+        // receive path a lookup. The states vector is never resized once
+        // staged, so the address stays valid.
+        err = tlp_subscribe(state.iface->appHandle,
+                            &state.sub_handle,
+                            &state,
+                            pdCallback,
+                            0u,
+                            state.def->com_id,
+                            0u,
+                            0u,
+                            0u,
+                            0u,
+                            0u,
+                            TRDP_FLAGS_CALLBACK,
+                            &comParams,
+                            timeoutUs,
+                            static_cast<TRDP_TO_BEHAVIOR_T>(state.def->to_behavior));
+        if (err != TRDP_NO_ERR) {
+            closeOpened();
+            throw std::runtime_error("Failed to subscribe PD telegram");
+        }
 
-            TRDP_SUB_T subHandle {};
-            TRDP_COM_PARAM_T comParams {};
-            err = tlp_subscribe(iface->appHandle,
-                                &subHandle,
-                                this,
-                                pdCallback,
-                                0u,
-                                pdDef.com_id,
-                                0u,
-                                0u,
-                                0u,
-                                0u,
-                                0u,
-                                TRDP_FLAGS_CALLBACK,
-                                &comParams,
-                                pdDef.cycle_us > 0u ? pdDef.cycle_us * 2u : 0u,
-                                TRDP_TO_DEFAULT);
-            if (err != TRDP_NO_ERR) {
-                throw std::runtime_error("Failed to subscribe PD telegram");
-            }
+        state.iface->pd_list.push_back(&state);
+    }
+
+    // The scheduler decides when a telegram goes out, so publications get no
+    // interval of their own and every due send is handed over explicitly
+    // (sendPdOnInterface). Pull replies are answered by the stack from the
+    // data last passed to tlp_put().
+    for (auto &state : states) {
+        state.pub_handle = nullptr;
+        if (state.def->direction == Direction::Sink) {
+            continue;
+        }
+        const TRDP_IP_ADDR_T destIp = resolveDestination(*state.def, interfaces);
+        if (destIp == 0u && !state.def->pull) {
+            logEvent(LogModule::PdTx, LogLevel::Warn, "pd.unpublished",
+                     {{"com_id", state.def->com_id}, {"host", state.def->host_name}});
+            continue;
+        }
 
-            iface->pd_list.push_back(&runtime);
+        TRDP_SEND_PARAM_T sendParams {};
+        sendParams.qos = state.def->qos;
+        sendParams.ttl = state.def->ttl;
+        err = tlp_publish(state.iface->appHandle,
+                          &state.pub_handle,
+                          &state,
+                          nullptr,
+                          0u,
+                          state.def->com_id,
+                          0u,
+                          0u,
+                          0u,
+                          destIp,
+                          0u,
+                          0u,
+                          TRDP_FLAGS_NONE,
+                          &sendParams,
+                          state.tx_size > 0u ? state.tx_payload : nullptr,
+                          state.tx_size);
+        if (err != TRDP_NO_ERR) {
+            closeOpened();
+            throw std::runtime_error("Failed to publish PD telegram");
         }
     }
 
-    if (shouldRestart) {
-        start();
+    // The stack creates the PD sockets while subscribing, so buffers are
+    // sized last.
+    for (auto &runtime : interfaces) {
+        applyRxBuffer(runtime.appHandle, runtime.rx_buffer_bytes);
     }
 }
 
+uint64_t TrdpEngine::submitConfigLoad(const std::string &xml_path, const std::vector<std::string> &host_names) {
+    return config_jobs_.submit(xml_path, host_names);
+}
+
+std::optional<ConfigJobStatus> TrdpEngine::configJob(uint64_t id) const { return config_jobs_.status(id); }
+
+std::vector<ConfigJobStatus> TrdpEngine::configJobs() const { return config_jobs_.list(); }
+
 void TrdpEngine::start() {
+    {
+        std::lock_guard<std::mutex> lock(state_mtx_);
+        const auto now = clockNow();
+        for (auto &slot : pd_tx_slots_) {
+            slot.next_tx_due = now;
+        }
+    }
+    engine_metrics_.scheduler_overrun.store(false, std::memory_order_relaxed);
+
     running_ = true;
     pd_thread_ = std::thread(&TrdpEngine::pdSchedulerLoop, this);
+    logEvent(LogModule::Engine, LogLevel::Info, "engine.started", {{"interfaces", interfaces_.size()}});
 }
 
 void TrdpEngine::stop() {
@@ -134,293 +563,1522 @@ void TrdpEngine::stop() {
 
     if (pd_thread_.joinable()) {
         pd_thread_.join();
+        logEvent(LogModule::Engine, LogLevel::Info, "engine.stopped");
     }
 
+    bool opened = false;
     for (auto &iface : interfaces_) {
-        tlc_closeSession(iface.appHandle);
+        if (iface.appHandle != nullptr) {
+            tlc_closeSession(iface.appHandle);
+            opened = true;
+        }
+    }
+
+    if (opened) {
+        tlc_terminate();
+    }
+}
+
+std::vector<PdRuntime> TrdpEngine::getPdSnapshot() const {
+    std::vector<PdRuntime> snapshot;
+    size_t bytes = 0u;
+
+    {
+        std::lock_guard<std::mutex> lock(state_mtx_);
+
+        snapshot.reserve(pd_states_.size());
+        for (const auto &state : pd_states_) {
+            PdRuntime runtime {};
+            runtime.definitions = definitions_;
+            runtime.def = state.def;
+            runtime.layout = state.layout;
+            runtime.metrics = state.metrics;
+            runtime.tx_payload.assign(state.tx_payload, state.tx_payload + state.tx_size);
+            if (state.tx_slot != kNoTxSlot) {
+                const PdTxSlot &slot = pd_tx_slots_[state.tx_slot];
+                runtime.tx_enabled = slot.enabled;
+                runtime.next_tx_due = slot.next_tx_due;
+                runtime.tx_count = slot.tx_count;
+                runtime.tx_missed_cycles = slot.missed_cycles;
+                runtime.tx_last_lateness_us = static_cast<double>(slot.last_lateness_ns) / 1000.0;
+            }
+            runtime.last_rx_payload.assign(state.rx_payload, state.rx_payload + state.rx_size);
+            runtime.last_rx_time = state.last_rx_time;
+            runtime.last_rx_valid = state.last_rx_valid;
+            runtime.rx_count = state.rx_count;
+            runtime.change_count = state.change_count;
+            runtime.last_change_time = state.last_change_time;
+            runtime.timeout_count = state.timeout_count;
+            runtime.last_period_us = state.last_period_us;
+            runtime.avg_period_us = state.avg_period_us;
+            runtime.sources = state.sources;
+
+            bytes += sizeof(PdRuntime) + state.tx_size + state.rx_size;
+            snapshot.push_back(std::move(runtime));
+        }
     }
 
-    tlc_terminate();
+    engine_metrics_.snapshot_bytes.observe(static_cast<double>(bytes));
+    return snapshot;
 }
 
-std::vector<PdRuntime> TrdpEngine::getPdSnapshot() const { return pd_runtimes_; }
+void TrdpEngine::enablePd(uint32_t com_id, bool enable, const std::string &host_name) {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+
+    if (PdState *state = findPdState(com_id, {}, host_name, true)) {
+        setTxEnabled(*state, enable, clockNow());
+        state_journal_.recordEnabled(com_id, state->def->host_name, enable);
+    }
+}
 
-void TrdpEngine::enablePd(uint32_t com_id, bool enable) {
+void TrdpEngine::setTxEnabled(PdState &state, bool enable, std::chrono::steady_clock::time_point now) {
+    PdTxSlot &slot = pd_tx_slots_[state.tx_slot];
+    // A re-enabled telegram starts a fresh timeline instead of counting the
+    // disabled period as missed cycles.
+    if (enable && !slot.enabled) {
+        slot.next_tx_due = now;
+    }
+    slot.enabled = enable;
+}
+
+void TrdpEngine::setPdValues(uint32_t com_id, const std::map<std::string, double> &values,
+                             const std::string &host_name) {
+    TraceScope trace("setPdValues", "engine", com_id);
     std::lock_guard<std::mutex> lock(state_mtx_);
 
-    if (PdRuntime *runtime = findPdRuntime(com_id, {})) {
-        runtime->tx_enabled = enable;
+    if (PdState *state = findPdState(com_id, {}, host_name, true)) {
+        patchPdValues(*state, values);
+        journalPayload(*state);
     }
 }
 
-void TrdpEngine::setPdValues(uint32_t com_id, const std::map<std::string, double> &values) {
+PdBatchResult TrdpEngine::setPdValuesBatch(const std::vector<PdValueUpdate> &updates) {
+    TraceScope trace("setPdValuesBatch", "engine", static_cast<int64_t>(updates.size()));
+    PdBatchResult result {};
+
     std::lock_guard<std::mutex> lock(state_mtx_);
 
-    PdRuntime *runtime = findPdRuntime(com_id, {});
-    if (runtime == nullptr || runtime->def == nullptr) {
-        return;
+    for (const auto &update : updates) {
+        PdState *state = findPdState(update.com_id, {}, update.host_name, true);
+        if (state == nullptr) {
+            result.unknown_com_ids.push_back(update.com_id);
+            continue;
+        }
+
+        result.updated_fields += patchPdValues(*state, update.values);
+        result.updated_telegrams++;
+        journalPayload(*state);
     }
 
-    const Dataset *dataset = findDataset(runtime->def->dataset_id);
-    if (dataset == nullptr) {
-        return;
+    return result;
+}
+
+void TrdpEngine::journalPayload(const PdState &pd) {
+    state_journal_.recordPayload(pd.def->com_id, pd.def->host_name, pd.tx_payload, pd.tx_size);
+}
+
+size_t TrdpEngine::patchPdValues(PdState &pd, const std::map<std::string, double> &values) {
+    if (pd.layout == nullptr) {
+        return 0u;
     }
 
-    std::vector<uint8_t> payload;
-    for (const auto &element : dataset->elements) {
-        const auto valueIt = values.find(element.name);
-        const double value = valueIt != values.end() ? valueIt->second : 0.0;
-        const auto count = element.array_size == 0u ? 1u : element.array_size;
+    padTxPayload(pd);
 
-        for (uint32_t idx = 0u; idx < count; ++idx) {
-            switch (element.type) {
-                case TRDP_BOOL8: {
-                    payload.push_back(value != 0.0 ? 1u : 0u);
-                    break;
-                }
-                case TRDP_UINT8: {
-                    payload.push_back(static_cast<uint8_t>(value));
-                    break;
-                }
-                case TRDP_INT8: {
-                    payload.push_back(static_cast<uint8_t>(static_cast<int8_t>(value)));
-                    break;
-                }
-                case TRDP_UINT16: {
-                    const uint16_t v = static_cast<uint16_t>(value);
-                    payload.push_back(static_cast<uint8_t>((v >> 8) & 0xFFu));
-                    payload.push_back(static_cast<uint8_t>(v & 0xFFu));
-                    break;
-                }
-                case TRDP_INT16: {
-                    const uint16_t v = static_cast<uint16_t>(static_cast<int16_t>(value));
-                    payload.push_back(static_cast<uint8_t>((v >> 8) & 0xFFu));
-                    payload.push_back(static_cast<uint8_t>(v & 0xFFu));
-                    break;
-                }
-                case TRDP_UINT32: {
-                    const uint32_t v = static_cast<uint32_t>(value);
-                    payload.push_back(static_cast<uint8_t>((v >> 24) & 0xFFu));
-                    payload.push_back(static_cast<uint8_t>((v >> 16) & 0xFFu));
-                    payload.push_back(static_cast<uint8_t>((v >> 8) & 0xFFu));
-                    payload.push_back(static_cast<uint8_t>(v & 0xFFu));
-                    break;
-                }
-                case TRDP_INT32: {
-                    const uint32_t v = static_cast<uint32_t>(static_cast<int32_t>(value));
-                    payload.push_back(static_cast<uint8_t>((v >> 24) & 0xFFu));
-                    payload.push_back(static_cast<uint8_t>((v >> 16) & 0xFFu));
-                    payload.push_back(static_cast<uint8_t>((v >> 8) & 0xFFu));
-                    payload.push_back(static_cast<uint8_t>(v & 0xFFu));
-                    break;
-                }
-                default: {
-                    // TODO: Handle additional data types
-                    break;
-                }
-            }
+    size_t patched = 0u;
+    for (const auto &entry : values) {
+        const FieldLayout *field = pd.layout->findField(entry.first);
+        if (field == nullptr) {
+            continue;
         }
+
+        encodeField(pd.tx_payload, *field, entry.second);
+        patched++;
     }
+    pd_tx_slots_[pd.tx_slot].data_changed = true;
 
-    runtime->tx_payload = std::move(payload);
+    return patched;
 }
 
 void TrdpEngine::pdSchedulerLoop() {
-    while (running_) {
-        const auto now = std::chrono::steady_clock::now();
+    constexpr auto tick = std::chrono::milliseconds(1u);
+    auto wake_target = std::chrono::steady_clock::now();
+    next_md_sweep_ = clockNow();
+    traceSetThreadName("pd-scheduler");
 
-        std::lock_guard<std::mutex> lock(state_mtx_);
-        for (auto &runtime : pd_runtimes_) {
-            if (!runtime.tx_enabled || runtime.def == nullptr || runtime.def->direction == Direction::Sink) {
-                continue;
-            }
+    while (running_) {
+        const auto woke = std::chrono::steady_clock::now();
+        engine_metrics_.scheduler_lateness_us.observe(
+            std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(woke - wake_target).count());
+
+        // Receive callbacks take their own locks, so the stack is driven
+        // before state_mtx_ is acquired.
+        const auto now = clockNow();
+        processSessions();
+        sendPdPulls(now);
+        // A load replaces the telegram table, so it runs as a config job
+        // rather than from inside the step.
+        if (const auto load = schedulerStep(now)) {
+            submitConfigLoad(load->path, load->host_names);
+        }
 
-            if (now >= runtime.next_tx_due) {
-                if (InterfaceRuntime *iface = findInterface(runtime.def->interface_name)) {
-                    sendPdOnInterface(*iface, runtime);
-                    runtime.tx_count++;
-                }
+        const auto workTime = std::chrono::steady_clock::now() - woke;
+        if (workTime > tick) {
+            engine_metrics_.scheduler_overruns.add();
+            engine_metrics_.scheduler_overrun.store(true, std::memory_order_relaxed);
+            logEvent(LogModule::Scheduler, LogLevel::Warn, "scheduler.overrun",
+                     {{"work_us", std::chrono::duration_cast<std::chrono::microseconds>(workTime).count()}});
+        }
 
-                runtime.next_tx_due = now + std::chrono::microseconds(runtime.def->cycle_us);
+        // Wake early for a scenario step that falls due within the tick.
+        std::chrono::steady_clock::duration sleep = tick;
+        {
+            std::lock_guard<std::mutex> lock(state_mtx_);
+            if (const auto due = nextScenarioDue()) {
+                sleep = std::max(std::chrono::steady_clock::duration::zero(), std::min(sleep, *due - clockNow()));
             }
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+        wake_target = std::chrono::steady_clock::now() + sleep;
+        std::this_thread::sleep_for(sleep);
     }
 }
 
-void TrdpEngine::onPdReceive(TRDP_APP_SESSION_T appHandle, const TRDP_PD_INFO_T *pMsg, const uint8_t *pData, uint32_t dataSize) {
-    if (pMsg == nullptr) {
-        return;
+std::optional<TrdpEngine::ScenarioRun::Step> TrdpEngine::schedulerStep(std::chrono::steady_clock::time_point now) {
+    if (now >= next_md_sweep_) {
+        for (const auto &expired : md_sessions_.expire(now)) {
+            publishMdResult(expired);
+        }
+        next_md_sweep_ = now + kMdSweepInterval;
     }
 
-    InterfaceRuntime *iface = nullptr;
-    for (auto &candidate : interfaces_) {
-        if (candidate.appHandle == appHandle) {
-            iface = &candidate;
-            break;
+    std::optional<ScenarioRun::Step> scenarioLoad;
+    {
+        TraceScope sweepTrace("txSweep", "scheduler");
+        std::lock_guard<std::mutex> lock(state_mtx_);
+        // Scenario steps go first so values set for this instant are in
+        // the payloads sent below.
+        if (scenario_.active) {
+            runScenario(now, scenarioLoad);
         }
-    }
+        for (auto &slot : pd_tx_slots_) {
+            if (slot.cycle.count() == 0) {
+                if (slot.data_changed) {
+                    updatePdOnInterface(*slot.state->iface, *slot.state);
+                    slot.data_changed = false;
+                }
+                continue;
+            }
+            if (!slot.enabled || slot.replaying || now < slot.next_tx_due) {
+                continue;
+            }
 
-    if (iface == nullptr) {
-        return;
-    }
+            TraceScope sendTrace("pd.tx", "pd", slot.state->def->com_id);
+            // Generators see the ideal due time, so their signals carry no
+            // scheduling jitter.
+            const auto slotIdx = static_cast<uint32_t>(&slot - pd_tx_slots_.data());
+            if (pd_generators_.hasGenerators(slotIdx)) {
+                padTxPayload(*slot.state);
+                pd_generators_.apply(slotIdx, slot.state->tx_payload, slot.next_tx_due);
+            }
 
-    PdRuntime *runtime = findPdRuntime(pMsg->comId, iface->def.name);
-    if (runtime == nullptr) {
-        return;
-    }
+            const auto sendTime = clockNow();
+            sendPdOnInterface(*slot.state->iface, *slot.state);
+            slot.tx_count++;
+            slot.metrics->tx.add();
+
+            const auto lateness = sendTime - slot.next_tx_due;
+            slot.last_lateness_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(lateness).count();
+            slot.metrics->tx_lateness_us.observe(static_cast<double>(slot.last_lateness_ns) / 1000.0);
+
+            // Advance on the ideal timeline so lateness never turns into
+            // drift. Due points that already passed are skipped and
+            // counted rather than sent in a burst.
+            const auto missed = static_cast<uint64_t>(lateness / slot.cycle);
+            if (missed > 0u) {
+                slot.missed_cycles += missed;
+                slot.metrics->tx_missed_cycles.add(missed);
+                logEvent(LogModule::PdTx, LogLevel::Warn, "pd.tx_missed",
+                         {{"com_id", slot.state->def->com_id}, {"host", slot.state->def->host_name},
+                          {"missed", missed}, {"lateness_us", slot.last_lateness_ns / 1000}});
+            }
+            slot.next_tx_due += slot.cycle * static_cast<int64_t>(missed + 1u);
 
-    const auto now = std::chrono::steady_clock::now();
+            if (shm_export_.active()) {
+                shm_export_.writeTx(static_cast<uint32_t>(slot.state - pd_states_.data()), *slot.state, slot,
+                                    sendTime);
+            }
+        }
+    }
 
-    std::lock_guard<std::mutex> lock(state_mtx_);
+    // Loopback traffic and timeouts stand in for what the stack delivers
+    // from tlc_process() on real sessions.
+    if (loopback_active_) {
+        deliverLoopback();
+        expireLoopbackTimeouts(now);
+    }
 
-    runtime->last_rx_payload.assign(pData, pData + dataSize);
+    return scenarioLoad;
+}
 
-    if (runtime->last_rx_valid) {
-        runtime->last_period_us = std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(now - runtime->last_rx_time).count();
-        const auto new_count = runtime->rx_count + 1u;
-        runtime->avg_period_us += (runtime->last_period_us - runtime->avg_period_us) / static_cast<double>(new_count);
-    } else {
-        runtime->last_period_us = 0.0;
-        runtime->avg_period_us = runtime->last_period_us;
+void TrdpEngine::deliverLoopback() {
+    {
+        std::lock_guard<std::mutex> lock(state_mtx_);
+        if (loopback_.empty()) {
+            return;
+        }
+        loopback_.drain(loopback_batch_);
     }
 
-    runtime->last_rx_time = now;
-    runtime->last_rx_valid = true;
-    runtime->rx_count++;
+    // Every other telegram with the comId on a loopback interface receives
+    // the packet, as if all interfaces shared one segment.
+    for (const auto &packet : loopback_batch_.packets) {
+        const auto receivers = pd_by_com_id_.find(packet.com_id);
+        if (receivers == pd_by_com_id_.end()) {
+            continue;
+        }
+        for (PdState *state : receivers->second) {
+            if (state == packet.sender || state->rx_capacity == 0u || state->iface->appHandle != nullptr) {
+                continue;
+            }
+            TRDP_PD_INFO_T info {};
+            info.srcIpAddr = vos_dottedIP(packet.sender->iface->def.host_ip.c_str());
+            info.seqCount = packet.seq_count;
+            info.comId = packet.com_id;
+            info.msgType = TRDP_MSG_PD;
+            info.resultCode = TRDP_NO_ERR;
+            info.pUserRef = state;
+            receivePd(*state->iface, info, loopback_batch_.payload(packet), packet.size);
+        }
+    }
 }
 
-std::vector<DecodedField> TrdpEngine::decodeLastRx(const PdRuntime &pd) const {
-    std::vector<DecodedField> decoded;
+void TrdpEngine::expireLoopbackTimeouts(std::chrono::steady_clock::time_point now) {
+    loopback_expired_.clear();
+    {
+        std::lock_guard<std::mutex> lock(state_mtx_);
+        for (auto &state : pd_states_) {
+            const auto deadline = loopbackTimeoutDeadline(state);
+            if (deadline && now >= *deadline) {
+                loopback_expired_.push_back(&state);
+            }
+        }
+    }
 
-    if (pd.def == nullptr) {
-        return decoded;
+    for (PdState *state : loopback_expired_) {
+        TRDP_PD_INFO_T info {};
+        info.comId = state->def->com_id;
+        info.msgType = TRDP_MSG_PD;
+        info.resultCode = TRDP_TIMEOUT_ERR;
+        info.pUserRef = state;
+        receivePd(*state->iface, info, nullptr, 0u);
     }
+}
 
-    const Dataset *dataset = findDataset(pd.def->dataset_id);
-    if (dataset == nullptr) {
-        return decoded;
+std::optional<std::chrono::steady_clock::time_point> TrdpEngine::loopbackTimeoutDeadline(const PdState &state) const {
+    const uint32_t timeoutUs = pdTimeoutUs(*state.def);
+    if (state.rx_capacity == 0u || state.rx_timed_out || timeoutUs == 0u || state.iface->appHandle != nullptr) {
+        return std::nullopt;
     }
+    // Like a subscription, a telegram that never arrived times out counted
+    // from when it was set up.
+    const auto since = state.last_rx_valid ? state.last_rx_time : loopback_epoch_;
+    return since + std::chrono::microseconds(timeoutUs);
+}
 
-    const auto &payload = pd.last_rx_payload;
-    size_t offset = 0u;
+void TrdpEngine::runFor(std::chrono::nanoseconds duration) {
+    auto *clock = dynamic_cast<VirtualClock *>(clock_.get());
+    if (clock == nullptr) {
+        throw std::runtime_error("runFor needs a virtual clock");
+    }
+    if (running_) {
+        throw std::runtime_error("runFor cannot be used while the scheduler is running");
+    }
 
-    auto hasBytes = [&](size_t count) { return offset + count <= payload.size(); };
+    std::unique_lock<std::mutex> sessionLock(session_mtx_);
+    if (!loopback_active_) {
+        throw std::runtime_error("runFor needs a configuration loaded in loopback mode");
+    }
 
-    for (const auto &element : dataset->elements) {
-        const uint32_t count = element.array_size == 0u ? 1u : element.array_size;
-        DecodedField field {element.name, element.type, {}};
-        field.values.reserve(count);
+    const auto end = clock->now() + duration;
+    while (true) {
+        const auto now = clock->now();
+        if (const auto load = schedulerStep(now)) {
+            // Loaded here rather than as a config job, so the new
+            // configuration starts at this virtual instant. loadConfig()
+            // takes load_mtx_ ahead of session_mtx_.
+            sessionLock.unlock();
+            loadConfig(load->path, load->host_names);
+            sessionLock.lock();
+            if (!loopback_active_) {
+                throw std::runtime_error("runFor: scenario loaded a configuration outside loopback mode");
+            }
+        }
+        if (now >= end) {
+            break;
+        }
 
-        for (uint32_t idx = 0u; idx < count; ++idx) {
-            switch (element.type) {
-                case TRDP_BOOL8:
-                case TRDP_UINT8: {
-                    if (!hasBytes(1u)) {
-                        return decoded;
-                    }
-                    field.values.push_back(static_cast<int64_t>(payload[offset]));
-                    offset += 1u;
-                    break;
-                }
-                case TRDP_INT8: {
-                    if (!hasBytes(1u)) {
-                        return decoded;
-                    }
-                    field.values.push_back(static_cast<int64_t>(static_cast<int8_t>(payload[offset])));
-                    offset += 1u;
-                    break;
-                }
-                case TRDP_UINT16: {
-                    if (!hasBytes(2u)) {
-                        return decoded;
-                    }
-                    const uint16_t value = static_cast<uint16_t>((static_cast<uint16_t>(payload[offset]) << 8u) |
-                                                                  static_cast<uint16_t>(payload[offset + 1u]));
-                    field.values.push_back(static_cast<int64_t>(value));
-                    offset += 2u;
-                    break;
-                }
-                case TRDP_INT16: {
-                    if (!hasBytes(2u)) {
-                        return decoded;
-                    }
-                    const int16_t value = static_cast<int16_t>((static_cast<uint16_t>(payload[offset]) << 8u) |
-                                                               static_cast<uint16_t>(payload[offset + 1u]));
-                    field.values.push_back(static_cast<int64_t>(value));
-                    offset += 2u;
-                    break;
-                }
-                case TRDP_UINT32: {
-                    if (!hasBytes(4u)) {
-                        return decoded;
-                    }
-                    const uint32_t value = (static_cast<uint32_t>(payload[offset]) << 24u) |
-                                           (static_cast<uint32_t>(payload[offset + 1u]) << 16u) |
-                                           (static_cast<uint32_t>(payload[offset + 2u]) << 8u) |
-                                           static_cast<uint32_t>(payload[offset + 3u]);
-                    field.values.push_back(static_cast<int64_t>(value));
-                    offset += 4u;
-                    break;
-                }
-                case TRDP_INT32: {
-                    if (!hasBytes(4u)) {
-                        return decoded;
-                    }
-                    const int32_t value = (static_cast<uint32_t>(payload[offset]) << 24u) |
-                                          (static_cast<uint32_t>(payload[offset + 1u]) << 16u) |
-                                          (static_cast<uint32_t>(payload[offset + 2u]) << 8u) |
-                                          static_cast<uint32_t>(payload[offset + 3u]);
-                    field.values.push_back(static_cast<int64_t>(value));
-                    offset += 4u;
-                    break;
+        // Jump straight to the next due send or timeout; nothing can happen
+        // in between.
+        auto next = end;
+        {
+            std::lock_guard<std::mutex> lock(state_mtx_);
+            for (const auto &slot : pd_tx_slots_) {
+                if (slot.enabled && slot.cycle.count() != 0) {
+                    next = std::min(next, slot.next_tx_due);
                 }
-                default: {
-                    return decoded;
+            }
+            for (const auto &state : pd_states_) {
+                if (const auto deadline = loopbackTimeoutDeadline(state)) {
+                    next = std::min(next, *deadline);
                 }
             }
+            if (const auto due = nextScenarioDue()) {
+                next = std::min(next, *due);
+            }
         }
-
-        decoded.push_back(std::move(field));
+        clock->set(std::max(next, now + std::chrono::nanoseconds(1)));
     }
-
-    return decoded;
 }
 
-void TrdpEngine::sendPdOnInterface(InterfaceRuntime &iface, PdRuntime &pd_runtime) {
-    // TODO: Integrate TRDP PD send API
-    (void)iface;
-    (void)pd_runtime;
-}
-
-InterfaceRuntime *TrdpEngine::findInterface(const std::string &name) {
+void TrdpEngine::processSessions() {
+    TraceScope trace("processSessions", "scheduler");
     for (auto &iface : interfaces_) {
-        if (iface.def.name == name) {
-            return &iface;
+        if (iface.appHandle == nullptr) {
+            continue;
+        }
+        TRDP_FDS_T readable;
+        FD_ZERO(&readable);
+        TRDP_TIME_T interval {};
+        TRDP_SOCK_T highest = -1;
+        tlc_getInterval(iface.appHandle, &interval, &readable, &highest);
+
+        // Poll only; the scheduler tick provides the pacing.
+        VOS_TIMEVAL_T poll {0, 0};
+        INT32 ready = vos_select(highest + 1, &readable, nullptr, nullptr, &poll);
+        if (ready < 0) {
+            ready = 0;
+            FD_ZERO(&readable);
         }
+        tlc_process(iface.appHandle, &readable, &ready);
     }
-    return nullptr;
 }
 
-PdRuntime *TrdpEngine::findPdRuntime(uint32_t com_id, const std::string &if_name) {
-    for (auto &pd : pd_runtimes_) {
-        if (pd.def != nullptr && pd.def->com_id == com_id && (if_name.empty() || pd.def->interface_name == if_name)) {
-            return &pd;
+void TrdpEngine::sendPdPulls(std::chrono::steady_clock::time_point now) {
+    for (const auto &send : pd_pulls_.collectDue(now)) {
+        const TRDP_ERR_T err = tlp_request(send.appHandle,
+                                           send.subHandle,
+                                           0u,
+                                           send.com_id,
+                                           0u,
+                                           0u,
+                                           0u,
+                                           send.dest_ip,
+                                           0u,
+                                           TRDP_FLAGS_CALLBACK,
+                                           nullptr,
+                                           nullptr,
+                                           0u,
+                                           send.reply_com_id,
+                                           0u);
+        if (err != TRDP_NO_ERR) {
+            pd_pulls_.markFailed(send.id);
         }
     }
-    return nullptr;
 }
 
-const Dataset *TrdpEngine::findDataset(uint32_t id) const {
-    for (const auto &dataset : datasets_) {
-        if (dataset.id == id) {
-            return &dataset;
+void TrdpEngine::onPdReceive(TRDP_APP_SESSION_T appHandle, const TRDP_PD_INFO_T *pMsg, const uint8_t *pData, uint32_t dataSize) {
+    if (pMsg == nullptr) {
+        return;
+    }
+
+    for (auto &candidate : interfaces_) {
+        if (candidate.appHandle == appHandle) {
+            receivePd(candidate, *pMsg, pData, dataSize);
+            return;
         }
     }
+}
 
-    return nullptr;
+bool TrdpEngine::injectPd(const TRDP_PD_INFO_T &info, const uint8_t *data, uint32_t size, const std::string &if_name,
+                          const std::string &host_name) {
+    std::lock_guard<std::mutex> sessionLock(session_mtx_);
+    InterfaceRuntime *iface = findInterface(if_name, host_name);
+    if (iface == nullptr) {
+        return false;
+    }
+
+    // pUserRef is only meaningful for packets from the stack.
+    TRDP_PD_INFO_T injected = info;
+    injected.pUserRef = nullptr;
+    receivePd(*iface, injected, data, size);
+    return true;
 }
 
-}  // namespace trdp
+void TrdpEngine::receivePd(InterfaceRuntime &iface, const TRDP_PD_INFO_T &msg, const uint8_t *pData, uint32_t dataSize) {
+    const TRDP_PD_INFO_T *pMsg = &msg;
+    TraceScope trace("pd.rx", "pd", pMsg->comId);
+    const auto started = std::chrono::steady_clock::now();
+    const auto now = clockNow();
+    if (recorder_.active() && pMsg->resultCode == TRDP_NO_ERR) {
+        const auto wallNs =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        recorder_.append(PdCaptureRecord {static_cast<uint64_t>(wallNs),
+                                          pMsg->comId,
+                                          pMsg->seqCount,
+                                          pMsg->srcIpAddr,
+                                          pMsg->destIpAddr,
+                                          static_cast<uint16_t>(pMsg->msgType),
+                                          static_cast<uint16_t>(&iface - interfaces_.data()),
+                                          pData,
+                                          pData != nullptr ? dataSize : 0u});
+    }
+
+    if (pMsg->msgType == TRDP_MSG_PP && pMsg->resultCode == TRDP_NO_ERR) {
+        pd_pulls_.matchReply(iface.appHandle, pMsg->comId, pMsg->srcIpAddr, now);
+    }
 
+    PdState *state = static_cast<PdState *>(pMsg->pUserRef);
+    if (state == nullptr) {
+        for (PdState *candidate : iface.pd_list) {
+            if (candidate->def->com_id == pMsg->comId) {
+                state = candidate;
+                break;
+            }
+        }
+    }
+    if (state == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(state_mtx_);
+
+    if (pMsg->resultCode == TRDP_TIMEOUT_ERR) {
+        if (!state->rx_timed_out) {
+            logEvent(LogModule::PdRx, LogLevel::Warn, "pd.timeout",
+                     {{"com_id", state->def->com_id}, {"host", state->def->host_name},
+                      {"interface", state->def->interface_name}, {"timeout_us", pdTimeoutUs(*state->def)}});
+        }
+        state->timeout_count++;
+        state->rx_timed_out = true;
+        state->metrics->timeouts.add();
+        if (shm_export_.active()) {
+            shm_export_.writeRx(static_cast<uint32_t>(state - pd_states_.data()), *state, true);
+        }
+        if (!pd_subscribers_.empty()) {
+            PdRxView view = rxView(*state);
+            view.timeout = true;
+            pd_subscribers_.dispatch(view);
+        }
+        return;
+    }
+
+    // A source takes over once the active one has been silent for more
+    // than one and a half cycles; without a cycle any change counts.
+    PdSource &source = state->sources.lookup(pMsg->srcIpAddr);
+    PdSwitchover switched {};
+    if (state->sources.receive(source, now, std::chrono::microseconds(state->def->cycle_us * 3u / 2u), switched)) {
+        const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+        state->metrics->switchovers.add();
+        state->metrics->switchover_gap_us.observe(static_cast<double>(switched.gap_ns) / 1000.0);
+        if (switchovers_.size() >= kSwitchoverHistory) {
+            switchovers_.pop_front();
+        }
+        switchovers_.push_back(PdSwitchoverEvent {state->def->com_id, state->def->interface_name, state->def->host_name,
+                                                  switched.from_ip, switched.to_ip, nowNs, switched.gap_ns});
+        logEvent(LogModule::PdRx, LogLevel::Info, "pd.switchover",
+                 {{"com_id", state->def->com_id}, {"from_ip", switched.from_ip}, {"to_ip", switched.to_ip},
+                  {"gap_us", switched.gap_ns / 1000}});
+    }
+    // Pull replies come from their own counter on the publisher side, so
+    // only cyclic PD feeds the sequence statistics.
+    if (pMsg->msgType == TRDP_MSG_PD) {
+        uint32_t burst = 0u;
+        switch (source.seq.track(pMsg->seqCount, burst)) {
+            case SeqOutcome::Gap:
+                state->metrics->rx_lost.add(burst);
+                state->metrics->rx_loss_burst.observe(static_cast<double>(burst));
+                logEvent(LogModule::PdRx, LogLevel::Warn, "pd.seq_gap",
+                         {{"com_id", state->def->com_id}, {"src_ip", pMsg->srcIpAddr}, {"seq", pMsg->seqCount},
+                          {"lost", burst}});
+                break;
+            case SeqOutcome::Duplicate:
+                state->metrics->rx_duplicates.add();
+                break;
+            case SeqOutcome::Reordered:
+                state->metrics->rx_reordered.add();
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Bytes beyond the dataset length cannot be decoded and are dropped.
+    // Most telegrams repeat the same payload cycle after cycle, so only a
+    // payload that differs is stored and announced.
+    const uint32_t size = pData != nullptr ? std::min(dataSize, state->rx_capacity) : 0u;
+    const bool changed = !state->last_rx_valid || size != state->rx_size ||
+                         (size > 0u && std::memcmp(state->rx_payload, pData, size) != 0);
+    if (changed) {
+        if (size > 0u) {
+            std::memcpy(state->rx_payload, pData, size);
+        }
+        state->rx_size = size;
+        state->change_count++;
+        state->last_change_time = now;
+        const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+        pd_changes_.publish(pMsg->comId, pMsg->srcIpAddr, nowNs, pData, size);
+
+        if (state->watch_count > 0u) {
+            pd_watches_.evaluate(state, state->rx_payload, size, nowNs, watch_fired_);
+            if (!watch_fired_.empty()) {
+                std::lock_guard<std::mutex> watchLock(watch_mtx_);
+                if (watch_handler_) {
+                    for (const auto &event : watch_fired_) {
+                        watch_handler_(event);
+                    }
+                }
+                watch_fired_.clear();
+            }
+        }
+    }
+    histories_[static_cast<size_t>(state - pd_states_.data())].push(now, pData, dataSize);
+
+    if (state->last_rx_valid) {
+        state->last_period_us = std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(now - state->last_rx_time).count();
+        const auto new_count = state->rx_count + 1u;
+        state->avg_period_us += (state->last_period_us - state->avg_period_us) / static_cast<double>(new_count);
+        state->metrics->rx_period_us.observe(state->last_period_us);
+    } else {
+        state->last_period_us = 0.0;
+        state->avg_period_us = state->last_period_us;
+    }
+
+    if (state->rx_timed_out) {
+        logEvent(LogModule::PdRx, LogLevel::Info, "pd.recovered",
+                 {{"com_id", state->def->com_id}, {"host", state->def->host_name}, {"src_ip", pMsg->srcIpAddr}});
+    }
+    state->last_rx_time = now;
+    state->last_rx_valid = true;
+    state->rx_timed_out = false;
+    state->last_src_ip = pMsg->srcIpAddr;
+    state->last_seq = pMsg->seqCount;
+    state->rx_count++;
+    state->metrics->rx.add();
+
+    if (shm_export_.active()) {
+        shm_export_.writeRx(static_cast<uint32_t>(state - pd_states_.data()), *state);
+    }
+    if (!pd_subscribers_.empty()) {
+        PdRxView view = rxView(*state);
+        view.changed = changed;
+        pd_subscribers_.dispatch(view);
+    }
+
+    engine_metrics_.rx_callback_ns.observe(static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count()));
+}
+
+void TrdpEngine::setClock(std::shared_ptr<EngineClock> clock) {
+    if (running_) {
+        throw std::runtime_error("The clock cannot be changed while the scheduler is running");
+    }
+    clock_ = clock != nullptr ? std::move(clock) : std::make_shared<SteadyEngineClock>();
+}
+
+void TrdpEngine::setLoopback(bool enable) {
+    std::lock_guard<std::mutex> loadLock(load_mtx_);
+    loopback_mode_ = enable;
+}
+
+void TrdpEngine::setShmExport(const std::string &name) {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    shm_name_ = name;
+    if (name.empty()) {
+        shm_export_.close();
+        shm_error_.clear();
+        return;
+    }
+    openShmExport(engine_metrics_.config_loads.value());
+}
+
+PdShmStatus TrdpEngine::shmExportStatus() const {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    PdShmStatus status = shm_export_.status();
+    status.error = shm_error_;
+    return status;
+}
+
+void TrdpEngine::openShmExport(uint64_t generation) {
+    // A failed export never takes the engine down; the error is reported
+    // through shmExportStatus() instead.
+    try {
+        shm_export_.open(shm_name_, pd_states_, generation);
+        shm_error_.clear();
+    } catch (const std::exception &ex) {
+        shm_error_ = ex.what();
+        return;
+    }
+
+    // Seed the slots so readers start from the current state rather than
+    // zeros until the next packet.
+    for (size_t idx = 0u; idx < pd_states_.size(); ++idx) {
+        const PdState &state = pd_states_[idx];
+        if (state.rx_capacity > 0u) {
+            shm_export_.writeRx(static_cast<uint32_t>(idx), state);
+        }
+        if (state.tx_slot != kNoTxSlot) {
+            shm_export_.writeTx(static_cast<uint32_t>(idx), state, pd_tx_slots_[state.tx_slot], {});
+        }
+    }
+}
+
+JournalState TrdpEngine::openStateJournal(const std::string &path) { return state_journal_.open(path); }
+
+size_t TrdpEngine::restoreState(const JournalState &state) {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+
+    size_t restored = 0u;
+    const auto now = clockNow();
+    for (const auto &telegram : state.telegrams) {
+        PdState *pd = findPdState(telegram.com_id, {}, telegram.host_name, true);
+        if (pd == nullptr) {
+            continue;
+        }
+        if (telegram.has_payload) {
+            pd->tx_size = static_cast<uint32_t>(std::min<size_t>(telegram.payload.size(), pd->tx_capacity));
+            std::memcpy(pd->tx_payload, telegram.payload.data(), pd->tx_size);
+            pd_tx_slots_[pd->tx_slot].data_changed = true;
+            journalPayload(*pd);
+        }
+        if (telegram.has_enabled) {
+            setTxEnabled(*pd, telegram.enabled, now);
+            state_journal_.recordEnabled(pd->def->com_id, pd->def->host_name, telegram.enabled);
+        }
+        restored++;
+    }
+    return restored;
+}
+
+StateJournalStatus TrdpEngine::stateJournalStatus() const { return state_journal_.status(); }
+
+void TrdpEngine::setHistoryDepth(size_t depth) {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    history_depth_ = depth;
+    resetHistories();
+}
+
+HistoryResult TrdpEngine::queryHistory(const HistoryQuery &query) const {
+    HistoryResult result {};
+    std::vector<SeriesPoint> raw;
+
+    {
+        std::lock_guard<std::mutex> lock(state_mtx_);
+
+        const PdState *state = findPdState(query.com_id, query.interface_name, query.host_name, false);
+        if (state == nullptr || state->layout == nullptr) {
+            result.error = "Unknown PD telegram";
+            return result;
+        }
+
+        const FieldLayout *field = state->layout->findField(query.field);
+        if (field == nullptr || query.index >= field->array_size) {
+            result.error = "Unknown dataset field";
+            return result;
+        }
+
+        const size_t offset = field->offset + static_cast<size_t>(query.index) * field->element_size;
+        const size_t end = offset + field->element_size;
+        const auto &history = histories_[static_cast<size_t>(state - pd_states_.data())];
+
+        raw.reserve(history.size());
+        history.forEach([&](int64_t t_us, const uint8_t *data, uint32_t valid) {
+            if (t_us < query.from_us || t_us > query.to_us || valid < end) {
+                return;
+            }
+            raw.push_back(SeriesPoint {t_us, static_cast<double>(decodeElement(data + offset, field->type))});
+        });
+    }
+
+    result.raw_points = raw.size();
+    result.points = downsample(raw, query.max_points, query.mode);
+    return result;
+}
+
+void TrdpEngine::resetHistories() {
+    histories_.resize(pd_states_.size());
+    for (size_t idx = 0u; idx < pd_states_.size(); ++idx) {
+        const PdState &state = pd_states_[idx];
+        const bool receives = state.def != nullptr && state.def->direction != Direction::Source;
+        const size_t payloadSize = state.layout != nullptr ? state.layout->size : 0u;
+        histories_[idx].reset(receives && payloadSize > 0u ? history_depth_ : 0u, payloadSize);
+    }
+}
+
+void TrdpEngine::startCapture(const std::string &path, uint32_t slot_count) {
+    std::vector<CaptureInterface> captureInterfaces;
+    {
+        std::lock_guard<std::mutex> lock(state_mtx_);
+        captureInterfaces.reserve(interfaces_.size());
+        for (const auto &iface : interfaces_) {
+            captureInterfaces.push_back(CaptureInterface {interfaceLabel(iface), vos_dottedIP(iface.def.host_ip.c_str())});
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(capture_mtx_);
+    recorder_.start(path, slot_count, captureInterfaces);
+}
+
+void TrdpEngine::stopCapture() {
+    std::lock_guard<std::mutex> lock(capture_mtx_);
+    recorder_.stop();
+}
+
+PdCaptureStatus TrdpEngine::captureStatus() const {
+    std::lock_guard<std::mutex> lock(capture_mtx_);
+    return recorder_.status();
+}
+
+void TrdpEngine::startReplay(const ReplayOptions &options) {
+    // Like startScenario(), so a load cannot run between its stopReplay()
+    // and the swap with a replay started in between.
+    std::lock_guard<std::mutex> loadLock(load_mtx_);
+    std::lock_guard<std::mutex> lock(replay_mtx_);
+    replayer_.start(
+        options,
+        [this](uint32_t com_id, const std::string &if_name, const uint8_t *data, uint32_t size) {
+            return replayPd(com_id, if_name, data, size);
+        },
+        ReplayHooks {[this](const std::vector<ReplayTelegram> &telegrams) { markReplaying(telegrams); },
+                     [this] { clearReplaying(); }});
+}
+
+void TrdpEngine::stopReplay() {
+    std::lock_guard<std::mutex> lock(replay_mtx_);
+    replayer_.stop();
+}
+
+ReplayStatus TrdpEngine::replayStatus() const {
+    std::lock_guard<std::mutex> lock(replay_mtx_);
+    return replayer_.status();
+}
+
+void TrdpEngine::startScenario(const ScenarioOptions &options) {
+    Scenario scenario;
+    if (!options.text.empty()) {
+        std::istringstream input(options.text);
+        scenario = parseScenario(input);
+    } else {
+        scenario = loadScenarioFile(options.path);
+    }
+    if (scenario.length_us == 0u && options.loops != 1u) {
+        throw std::runtime_error("A looping scenario needs a non-zero length; add an end step");
+    }
+
+    // Binding under load_mtx_ keeps a concurrent load from swapping the
+    // telegram table between its stopScenario() and the swap.
+    std::lock_guard<std::mutex> loadLock(load_mtx_);
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    ScenarioRun run {};
+    run.steps.reserve(scenario.steps.size());
+    for (const auto &step : scenario.steps) {
+        const std::string where = "Scenario line " + std::to_string(step.line) + ": ";
+        ScenarioRun::Step bound {};
+        bound.offset = std::chrono::microseconds(step.offset_us);
+        bound.action = step.action;
+        bound.state = nullptr;
+
+        if (step.action == ScenarioAction::Load) {
+            bound.path = step.path;
+            bound.host_names = step.host_names.empty() ? host_names_ : step.host_names;
+            run.steps.push_back(std::move(bound));
+            continue;
+        }
+
+        bound.state = findPdState(step.com_id, {}, step.host_name, true);
+        if (bound.state == nullptr) {
+            throw std::runtime_error(where + "no sent PD telegram with comId " + std::to_string(step.com_id));
+        }
+        if (step.action == ScenarioAction::Set) {
+            if (bound.state->layout == nullptr) {
+                throw std::runtime_error(where + "comId " + std::to_string(step.com_id) + " has no dataset layout");
+            }
+            for (const auto &value : step.values) {
+                const FieldLayout *field = bound.state->layout->findField(value.first);
+                if (field == nullptr) {
+                    throw std::runtime_error(where + "unknown field '" + value.first + "'");
+                }
+                bound.values.push_back({field, value.second});
+            }
+        }
+        run.steps.push_back(std::move(bound));
+    }
+
+    run.active = true;
+    run.path = options.text.empty() ? options.path : std::string();
+    run.length = std::chrono::microseconds(scenario.length_us);
+    run.loops = options.loops;
+    run.started = run.pass_start = clockNow();
+    scenario_ = std::move(run);
+}
+
+void TrdpEngine::stopScenario() {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    if (scenario_.active) {
+        scenario_.active = false;
+        scenario_.ended = clockNow();
+        scenario_.steps.clear();
+    }
+}
+
+ScenarioStatus TrdpEngine::scenarioStatus() const {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    ScenarioStatus status {};
+    status.active = scenario_.active;
+    status.path = scenario_.path;
+    status.steps = scenario_.steps.size();
+    status.executed = scenario_.executed;
+    status.loops = scenario_.loops;
+    status.passes_done = scenario_.passes_done;
+    const auto until = scenario_.active ? clockNow() : scenario_.ended;
+    status.elapsed_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(until - scenario_.started).count());
+    status.max_lateness_us = scenario_.max_lateness_us;
+    return status;
+}
+
+void TrdpEngine::runScenario(std::chrono::steady_clock::time_point now, std::optional<ScenarioRun::Step> &load) {
+    ScenarioRun &run = scenario_;
+    while (run.active) {
+        if (run.next == run.steps.size()) {
+            const auto passEnd = run.pass_start + run.length;
+            if (now < passEnd) {
+                return;
+            }
+            run.passes_done++;
+            if (run.loops != 0u && run.passes_done >= run.loops) {
+                run.active = false;
+                run.ended = passEnd;
+                run.steps.clear();
+                return;
+            }
+            // The next pass starts on the ideal timeline, like TX cycles.
+            run.pass_start = passEnd;
+            run.next = 0u;
+            continue;
+        }
+
+        const ScenarioRun::Step &step = run.steps[run.next];
+        const auto due = run.pass_start + step.offset;
+        if (now < due) {
+            return;
+        }
+
+        switch (step.action) {
+            case ScenarioAction::Set:
+                padTxPayload(*step.state);
+                for (const auto &value : step.values) {
+                    encodeField(step.state->tx_payload, *value.field, value.value);
+                }
+                pd_tx_slots_[step.state->tx_slot].data_changed = true;
+                break;
+            case ScenarioAction::Enable:
+            case ScenarioAction::Disable:
+                setTxEnabled(*step.state, step.action == ScenarioAction::Enable, due);
+                break;
+            case ScenarioAction::Load:
+                load = step;
+                break;
+        }
+
+        const double lateness = std::chrono::duration<double, std::micro>(clockNow() - due).count();
+        run.max_lateness_us = std::max(run.max_lateness_us, lateness);
+        run.executed++;
+        run.next++;
+
+        // The load stops the scenario once it runs; nothing after it would.
+        if (load) {
+            return;
+        }
+    }
+}
+
+std::optional<std::chrono::steady_clock::time_point> TrdpEngine::nextScenarioDue() const {
+    if (!scenario_.active) {
+        return std::nullopt;
+    }
+    if (scenario_.next == scenario_.steps.size()) {
+        return scenario_.pass_start + scenario_.length;
+    }
+    return scenario_.pass_start + scenario_.steps[scenario_.next].offset;
+}
+
+PdState *TrdpEngine::findReplayState(uint32_t com_id, const std::string &if_name) {
+    // Captures taken with several hosts label interfaces as "host/interface".
+    std::string hostName;
+    std::string ifaceName = if_name;
+    const auto slash = if_name.find('/');
+    if (slash != std::string::npos) {
+        hostName = if_name.substr(0u, slash);
+        ifaceName = if_name.substr(slash + 1u);
+    }
+    return findPdState(com_id, ifaceName, hostName, true);
+}
+
+void TrdpEngine::markReplaying(const std::vector<ReplayTelegram> &telegrams) {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    for (const auto &telegram : telegrams) {
+        PdState *state = findReplayState(telegram.com_id, telegram.if_name);
+        if (state != nullptr) {
+            pd_tx_slots_[state->tx_slot].replaying = true;
+        }
+    }
+}
+
+void TrdpEngine::clearReplaying() {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    const auto now = clockNow();
+    for (auto &slot : pd_tx_slots_) {
+        if (slot.replaying) {
+            slot.replaying = false;
+            // Resume from now rather than catching up the cycles the
+            // replay covered.
+            slot.next_tx_due = now;
+        }
+    }
+}
+
+bool TrdpEngine::replayPd(uint32_t com_id, const std::string &if_name, const uint8_t *data, uint32_t size) {
+    // This runs on the replay thread, so the stack is called with
+    // session_mtx_ held instead of state_mtx_ (see sendPdOnInterface). The
+    // replayer keeps `data` alive for the call.
+    std::lock_guard<std::mutex> sessionLock(session_mtx_);
+    PdState *state = nullptr;
+    uint32_t sendSize = 0u;
+    {
+        std::lock_guard<std::mutex> lock(state_mtx_);
+
+        state = findReplayState(com_id, if_name);
+        if (state == nullptr || !pd_tx_slots_[state->tx_slot].enabled) {
+            return false;
+        }
+
+        state->tx_size = std::min(size, state->tx_capacity);
+        if (state->tx_size > 0u) {
+            std::memcpy(state->tx_payload, data, state->tx_size);
+        }
+        sendSize = state->tx_size;
+        if (state->iface->appHandle == nullptr) {
+            sendPdOnInterface(*state->iface, *state);
+        }
+        pd_tx_slots_[state->tx_slot].tx_count++;
+        pd_tx_slots_[state->tx_slot].data_changed = true;
+        state->metrics->tx.add();
+        if (shm_export_.active()) {
+            shm_export_.writeTx(static_cast<uint32_t>(state - pd_states_.data()), *state,
+                                pd_tx_slots_[state->tx_slot], clockNow());
+        }
+    }
+
+    if (state->iface->appHandle != nullptr &&
+        (state->pub_handle == nullptr ||
+         tlp_putImmediate(state->iface->appHandle, state->pub_handle, data, sendSize, nullptr) != TRDP_NO_ERR)) {
+        state->metrics->tx_errors.add();
+    }
+    return true;
+}
+
+uint64_t TrdpEngine::startPdPull(const PdPullOptions &options) {
+    std::lock_guard<std::mutex> sessionLock(session_mtx_);
+    if (options.interval_us == 0u) {
+        throw std::runtime_error("PD pull interval must be greater than zero");
+    }
+    if (options.dest_ip.empty()) {
+        throw std::runtime_error("PD pull requires a destination IP");
+    }
+
+    PdPullOptions resolved = options;
+    resolved.reply_com_id = options.reply_com_id != 0u ? options.reply_com_id : options.com_id;
+    if (resolved.timeout_us == 0u) {
+        resolved.timeout_us = std::max<uint32_t>(options.interval_us, kPdPullDefaultTimeoutUs);
+    }
+
+    InterfaceRuntime *iface = findInterface(options.interface_name, options.host_name);
+    if (iface == nullptr) {
+        throw std::runtime_error("Unknown interface for PD pull");
+    }
+    if (iface->appHandle == nullptr) {
+        throw std::runtime_error("PD pull is not available on loopback interfaces");
+    }
+    resolved.interface_name = iface->def.name;
+    resolved.host_name = iface->def.host_name;
+
+    TRDP_SUB_T subHandle {};
+    {
+        std::lock_guard<std::mutex> lock(state_mtx_);
+        const PdState *reply = findPdState(resolved.reply_com_id, iface->def.name, iface->def.host_name, false);
+        if (reply == nullptr) {
+            throw std::runtime_error("PD pull reply comId is not subscribed on this interface");
+        }
+        subHandle = reply->sub_handle;
+    }
+
+    return pd_pulls_.add(resolved, vos_dottedIP(options.dest_ip.c_str()), iface->appHandle, subHandle,
+                         std::chrono::steady_clock::now());
+}
+
+bool TrdpEngine::stopPdPull(uint64_t id) { return pd_pulls_.remove(id); }
+
+std::vector<PdPullStatus> TrdpEngine::pdPullStatus() const { return pd_pulls_.status(); }
+
+std::vector<PdPullStatsSnapshot> TrdpEngine::pdPullStats() const { return pd_pulls_.statsSnapshot(); }
+
+std::vector<uint64_t> TrdpEngine::mdRequest(const MdRequestOptions &options) {
+    std::lock_guard<std::mutex> sessionLock(session_mtx_);
+    InterfaceRuntime *iface = findInterface(options.interface_name, options.host_name);
+    if (iface == nullptr) {
+        throw std::runtime_error("Unknown interface for MD request");
+    }
+    if (iface->appHandle == nullptr) {
+        throw std::runtime_error("MD is not available on loopback interfaces");
+    }
+    if (options.dest_ip.empty()) {
+        throw std::runtime_error("MD request requires a destination IP");
+    }
+
+    const TRDP_IP_ADDR_T destIp = vos_dottedIP(options.dest_ip.c_str());
+    const uint32_t timeoutUs = options.timeout_us > 0u ? options.timeout_us : kMdDefaultReplyTimeoutUs;
+    const uint32_t count = std::max<uint32_t>(options.count, 1u);
+
+    std::vector<uint64_t> ids;
+    ids.reserve(count);
+
+    for (uint32_t n = 0u; n < count; ++n) {
+        const auto sent = clockNow();
+        const uint64_t id =
+            md_sessions_.add(options.com_id, sent, sent + std::chrono::microseconds(timeoutUs) + kMdExpiryGrace);
+        md_sessions_.increment(options.com_id, &MdComIdStats::requests);
+        ids.push_back(id);
+
+        TRDP_UUID_T sessionId {};
+        const TRDP_ERR_T err = tlm_request(iface->appHandle,
+                                           reinterpret_cast<void *>(static_cast<uintptr_t>(id)),
+                                           mdCallback,
+                                           &sessionId,
+                                           options.com_id,
+                                           0u,
+                                           0u,
+                                           0u,
+                                           destIp,
+                                           TRDP_FLAGS_CALLBACK,
+                                           options.expected_replies,
+                                           timeoutUs,
+                                           nullptr,
+                                           options.payload.empty() ? nullptr : options.payload.data(),
+                                           static_cast<UINT32>(options.payload.size()),
+                                           nullptr,
+                                           nullptr);
+        if (err != TRDP_NO_ERR) {
+            if (const auto failed = md_sessions_.complete(id, MdState::Error, err, 0u, nullptr, 0u,
+                                                          clockNow())) {
+                publishMdResult(*failed);
+            }
+        }
+    }
+
+    return ids;
+}
+
+void TrdpEngine::mdNotify(const MdRequestOptions &options) {
+    std::lock_guard<std::mutex> sessionLock(session_mtx_);
+    InterfaceRuntime *iface = findInterface(options.interface_name, options.host_name);
+    if (iface == nullptr) {
+        throw std::runtime_error("Unknown interface for MD notification");
+    }
+    if (iface->appHandle == nullptr) {
+        throw std::runtime_error("MD is not available on loopback interfaces");
+    }
+    if (options.dest_ip.empty()) {
+        throw std::runtime_error("MD notification requires a destination IP");
+    }
+
+    const TRDP_IP_ADDR_T destIp = vos_dottedIP(options.dest_ip.c_str());
+    const uint32_t count = std::max<uint32_t>(options.count, 1u);
+
+    for (uint32_t n = 0u; n < count; ++n) {
+        const TRDP_ERR_T err = tlm_notify(iface->appHandle,
+                                          nullptr,
+                                          mdCallback,
+                                          options.com_id,
+                                          0u,
+                                          0u,
+                                          0u,
+                                          destIp,
+                                          TRDP_FLAGS_CALLBACK,
+                                          nullptr,
+                                          options.payload.empty() ? nullptr : options.payload.data(),
+                                          static_cast<UINT32>(options.payload.size()),
+                                          nullptr,
+                                          nullptr);
+        if (err != TRDP_NO_ERR) {
+            throw std::runtime_error("Failed to send MD notification");
+        }
+        md_sessions_.increment(options.com_id, &MdComIdStats::notifications_sent);
+    }
+}
+
+void TrdpEngine::addMdResponder(const MdResponderOptions &options) {
+    std::lock_guard<std::mutex> sessionLock(session_mtx_);
+    InterfaceRuntime *iface = findInterface(options.interface_name, options.host_name);
+    if (iface == nullptr) {
+        throw std::runtime_error("Unknown interface for MD responder");
+    }
+    if (iface->appHandle == nullptr) {
+        throw std::runtime_error("MD is not available on loopback interfaces");
+    }
+
+    dropMdResponders(options.com_id, iface->def.name, iface->def.host_name);
+
+    MdResponder responder {options, iface->appHandle, nullptr};
+    responder.options.interface_name = iface->def.name;
+    responder.options.host_name = iface->def.host_name;
+
+    const TRDP_ERR_T err = tlm_addListener(iface->appHandle,
+                                           &responder.listener,
+                                           nullptr,
+                                           mdCallback,
+                                           TRUE,
+                                           options.com_id,
+                                           0u,
+                                           0u,
+                                           0u,
+                                           0u,
+                                           0u,
+                                           TRDP_FLAGS_CALLBACK,
+                                           nullptr,
+                                           nullptr);
+    if (err != TRDP_NO_ERR) {
+        throw std::runtime_error("Failed to add MD listener");
+    }
+
+    std::lock_guard<std::mutex> lock(md_mtx_);
+    md_responders_.push_back(std::move(responder));
+}
+
+void TrdpEngine::removeMdResponder(uint32_t com_id, const std::string &if_name, const std::string &host_name) {
+    std::lock_guard<std::mutex> sessionLock(session_mtx_);
+    dropMdResponders(com_id, if_name, host_name);
+}
+
+void TrdpEngine::dropMdResponders(uint32_t com_id, const std::string &if_name, const std::string &host_name) {
+    std::vector<MdResponder> removed;
+    {
+        std::lock_guard<std::mutex> lock(md_mtx_);
+        for (auto it = md_responders_.begin(); it != md_responders_.end();) {
+            if (it->options.com_id == com_id && (if_name.empty() || it->options.interface_name == if_name) &&
+                (host_name.empty() || it->options.host_name == host_name)) {
+                removed.push_back(std::move(*it));
+                it = md_responders_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (const auto &responder : removed) {
+        tlm_delListener(responder.appHandle, responder.listener);
+    }
+}
+
+std::optional<MdResult> TrdpEngine::mdResult(uint64_t id) const { return md_sessions_.find(id); }
+
+std::vector<MdStatsSnapshot> TrdpEngine::mdStats() const { return md_sessions_.statsSnapshot(); }
+
+size_t TrdpEngine::mdPendingCount() const { return md_sessions_.pendingCount(); }
+
+void TrdpEngine::setMdResultHandler(MdResultHandler handler) {
+    std::lock_guard<std::mutex> lock(md_mtx_);
+    md_result_handler_ = std::move(handler);
+}
+
+void TrdpEngine::onMdReceive(TRDP_APP_SESSION_T appHandle, const TRDP_MD_INFO_T *pMsg, const uint8_t *pData, uint32_t dataSize) {
+    if (pMsg == nullptr) {
+        return;
+    }
+
+    TraceScope trace("md.rx", "md", pMsg->comId);
+    const auto now = clockNow();
+    const uint32_t size = pData != nullptr ? dataSize : 0u;
+
+    // Outcomes of our own requests carry the request id as user reference;
+    // listener traffic carries none.
+    if (pMsg->pUserRef != nullptr) {
+        const auto id = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pMsg->pUserRef));
+
+        std::optional<MdResult> result;
+        if (pMsg->resultCode == TRDP_NO_ERR) {
+            if (pMsg->msgType != TRDP_MSG_MP && pMsg->msgType != TRDP_MSG_MQ) {
+                return;
+            }
+            result = md_sessions_.complete(id, MdState::Replied, TRDP_NO_ERR, pMsg->srcIpAddr, pData, size, now);
+            if (pMsg->msgType == TRDP_MSG_MQ) {
+                tlm_confirm(appHandle, &pMsg->sessionId, 0u, nullptr);
+            }
+        } else if (pMsg->resultCode == TRDP_REPLYTO_ERR || pMsg->resultCode == TRDP_TIMEOUT_ERR ||
+                   pMsg->resultCode == TRDP_APP_REPLYTO_ERR) {
+            result = md_sessions_.complete(id, MdState::Timeout, pMsg->resultCode, 0u, nullptr, 0u, now);
+        } else {
+            result = md_sessions_.complete(id, MdState::Error, pMsg->resultCode, pMsg->srcIpAddr, nullptr, 0u, now);
+        }
+
+        if (result) {
+            publishMdResult(*result);
+        }
+        return;
+    }
+
+    if (pMsg->resultCode != TRDP_NO_ERR) {
+        return;
+    }
+
+    switch (pMsg->msgType) {
+        case TRDP_MSG_MN:
+            md_sessions_.increment(pMsg->comId, &MdComIdStats::notifications_received);
+            break;
+        case TRDP_MSG_MC:
+            md_sessions_.increment(pMsg->comId, &MdComIdStats::confirms_received);
+            break;
+        case TRDP_MSG_MR: {
+            md_sessions_.increment(pMsg->comId, &MdComIdStats::requests_received);
+
+            std::optional<MdResponderOptions> responder;
+            {
+                std::lock_guard<std::mutex> lock(md_mtx_);
+                for (const auto &candidate : md_responders_) {
+                    if (candidate.appHandle == appHandle && candidate.options.com_id == pMsg->comId) {
+                        responder = candidate.options;
+                        break;
+                    }
+                }
+            }
+
+            if (!responder) {
+                break;
+            }
+
+            const uint32_t replyComId = responder->reply_com_id != 0u ? responder->reply_com_id : pMsg->comId;
+            const UINT8 *replyData = responder->payload.empty() ? nullptr : responder->payload.data();
+            const auto replySize = static_cast<UINT32>(responder->payload.size());
+            if (responder->request_confirm) {
+                tlm_replyQuery(appHandle, &pMsg->sessionId, replyComId, 0u, 0u, nullptr, replyData, replySize, nullptr);
+            } else {
+                tlm_reply(appHandle, &pMsg->sessionId, replyComId, 0u, nullptr, replyData, replySize, nullptr);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void TrdpEngine::publishMdResult(const MdResult &result) {
+    MdResultHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(md_mtx_);
+        handler = md_result_handler_;
+    }
+
+    if (handler) {
+        handler(result);
+    }
+}
+
+const EngineMetrics &TrdpEngine::engineMetrics() const { return engine_metrics_; }
+
+std::shared_ptr<const TelegramMetricsTable> TrdpEngine::telegramMetrics() const {
+    return std::atomic_load(&telegram_metrics_);
+}
+
+std::vector<DecodedField> TrdpEngine::decodeLastRx(const PdRuntime &pd) const {
+    if (pd.layout == nullptr) {
+        return {};
+    }
+    return decodeFields(*pd.layout, pd.last_rx_payload.data(), pd.last_rx_payload.size());
+}
+
+std::vector<DecodedField> TrdpEngine::decodePayload(uint32_t com_id, const uint8_t *data, size_t size) const {
+    // Decoded under the lock: a config job may swap the layouts at any time.
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    const PdState *state = findPdState(com_id, {}, {}, false);
+    if (state == nullptr || state->layout == nullptr) {
+        return {};
+    }
+    return decodeFields(*state->layout, data, size);
+}
+
+const PdChangeQueue &TrdpEngine::pdChanges() const { return pd_changes_; }
+
+uint64_t TrdpEngine::subscribePd(uint32_t com_id, PdRxCallback callback) {
+    if (!callback) {
+        throw std::runtime_error("PD subscription requires a callback");
+    }
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    return pd_subscribers_.add(com_id, std::move(callback));
+}
+
+bool TrdpEngine::unsubscribePd(uint64_t id) {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    return pd_subscribers_.remove(id);
+}
+
+PdRxView TrdpEngine::rxView(const PdState &state) const {
+    PdRxView view {};
+    view.com_id = state.def->com_id;
+    view.src_ip = state.last_src_ip;
+    view.seq_count = state.last_seq;
+    view.time = state.last_rx_time;
+    view.rx_count = state.rx_count;
+    view.def = state.def;
+    view.layout = state.layout;
+    view.payload = PdPayloadView {state.rx_payload, state.rx_size};
+    return view;
+}
+
+std::vector<PdSwitchoverEvent> TrdpEngine::switchovers() const {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    return std::vector<PdSwitchoverEvent>(switchovers_.begin(), switchovers_.end());
+}
+
+uint64_t TrdpEngine::addWatch(const PdWatchSpec &spec) {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+
+    PdState *state = findPdState(spec.com_id, spec.interface_name, spec.host_name, false);
+    if (state == nullptr) {
+        throw std::runtime_error("Unknown PD telegram for watch rule");
+    }
+    if (state->layout == nullptr) {
+        throw std::runtime_error("PD telegram has no dataset layout");
+    }
+
+    PdWatchSpec resolved = spec;
+    resolved.interface_name = state->def->interface_name;
+    resolved.host_name = state->def->host_name;
+    const uint64_t id = pd_watches_.add(resolved, *state->layout, state);
+    state->watch_count++;
+    // At most every rule fires for one reception; reserving here keeps the
+    // receive path free of allocations.
+    watch_fired_.reserve(pd_watches_.size());
+    return id;
+}
+
+bool TrdpEngine::removeWatch(uint64_t id) {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+
+    const void *target = pd_watches_.remove(id);
+    if (target == nullptr) {
+        return false;
+    }
+    for (auto &state : pd_states_) {
+        if (&state == target) {
+            state.watch_count = static_cast<uint32_t>(pd_watches_.countFor(&state));
+            break;
+        }
+    }
+    return true;
+}
+
+uint64_t TrdpEngine::addGenerator(const PdGeneratorSpec &spec) {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+
+    PdState *state = findPdState(spec.com_id, {}, spec.host_name, true);
+    if (state == nullptr) {
+        throw std::runtime_error("Unknown sent PD telegram for generator");
+    }
+    if (state->layout == nullptr) {
+        throw std::runtime_error("PD telegram has no dataset layout");
+    }
+    // Pull replies are sent by the stack, so nothing would evaluate it.
+    if (pd_tx_slots_[state->tx_slot].cycle.count() == 0) {
+        throw std::runtime_error("Generators need a cyclically sent PD telegram");
+    }
+
+    PdGeneratorSpec resolved = spec;
+    resolved.host_name = state->def->host_name;
+    return pd_generators_.add(resolved, *state->layout, state->tx_slot, clockNow());
+}
+
+bool TrdpEngine::removeGenerator(uint64_t id) {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    return pd_generators_.remove(id);
+}
+
+std::vector<PdGeneratorStatus> TrdpEngine::generatorStatus() const {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    return pd_generators_.status();
+}
+
+std::vector<PdWatchStatus> TrdpEngine::watchStatus() const {
+    std::lock_guard<std::mutex> lock(state_mtx_);
+    return pd_watches_.status();
+}
+
+void TrdpEngine::setWatchHandler(PdWatchHandler handler) {
+    std::lock_guard<std::mutex> lock(watch_mtx_);
+    watch_handler_ = std::move(handler);
+}
+
+void TrdpEngine::sendPdOnInterface(InterfaceRuntime &iface, const PdState &pd) {
+    if (iface.appHandle == nullptr) {
+        // The counter is incremented by the caller after the send.
+        loopback_.send(pd, pd.def->com_id, static_cast<uint32_t>(pd_tx_slots_[pd.tx_slot].tx_count), pd.tx_payload,
+                       pd.tx_size);
+        return;
+    }
+
+    // tlp_put() would only refresh the buffer the stack sends on its own
+    // timetable; here the telegram goes out now.
+    if (pd.pub_handle == nullptr ||
+        tlp_putImmediate(iface.appHandle, pd.pub_handle, pd.tx_payload, pd.tx_size, nullptr) != TRDP_NO_ERR) {
+        pd.metrics->tx_errors.add();
+    }
+}
+
+void TrdpEngine::updatePdOnInterface(InterfaceRuntime &iface, const PdState &pd) {
+    if (iface.appHandle == nullptr || pd.pub_handle == nullptr) {
+        return;
+    }
+    if (tlp_put(iface.appHandle, pd.pub_handle, pd.tx_payload, pd.tx_size) != TRDP_NO_ERR) {
+        pd.metrics->tx_errors.add();
+    }
+}
+
+InterfaceRuntime *TrdpEngine::findInterface(const std::string &name, const std::string &host_name) {
+    return matchInterface(interfaces_, name, host_name);
+}
+
+std::string TrdpEngine::interfaceLabel(const InterfaceRuntime &iface) const {
+    return host_names_.size() > 1u ? iface.def.host_name + "/" + iface.def.name : iface.def.name;
+}
+
+PdState *TrdpEngine::findPdState(uint32_t com_id, const std::string &if_name, const std::string &host_name,
+                                 bool sending) {
+    const auto it = pd_by_com_id_.find(com_id);
+    if (it == pd_by_com_id_.end()) {
+        return nullptr;
+    }
+
+    const Direction skipped = sending ? Direction::Sink : Direction::Source;
+    for (PdState *pd : it->second) {
+        if (pd->def->direction != skipped && (if_name.empty() || pd->def->interface_name == if_name) &&
+            (host_name.empty() || pd->def->host_name == host_name)) {
+            return pd;
+        }
+    }
+    return nullptr;
+}
+
+const PdState *TrdpEngine::findPdState(uint32_t com_id, const std::string &if_name, const std::string &host_name,
+                                       bool sending) const {
+    return const_cast<TrdpEngine *>(this)->findPdState(com_id, if_name, host_name, sending);
+}
+
+}  // namespace trdp
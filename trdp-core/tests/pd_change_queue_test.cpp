@@ -0,0 +1,98 @@
+#include "trdp/pd_change_queue.hpp"
+
+#include "test_check.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+using trdp::PdChangeEvent;
+using trdp::PdChangePoll;
+using trdp::PdChangeQueue;
+
+void publishCounter(PdChangeQueue &queue, uint8_t value) {
+    const uint8_t payload[2] = {value, static_cast<uint8_t>(value + 1u)};
+    queue.publish(1000u, 0x0a000001u, value, payload, sizeof(payload));
+}
+
+void testDeliversInOrder() {
+    PdChangeQueue queue(8u, 4u);
+    uint64_t cursor = queue.head();
+    std::vector<uint8_t> scratch;
+    for (uint8_t value = 0u; value < 5u; ++value) {
+        publishCounter(queue, value);
+    }
+
+    std::vector<uint8_t> seen;
+    const PdChangePoll poll = queue.poll(cursor, scratch, 16u, [&](const PdChangeEvent &event) {
+        TRDP_CHECK_EQ(event.size, 2u);
+        TRDP_CHECK_EQ(event.com_id, 1000u);
+        seen.push_back(event.data[0]);
+    });
+    TRDP_CHECK_EQ(poll.delivered, 5u);
+    TRDP_CHECK_EQ(poll.lost, 0u);
+    TRDP_CHECK_EQ(cursor, 5u);
+    TRDP_CHECK((seen == std::vector<uint8_t> {0u, 1u, 2u, 3u, 4u}));
+}
+
+void testMaxEvents() {
+    PdChangeQueue queue(8u, 4u);
+    uint64_t cursor = queue.head();
+    std::vector<uint8_t> scratch;
+    for (uint8_t value = 0u; value < 5u; ++value) {
+        publishCounter(queue, value);
+    }
+
+    PdChangePoll poll = queue.poll(cursor, scratch, 3u, [](const PdChangeEvent &) {});
+    TRDP_CHECK_EQ(poll.delivered, 3u);
+    poll = queue.poll(cursor, scratch, 3u, [](const PdChangeEvent &) {});
+    TRDP_CHECK_EQ(poll.delivered, 2u);
+    TRDP_CHECK_EQ(poll.lost, 0u);
+}
+
+void testLostWhenOverrun() {
+    // Capacity 5 rounds up to 8.
+    PdChangeQueue queue(5u, 4u);
+    TRDP_CHECK_EQ(queue.capacity(), 8u);
+    uint64_t cursor = queue.head();
+    std::vector<uint8_t> scratch;
+    for (uint8_t value = 0u; value < 20u; ++value) {
+        publishCounter(queue, value);
+    }
+
+    uint8_t first = 0u;
+    const PdChangePoll poll = queue.poll(cursor, scratch, 64u, [&](const PdChangeEvent &event) {
+        if (event.seq == 12u) {
+            first = event.data[0];
+        }
+    });
+    TRDP_CHECK_EQ(poll.lost, 12u);
+    TRDP_CHECK_EQ(poll.delivered, 8u);
+    TRDP_CHECK_EQ(first, 12u);
+    TRDP_CHECK_EQ(cursor, 20u);
+}
+
+void testTruncatesLongPayloads() {
+    PdChangeQueue queue(4u, 2u);
+    uint64_t cursor = queue.head();
+    std::vector<uint8_t> scratch;
+    const uint8_t payload[4] = {1u, 2u, 3u, 4u};
+    queue.publish(1000u, 0u, 0, payload, sizeof(payload));
+
+    const PdChangePoll poll = queue.poll(cursor, scratch, 1u, [](const PdChangeEvent &event) {
+        TRDP_CHECK_EQ(event.size, 2u);
+        TRDP_CHECK_EQ(event.data[1], 2u);
+    });
+    TRDP_CHECK_EQ(poll.delivered, 1u);
+}
+
+}  // namespace
+
+int main() {
+    testDeliversInOrder();
+    testMaxEvents();
+    testLostWhenOverrun();
+    testTruncatesLongPayloads();
+    return trdp_test::result();
+}
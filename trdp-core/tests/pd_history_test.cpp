@@ -0,0 +1,83 @@
+#include "trdp/pd_history.hpp"
+
+#include "test_check.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+using trdp::DownsampleMode;
+using trdp::SeriesPoint;
+
+std::vector<SeriesPoint> ramp(size_t count) {
+    std::vector<SeriesPoint> points;
+    for (size_t idx = 0u; idx < count; ++idx) {
+        points.push_back(SeriesPoint {static_cast<int64_t>(idx) * 1000, static_cast<double>(idx % 10u)});
+    }
+    return points;
+}
+
+bool ascending(const std::vector<SeriesPoint> &points) {
+    for (size_t idx = 1u; idx < points.size(); ++idx) {
+        if (points[idx].t_us <= points[idx - 1u].t_us) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testShortSeriesUnchanged() {
+    const auto points = ramp(10u);
+    TRDP_CHECK_EQ(trdp::downsample(points, 10u, DownsampleMode::MinMax).size(), 10u);
+    TRDP_CHECK_EQ(trdp::downsample(points, 50u, DownsampleMode::Lttb).size(), 10u);
+    TRDP_CHECK_EQ(trdp::downsample(points, 0u, DownsampleMode::Lttb).size(), 10u);
+}
+
+void testMinMaxKeepsExtremes() {
+    auto points = ramp(1000u);
+    points[437].value = 100.0;
+    points[812].value = -100.0;
+
+    const auto reduced = trdp::downsample(points, 100u, DownsampleMode::MinMax);
+    TRDP_CHECK(reduced.size() <= 100u);
+    TRDP_CHECK(ascending(reduced));
+
+    bool peak = false;
+    bool dip = false;
+    for (const auto &point : reduced) {
+        peak = peak || (point.t_us == 437000 && point.value == 100.0);
+        dip = dip || (point.t_us == 812000 && point.value == -100.0);
+    }
+    TRDP_CHECK(peak);
+    TRDP_CHECK(dip);
+}
+
+void testLttb() {
+    auto points = ramp(1000u);
+    points[500].value = 1000.0;
+
+    const auto reduced = trdp::downsample(points, 50u, DownsampleMode::Lttb);
+    TRDP_CHECK_EQ(reduced.size(), 50u);
+    TRDP_CHECK(ascending(reduced));
+    TRDP_CHECK_EQ(reduced.front().t_us, points.front().t_us);
+    TRDP_CHECK_EQ(reduced.back().t_us, points.back().t_us);
+
+    bool spike = false;
+    for (const auto &point : reduced) {
+        spike = spike || point.value == 1000.0;
+    }
+    TRDP_CHECK(spike);
+
+    const auto ends = trdp::downsample(points, 2u, DownsampleMode::Lttb);
+    TRDP_CHECK_EQ(ends.size(), 2u);
+}
+
+}  // namespace
+
+int main() {
+    testShortSeriesUnchanged();
+    testMinMaxKeepsExtremes();
+    testLttb();
+    return trdp_test::result();
+}
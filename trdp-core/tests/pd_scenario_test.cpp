@@ -0,0 +1,103 @@
+#include "trdp/pd_scenario.hpp"
+
+#include "test_check.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using trdp::Scenario;
+using trdp::ScenarioAction;
+
+Scenario parse(const std::string &text) {
+    std::istringstream input(text);
+    return trdp::parseScenario(input);
+}
+
+// Returns the error message, or an empty string if `text` parsed.
+std::string parseError(const std::string &text) {
+    try {
+        parse(text);
+    } catch (const std::runtime_error &error) {
+        return error.what();
+    }
+    return {};
+}
+
+void testSteps() {
+    const Scenario scenario = parse("# header\n"
+                                    "\n"
+                                    "0      set     1000 speed=12.5 doorsClosed=1\n"
+                                    "250us  set     1000@devB speed=0   # trailing comment\n"
+                                    "1.5ms  disable 1000\n"
+                                    "20ms   enable  1000\n"
+                                    "1s     load    other.xml devA,devB\n");
+
+    TRDP_CHECK_EQ(scenario.steps.size(), 5u);
+    TRDP_CHECK_EQ(scenario.length_us, 1000000u);
+
+    const auto &set = scenario.steps[0];
+    TRDP_CHECK(set.action == ScenarioAction::Set);
+    TRDP_CHECK_EQ(set.offset_us, 0u);
+    TRDP_CHECK_EQ(set.com_id, 1000u);
+    TRDP_CHECK(set.host_name.empty());
+    TRDP_CHECK_EQ(set.values.size(), 2u);
+    TRDP_CHECK_EQ(set.values[0].first, std::string("speed"));
+    TRDP_CHECK_EQ(set.values[0].second, 12.5);
+    TRDP_CHECK_EQ(set.line, 3u);
+
+    TRDP_CHECK_EQ(scenario.steps[1].offset_us, 250u);
+    TRDP_CHECK_EQ(scenario.steps[1].host_name, std::string("devB"));
+    TRDP_CHECK(scenario.steps[2].action == ScenarioAction::Disable);
+    TRDP_CHECK_EQ(scenario.steps[2].offset_us, 1500u);
+    TRDP_CHECK(scenario.steps[3].action == ScenarioAction::Enable);
+    TRDP_CHECK_EQ(scenario.steps[3].offset_us, 20000u);
+
+    const auto &load = scenario.steps[4];
+    TRDP_CHECK(load.action == ScenarioAction::Load);
+    TRDP_CHECK_EQ(load.path, std::string("other.xml"));
+    TRDP_CHECK_EQ(load.host_names.size(), 2u);
+    TRDP_CHECK_EQ(load.host_names[1], std::string("devB"));
+}
+
+void testSortAndEnd() {
+    const Scenario scenario = parse("20ms enable 1000\n"
+                                    "0 disable 1000\n"
+                                    "20ms set 1000 a=1\n"
+                                    "2s end\n");
+
+    TRDP_CHECK_EQ(scenario.steps.size(), 3u);
+    TRDP_CHECK(scenario.steps[0].action == ScenarioAction::Disable);
+    // Equal offsets keep file order.
+    TRDP_CHECK(scenario.steps[1].action == ScenarioAction::Enable);
+    TRDP_CHECK(scenario.steps[2].action == ScenarioAction::Set);
+    TRDP_CHECK_EQ(scenario.length_us, 2000000u);
+}
+
+void testErrors() {
+    TRDP_CHECK_EQ(parseError("0 set 1000 speed=1\nx set 1000 a=1\n"),
+                  std::string("Scenario line 2: invalid offset 'x'"));
+    TRDP_CHECK_EQ(parseError("5min set 1000 a=1\n"), std::string("Scenario line 1: unknown offset unit 'min'"));
+    TRDP_CHECK_EQ(parseError("-1 set 1000 a=1\n"), std::string("Scenario line 1: offset must not be negative"));
+    TRDP_CHECK_EQ(parseError("0\n"), std::string("Scenario line 1: missing action"));
+    TRDP_CHECK_EQ(parseError("0 jump 1000\n"), std::string("Scenario line 1: unknown action 'jump'"));
+    TRDP_CHECK_EQ(parseError("0 set\n"), std::string("Scenario line 1: missing comId"));
+    TRDP_CHECK_EQ(parseError("0 set abc a=1\n"), std::string("Scenario line 1: invalid comId 'abc'"));
+    TRDP_CHECK_EQ(parseError("0 set 1000\n"), std::string("Scenario line 1: set needs at least one field=value"));
+    TRDP_CHECK_EQ(parseError("0 set 1000 speed\n"), std::string("Scenario line 1: expected field=value, got 'speed'"));
+    TRDP_CHECK_EQ(parseError("0 set 1000 speed=fast\n"), std::string("Scenario line 1: invalid value in 'speed=fast'"));
+    TRDP_CHECK_EQ(parseError("0 enable 1000 now\n"), std::string("Scenario line 1: unexpected 'now'"));
+    TRDP_CHECK_EQ(parseError("0 load\n"), std::string("Scenario line 1: load needs a configuration path"));
+    TRDP_CHECK_EQ(parseError("1s enable 1000\n500ms end\n"), std::string("Scenario end lies before its last step"));
+}
+
+}  // namespace
+
+int main() {
+    testSteps();
+    testSortAndEnd();
+    testErrors();
+    return trdp_test::result();
+}
@@ -0,0 +1,96 @@
+#include "trdp/pd_source.hpp"
+
+#include "test_check.hpp"
+
+#include <cstdint>
+
+namespace {
+
+using trdp::PdSeqTracker;
+using trdp::SeqOutcome;
+
+void testInOrderAndGap() {
+    PdSeqTracker tracker {};
+    uint32_t burst = 0u;
+    TRDP_CHECK(tracker.track(10u, burst) == SeqOutcome::First);
+    TRDP_CHECK(tracker.track(11u, burst) == SeqOutcome::InOrder);
+    TRDP_CHECK_EQ(burst, 0u);
+
+    TRDP_CHECK(tracker.track(15u, burst) == SeqOutcome::Gap);
+    TRDP_CHECK_EQ(burst, 3u);
+    TRDP_CHECK_EQ(tracker.lost, 3u);
+    TRDP_CHECK_EQ(tracker.longest_burst, 3u);
+
+    TRDP_CHECK(tracker.track(17u, burst) == SeqOutcome::Gap);
+    TRDP_CHECK_EQ(burst, 1u);
+    TRDP_CHECK_EQ(tracker.lost, 4u);
+    TRDP_CHECK_EQ(tracker.longest_burst, 3u);
+}
+
+void testDuplicate() {
+    PdSeqTracker tracker {};
+    uint32_t burst = 0u;
+    tracker.track(1u, burst);
+    tracker.track(2u, burst);
+    tracker.track(3u, burst);
+
+    // Both the newest counter and one inside the window.
+    TRDP_CHECK(tracker.track(3u, burst) == SeqOutcome::Duplicate);
+    TRDP_CHECK(tracker.track(2u, burst) == SeqOutcome::Duplicate);
+    TRDP_CHECK_EQ(tracker.duplicates, 2u);
+    TRDP_CHECK_EQ(tracker.lost, 0u);
+    TRDP_CHECK_EQ(tracker.reordered, 0u);
+}
+
+void testReorderTakesBackLoss() {
+    PdSeqTracker tracker {};
+    uint32_t burst = 0u;
+    tracker.track(100u, burst);
+    tracker.track(103u, burst);
+    TRDP_CHECK_EQ(tracker.lost, 2u);
+
+    TRDP_CHECK(tracker.track(101u, burst) == SeqOutcome::Reordered);
+    TRDP_CHECK_EQ(tracker.reordered, 1u);
+    TRDP_CHECK_EQ(tracker.lost, 1u);
+
+    // The late packet is now in the window, so a second copy is a duplicate.
+    TRDP_CHECK(tracker.track(101u, burst) == SeqOutcome::Duplicate);
+    TRDP_CHECK(tracker.track(102u, burst) == SeqOutcome::Reordered);
+    TRDP_CHECK_EQ(tracker.lost, 0u);
+    TRDP_CHECK(tracker.track(104u, burst) == SeqOutcome::InOrder);
+}
+
+void testWrapAround() {
+    PdSeqTracker tracker {};
+    uint32_t burst = 0u;
+    tracker.track(0xFFFFFFFEu, burst);
+    TRDP_CHECK(tracker.track(0xFFFFFFFFu, burst) == SeqOutcome::InOrder);
+    TRDP_CHECK(tracker.track(0u, burst) == SeqOutcome::InOrder);
+    TRDP_CHECK(tracker.track(2u, burst) == SeqOutcome::Gap);
+    TRDP_CHECK_EQ(burst, 1u);
+    TRDP_CHECK(tracker.track(0xFFFFFFFFu, burst) == SeqOutcome::Duplicate);
+    TRDP_CHECK(tracker.track(1u, burst) == SeqOutcome::Reordered);
+    TRDP_CHECK_EQ(tracker.lost, 0u);
+    TRDP_CHECK_EQ(tracker.resets, 0u);
+}
+
+void testReset() {
+    PdSeqTracker tracker {};
+    uint32_t burst = 0u;
+    tracker.track(1000u, burst);
+    // Further back than the window: the publisher restarted.
+    TRDP_CHECK(tracker.track(1000u - PdSeqTracker::kWindow, burst) == SeqOutcome::Reset);
+    TRDP_CHECK_EQ(tracker.resets, 1u);
+    TRDP_CHECK(tracker.track(1001u - PdSeqTracker::kWindow, burst) == SeqOutcome::InOrder);
+}
+
+}  // namespace
+
+int main() {
+    testInOrderAndGap();
+    testDuplicate();
+    testReorderTakesBackLoss();
+    testWrapAround();
+    testReset();
+    return trdp_test::result();
+}
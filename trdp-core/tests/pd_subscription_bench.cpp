@@ -0,0 +1,128 @@
+#include "trdp_engine.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage(const char *program) {
+    std::cerr << "Usage: " << program << " --xml <config.xml> --host <host name> [--com-id <id>] [--packets <count>]"
+              << std::endl;
+}
+
+// Injects `packets` receptions of `info` with a changing first byte and
+// returns the mean time per packet in nanoseconds.
+double injectLoop(trdp::TrdpEngine &engine, TRDP_PD_INFO_T info, std::vector<uint8_t> &payload,
+                  const std::string &if_name, const std::string &host_name, uint64_t packets,
+                  const std::function<void()> &after_each = {}) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint64_t i = 0u; i < packets; ++i) {
+        info.seqCount++;
+        if (!payload.empty()) {
+            payload[0] = static_cast<uint8_t>(info.seqCount);
+        }
+        engine.injectPd(info, payload.data(), static_cast<uint32_t>(payload.size()), if_name, host_name);
+        if (after_each) {
+            after_each();
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+           static_cast<double>(packets);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    std::string xmlPath;
+    std::string hostName;
+    uint32_t comId = 0u;
+    uint64_t packets = 1000000u;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--xml" && i + 1 < argc) {
+            xmlPath = argv[++i];
+        } else if (arg == "--host" && i + 1 < argc) {
+            hostName = argv[++i];
+        } else if (arg == "--com-id" && i + 1 < argc) {
+            comId = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--packets" && i + 1 < argc) {
+            packets = std::stoull(argv[++i]);
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (xmlPath.empty() || hostName.empty() || packets == 0u) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        trdp::TrdpEngine engine;
+        engine.loadConfig(xmlPath, hostName);
+
+        // The first received telegram unless one was asked for. The
+        // scheduler is not started, so only injected packets arrive.
+        const trdp::PdTelegramDef *def = nullptr;
+        size_t payloadSize = 0u;
+        for (const auto &pd : engine.getPdSnapshot()) {
+            if (pd.def->direction != trdp::Direction::Source && (comId == 0u || pd.def->com_id == comId)) {
+                def = pd.def;
+                payloadSize = pd.layout != nullptr ? pd.layout->size : 0u;
+                break;
+            }
+        }
+        if (def == nullptr) {
+            std::cerr << "No received PD telegram in the configuration" << std::endl;
+            return 1;
+        }
+
+        TRDP_PD_INFO_T info {};
+        info.comId = def->com_id;
+        info.srcIpAddr = 0x0a000001u;
+        info.msgType = TRDP_MSG_PD;
+        info.resultCode = TRDP_NO_ERR;
+        std::vector<uint8_t> payload(payloadSize, 0u);
+
+        std::cout << "Telegram " << def->com_id << " (" << def->name << "), " << payloadSize << " bytes, " << packets
+                  << " packets per run" << std::endl;
+
+        const double baseline = injectLoop(engine, info, payload, def->interface_name, def->host_name, packets);
+
+        uint64_t checksum = 0u;
+        const uint64_t id = engine.subscribePd(def->com_id, [&checksum](const trdp::PdRxView &view) {
+            checksum += view.payload.empty() ? 0u : view.payload[0];
+        });
+        const double callback = injectLoop(engine, info, payload, def->interface_name, def->host_name, packets);
+        engine.unsubscribePd(id);
+
+        trdp::PdCursor cursor {def->com_id, def->interface_name, def->host_name, 0u, 0u};
+        engine.pollPd(cursor, [](const trdp::PdRxView &) {});
+        const double polled = injectLoop(engine, info, payload, def->interface_name, def->host_name, packets, [&]() {
+            engine.pollPd(cursor, [&checksum](const trdp::PdRxView &view) {
+                checksum += view.payload.empty() ? 0u : view.payload[0];
+            });
+        });
+        engine.stop();
+
+        std::cout << "  no subscriber: " << baseline << " ns/packet" << std::endl;
+        std::cout << "  callback:      " << callback << " ns/packet (+" << callback - baseline << ")" << std::endl;
+        std::cout << "  cursor poll:   " << polled << " ns/packet (+" << polled - baseline << ", skipped "
+                  << cursor.skipped << ")" << std::endl;
+        std::cout << "  checksum:      " << checksum << std::endl;
+    } catch (const std::exception &ex) {
+        std::cerr << "Benchmark failed: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <iostream>
+
+// Minimal assertion helpers for the plain test executables registered with
+// CTest. A failed check is reported and counted; main() returns
+// trdp_test::result() so the test fails without stopping at the first error.
+
+namespace trdp_test {
+
+inline int &failures() {
+    static int count = 0;
+    return count;
+}
+
+inline int result() {
+    if (failures() != 0) {
+        std::cerr << failures() << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace trdp_test
+
+#define TRDP_CHECK(expr)                                                                               \
+    do {                                                                                               \
+        if (!(expr)) {                                                                                 \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #expr << std::endl;         \
+            trdp_test::failures()++;                                                                   \
+        }                                                                                              \
+    } while (false)
+
+#define TRDP_CHECK_EQ(actual, expected)                                                                \
+    do {                                                                                               \
+        const auto trdpActual = (actual);                                                              \
+        const auto trdpExpected = (expected);                                                          \
+        if (!(trdpActual == trdpExpected)) {                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #actual " is " << trdpActual              \
+                      << ", expected " << trdpExpected << std::endl;                                   \
+            trdp_test::failures()++;                                                                   \
+        }                                                                                              \
+    } while (false)
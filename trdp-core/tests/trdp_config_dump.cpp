@@ -3,6 +3,7 @@
 #include <exception>
 #include <iostream>
 #include <string>
+#include <vector>
 
 namespace {
 
@@ -19,21 +20,21 @@ std::string directionToString(trdp::Direction direction) {
 }
 
 void printUsage(const char *program) {
-    std::cerr << "Usage: " << program << " --xml <config.xml> --host <host name>" << std::endl;
+    std::cerr << "Usage: " << program << " --xml <config.xml> --host <host name> [--host <host name>...]" << std::endl;
 }
 
 }  // namespace
 
 int main(int argc, char *argv[]) {
     std::string xmlPath;
-    std::string hostName;
+    std::vector<std::string> hostNames;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--xml" && i + 1 < argc) {
             xmlPath = argv[++i];
         } else if (arg == "--host" && i + 1 < argc) {
-            hostName = argv[++i];
+            hostNames.push_back(argv[++i]);
         } else {
             std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
             printUsage(argv[0]);
@@ -41,26 +42,26 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    if (xmlPath.empty() || hostName.empty()) {
+    if (xmlPath.empty() || hostNames.empty()) {
         printUsage(argv[0]);
         return 1;
     }
 
     try {
         trdp::TrdpConfigLoader loader;
-        loader.loadFromXml(xmlPath, hostName);
+        loader.loadFromXml(xmlPath, hostNames);
 
         std::cout << "Interfaces:" << std::endl;
         for (const auto &iface : loader.interfaces()) {
-            std::cout << "  - " << iface.name << " (networkId=" << iface.network_id << ", hostIp=" << iface.host_ip
+            std::cout << "  - " << iface.host_name << "/" << iface.name << " (networkId=" << iface.network_id << ", hostIp=" << iface.host_ip
                       << ")" << std::endl;
         }
 
         std::cout << "\nPD Telegrams:" << std::endl;
         for (const auto &telegram : loader.pdTelegrams()) {
-            std::cout << "  - " << telegram.name << " (comId=" << telegram.com_id << ", datasetId=" << telegram.dataset_id
+            std::cout << "  - " << telegram.host_name << "/" << telegram.name << " (comId=" << telegram.com_id << ", datasetId=" << telegram.dataset_id
                       << ", direction=" << directionToString(telegram.direction) << ", cycle=" << telegram.cycle_us
-                      << " us)" << std::endl;
+                      << " us" << (telegram.pull ? ", pull" : "") << ")" << std::endl;
         }
 
         std::cout << "\nDatasets:" << std::endl;